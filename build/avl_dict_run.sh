@@ -25,7 +25,7 @@ function check_test {
     termination='.out'
 
 
-    tests=( "dict_init" "dict_search" "dict_minmax" "dict_succ_pred" "dict_rotations" "dict_insert" "dict_delete" "dict_list_insert" "dict_list_delete")
+    tests=( "dict_init" "dict_search" "dict_minmax" "dict_succ_pred" "dict_rotations" "dict_insert" "dict_delete" "dict_list_insert" "dict_list_delete" "dict_arena" "dict_inline_keys" "dict_bulk_load" "dict_order_stats" "dict_bounds" "dict_typed" "dict_compact" "dict_value_vectors" "dict_delete_successor" "dict_concurrent" "dict_persistent" "dict_sharded" "dict_parallel_build" "dict_set_ops" "dict_batch_ops" "dict_tokenizer" "dict_word_scanner" "dict_cipher_kernels" "dict_cipher_streams" "dict_cipher_parallel" "dict_save_load" "dict_frozen" "dict_btree")
 
     for i in ${!tests[@]}
     do
@@ -1,6 +1,15 @@
 #include "include/avl_dict.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DICT_SNAPSHOT_MAGIC "AVLDICT"
+#define DICT_SNAPSHOT_RECORD_LEN 256
+
 #define MAX(a, b) (((a) >= (b))?(a):(b))
+#define MIN(a, b) (((a) <= (b))?(a):(b))
 
 /**
  * @brief Function to create a dictionary object.
@@ -8,7 +17,7 @@
  * @param create_key Function to create a key object
  * @param destroy_key Function to destroy a key object
  * @param create_value Function to create a value object
- * @param destroy_value Function to destroy a value object
+ * @param destroy_value Function to destroy a value object, NULL if the values own no memory
  * @param cmp Function two compare two keys
  * @return dict_t* pointer to an allocated dictionary object or NULL
  */
@@ -27,12 +36,142 @@ dict_t* create_dict(create_func create_key, destroy_func destroy_key, create_fun
 		new_dict->destroy_value = destroy_value;
 		new_dict->cmp = cmp;
 		new_dict->size = 0;
+		new_dict->arena = NULL;
+		new_dict->inline_key = NULL;
+		new_dict->inline_key_len = 0;
+		new_dict->value_vectors = 0;
+		new_dict->heap_keys = 0;
 	}
 
 	/* Return the new allocated dictionary or NULL */
 	return new_dict;
 }
 
+/**
+ * @brief Function to get the number of bytes of one dictionary node,
+ * including the inline key storage
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @return size_t size of a dictionary node object
+ */
+static size_t dict_node_size(dict_t *dict) {
+	return sizeof(dict_node_t) + dict->inline_key_len;
+}
+
+/**
+ * @brief Function to set the key of a dictionary node. The key is
+ * copied inside the node when it fits, otherwise it is created on the heap.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param fix_node pointer to the dictionary node to set its key
+ * @param key pointer to the key location
+ */
+static void dict_node_set_key(dict_t *dict, dict_node_t *fix_node, const void *key) {
+	if ((dict->inline_key != NULL) && (dict->inline_key(fix_node->key_data, dict->inline_key_len, key) <= dict->inline_key_len)) {
+		fix_node->key = fix_node->key_data;
+	} else {
+		fix_node->key = dict->create_key(key);
+		++(dict->heap_keys);
+	}
+}
+
+/**
+ * @brief Function to free the key of a dictionary node,
+ * inline keys do not own any memory
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param fix_node pointer to the dictionary node to free its key
+ */
+static void dict_node_destroy_key(dict_t *dict, dict_node_t *fix_node) {
+	if (fix_node->key != fix_node->key_data) {
+		dict->destroy_key(fix_node->key);
+
+		if (dict->heap_keys > 0) {
+			--(dict->heap_keys);
+		}
+	}
+}
+
+/**
+ * @brief Function to free a value object, the values of a dictionary
+ * without a destroy_value function own no memory
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param value pointer to the value object
+ */
+static void dict_destroy_value(dict_t *dict, void *value) {
+	if (dict->destroy_value != NULL) {
+		dict->destroy_value(value);
+	}
+}
+
+/**
+ * @brief Function to add an already created value object at the end
+ * of the value vector of a key head
+ * 
+ * @param fix_node pointer to the key head
+ * @param value pointer to the value object
+ * @return uint8_t 1 if the value was added, 0 otherwise
+ */
+static uint8_t dict_node_append_value(dict_node_t *fix_node, void *value) {
+	/* The first value stays in the node, the vector holds the others */
+	if (fix_node->count - 1 == fix_node->dup_capacity) {
+		size_t new_capacity = (fix_node->dup_capacity == 0) ? 1 : 2 * fix_node->dup_capacity;
+
+		void **new_values = realloc(fix_node->dup_values, sizeof(*new_values) * new_capacity);
+
+		if (new_values == NULL) {
+			return 0;
+		}
+
+		fix_node->dup_values = new_values;
+		fix_node->dup_capacity = new_capacity;
+	}
+
+	fix_node->dup_values[fix_node->count - 1] = value;
+	++(fix_node->count);
+
+	return 1;
+}
+
+/**
+ * @brief Function to add one more value at the end of the value
+ * vector of a key head, used by the dictionaries with value vectors
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param fix_node pointer to the key head
+ * @param value pointer to the value location
+ * @return uint8_t 1 if the value was added, 0 otherwise
+ */
+static uint8_t dict_node_push_value(dict_t *dict, dict_node_t *fix_node, const void *value) {
+	void *new_value = dict->create_value(value);
+
+	if (dict_node_append_value(fix_node, new_value) == 0) {
+		dict_destroy_value(dict, new_value);
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Function to free all the values held by a dictionary node
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param fix_node pointer to the dictionary node
+ */
+static void dict_node_destroy_values(dict_t *dict, dict_node_t *fix_node) {
+	dict_destroy_value(dict, fix_node->value);
+
+	if (fix_node->dup_values != NULL) {
+		for (size_t iter = 0; iter + 1 < fix_node->count; ++iter) {
+			dict_destroy_value(dict, fix_node->dup_values[iter]);
+		}
+
+		free(fix_node->dup_values);
+	}
+}
+
 /**
  * @brief Function to create a dictionary node object on the heap memory.
  * 
@@ -47,26 +186,51 @@ dict_node_t* create_dict_node(dict_t *dict, const void *key, const void *value)
 		return NULL;
 	}
 
-	/* Allocate a new dictionary node on heap */
-	dict_node_t *new_node = malloc(sizeof(*new_node));
+	/* Allocate a new dictionary node from the arena or from the heap */
+	dict_node_t *new_node = NULL;
+
+	if (dict->arena != NULL) {
+		new_node = dict_arena_alloc(dict->arena);
+	} else {
+		new_node = malloc(dict_node_size(dict));
+	}
 	
 	/* Check if new node was allocated successfully */
 	if (new_node != NULL) {
 
 		/* Create key and value */
-		new_node->key = dict->create_key(key);
+		dict_node_set_key(dict, new_node, key);
 		new_node->value = dict->create_value(value);
 
 		/* Set default node metadata */
 		new_node->parent = new_node->right = new_node->left = NULL;
 		new_node->next = new_node->prev = new_node->end = NULL;
 		new_node->height = 1;
+		new_node->count = new_node->subtree_size = new_node->subtree_keys = 1;
+		new_node->max_freq = new_node;
+		new_node->dup_values = NULL;
+		new_node->dup_capacity = 0;
 	}
 	
 	/* Return new node or NULL */
 	return new_node;
 }
 
+/**
+ * @brief Function to give back the memory of a node, the content
+ * must be destroyed or moved before
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param delete_node the dictionary node object to free
+ */
+static void dict_node_free(dict_t *dict, dict_node_t *delete_node) {
+	if (dict->arena != NULL) {
+		dict_arena_free(dict->arena, delete_node);
+	} else {
+		free(delete_node);
+	}
+}
+
 /**
  * @brief Function to free loaded memory for a dictionary node object
  * 
@@ -80,15 +244,18 @@ void destroy_dict_node(dict_t *dict, dict_node_t *delete_node) {
 	}
 
 	/* Destroy the content */
-	dict->destroy_key(delete_node->key);
-	dict->destroy_value(delete_node->value);
+	dict_node_destroy_key(dict, delete_node);
+	dict_node_destroy_values(dict, delete_node);
 
 	/* Destroy the node */
-	free(delete_node);
+	dict_node_free(dict, delete_node);
 }
 
 /**
- * @brief Function to free all memory loaded for the dictionary object
+ * @brief Function to free all memory loaded for the dictionary object.
+ * The keys and values are destroyed node by node in O(n) time. A dictionary
+ * with a node arena, every key inline, no value vectors and no destroy_value
+ * function has nothing to destroy inside its nodes and frees its slabs at once.
  * 
  * @param dict pointer to an allocated dictionary object
  */
@@ -100,20 +267,149 @@ void destroy_dict(dict_t *dict) {
 
 	dict_node_t *min_node = dict_minimum(dict->root);
 
+	/* Skip the walk when the nodes own no memory */
+	if ((dict->arena != NULL) && (dict->heap_keys == 0) && (dict->value_vectors == 0) && (dict->destroy_value == NULL)) {
+		min_node = NULL;
+	}
+
 	/* Iterate through all dictionary nodes */
 	while (min_node != NULL) {
 		dict_node_t *delete_node = min_node;
 
 		min_node = min_node->next;
 
-		/* Free node */
-		destroy_dict_node(dict, delete_node);
+		if (dict->arena != NULL) {
+
+			/* Only the content, the nodes go away with the slabs */
+			dict_node_destroy_key(dict, delete_node);
+			dict_node_destroy_values(dict, delete_node);
+		} else {
+
+			/* Free node */
+			destroy_dict_node(dict, delete_node);
+		}
 	}
 
+	/* Free the node slabs */
+	destroy_dict_arena(dict->arena);
+
 	/* Free dictionary */
 	free(dict);
 }
 
+/**
+ * @brief Function to make a dictionary object take its nodes from
+ * an arena instead of the heap. Nodes are carved out of large slabs,
+ * deleted nodes are reused and destroy_dict frees the slabs at once.
+ * 
+ * @param dict pointer to an allocated and empty dictionary object
+ * @param slab_len number of nodes in one slab, 0 for the default
+ * @param use_huge_pages 1 to back large slabs with huge pages
+ * @return uint8_t 1 if the arena was set, 0 otherwise
+ */
+uint8_t dict_set_node_arena(dict_t *dict, size_t slab_len, uint8_t use_huge_pages) {
+	/* The arena can be set just for a new dictionary */
+	if ((dict == NULL) || (dict->root != NULL) || (dict->arena != NULL)) {
+		return 0;
+	}
+
+	dict->arena = create_dict_arena(dict_node_size(dict), slab_len, use_huge_pages);
+
+	return (dict->arena != NULL);
+}
+
+/**
+ * @brief Function to store the short keys of a dictionary object inside
+ * its nodes. Keys that need at most "key_len" bytes are copied by
+ * "inline_key" right after the node metadata, longer keys are still
+ * created with the create_key function.
+ * 
+ * @param dict pointer to an allocated and empty dictionary object
+ * @param key_len number of key bytes to reserve in every node
+ * @param inline_key Function to copy a key object inside the node
+ * @return uint8_t 1 if the inline keys were set, 0 otherwise
+ */
+uint8_t dict_set_inline_keys(dict_t *dict, size_t key_len, inline_func inline_key) {
+	/* The node layout can be changed just for an empty dictionary */
+	if ((dict == NULL) || (dict->root != NULL) || (inline_key == NULL)) {
+		return 0;
+	}
+
+	/* The node size has to fit in a size_t */
+	if (key_len > SIZE_MAX - sizeof(dict_node_t)) {
+		return 0;
+	}
+
+	/* The arena has no live nodes, renew it for the new node size before the layout changes */
+	if (dict->arena != NULL) {
+		dict_arena_t *new_arena = create_dict_arena(sizeof(dict_node_t) + key_len, dict->arena->slab_len, dict->arena->use_huge_pages);
+
+		if (new_arena == NULL) {
+			return 0;
+		}
+
+		destroy_dict_arena(dict->arena);
+		dict->arena = new_arena;
+	}
+
+	dict->inline_key = inline_key;
+	dict->inline_key_len = key_len;
+
+	return 1;
+}
+
+/**
+ * @brief Function to keep the duplicates of a key as a vector of values
+ * inside the key head instead of one node for every duplicate. The next/prev
+ * list links just the key heads and dict_foreach_value gives the values
+ * of a key in insertion order.
+ * 
+ * @param dict pointer to an allocated and empty dictionary object
+ * @return uint8_t 1 if the value vectors were set, 0 otherwise
+ */
+uint8_t dict_set_value_vectors(dict_t *dict) {
+	/* The storage can be changed just for an empty dictionary */
+	if ((dict == NULL) || (dict->root != NULL)) {
+		return 0;
+	}
+
+	dict->value_vectors = 1;
+
+	return 1;
+}
+
+/**
+ * @brief Function to visit the values of one key in insertion order,
+ * for both the duplicate lists and the value vectors
+ * 
+ * @param start_node pointer to the key head
+ * @param visit Function to call for every value
+ * @param data pointer passed to every "visit" call
+ */
+void dict_foreach_value(dict_node_t *start_node, value_visit_func visit, void *data) {
+	/* Check if input data is valid */
+	if ((start_node == NULL) || (visit == NULL)) {
+		return;
+	}
+
+	visit(start_node->value, data);
+
+	if (start_node->dup_values != NULL) {
+
+		/* The other values are in the vector */
+		for (size_t iter = 0; iter + 1 < start_node->count; ++iter) {
+			visit(start_node->dup_values[iter], data);
+		}
+	} else {
+
+		/* The other values are in the duplicate list */
+		for (dict_node_t *iter = start_node; iter != start_node->end; ) {
+			iter = iter->next;
+			visit(iter->value, data);
+		}
+	}
+}
+
 /**
  * @brief Function to check if a dictionary object is empty
  * 
@@ -158,6 +454,67 @@ dict_node_t* dict_search(dict_t *dict, dict_node_t *start_node, const void *key)
 	return NULL;
 }
 
+/**
+ * @brief Subroutine function of the bound searches
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param key pointer to a key location
+ * @param strict 1 to skip the key equal to the input key
+ * @return dict_node_t* pointer to the first key head after the bound or NULL
+ */
+static dict_node_t* dict_bound_helper(dict_t *dict, const void *key, uint8_t strict) {
+	dict_node_t *bound_node = NULL;
+	dict_node_t *iter = dict->root;
+
+	while (iter != NULL) {
+		int32_t cmp_result = dict->cmp(iter->key, key);
+
+		/* Keep the last node that is after the bound */
+		if ((cmp_result > 0) || ((cmp_result == 0) && (strict == 0))) {
+			bound_node = iter;
+			iter = iter->left;
+		} else {
+			iter = iter->right;
+		}
+	}
+
+	return bound_node;
+}
+
+/**
+ * @brief Function to find the first key head that is not
+ * smaller than the input key
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param key pointer to a key location
+ * @return dict_node_t* pointer to a key head or NULL
+ */
+dict_node_t* dict_lower_bound(dict_t *dict, const void *key) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (key == NULL)) {
+		return NULL;
+	}
+
+	return dict_bound_helper(dict, key, 0);
+}
+
+/**
+ * @brief Function to find the first key head that is
+ * greater than the input key
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param key pointer to a key location
+ * @return dict_node_t* pointer to a key head or NULL
+ */
+dict_node_t* dict_upper_bound(dict_t *dict, const void *key) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (key == NULL)) {
+		return NULL;
+	}
+
+	return dict_bound_helper(dict, key, 1);
+}
+
 /**
  * @brief Function to find the minimum dictionary node
  * starting from "start_node"
@@ -257,6 +614,66 @@ dict_node_t* dict_predecessor(dict_node_t *start_node) {
 	return parent_node;
 }
 
+/**
+ * @brief Function to find the level of a dictionary node,
+ * the root is on level 1
+ * 
+ * @param start_node pointer to the node to find its level
+ * @return size_t level of the node or 0 for NULL
+ */
+size_t dict_node_level(dict_node_t *start_node) {
+	size_t node_level = 0;
+
+	/* Climb to the root */
+	while (start_node != NULL) {
+		++node_level;
+		start_node = start_node->parent;
+	}
+
+	return node_level;
+}
+
+/**
+ * @brief Subroutine function of the dict_level_traverse
+ * 
+ * @param start_node pointer to the root of the sub-tree
+ * @param level level to visit, relative to the sub-tree root
+ * @param visit Function to call for every key head on the level
+ * @param data pointer passed to every "visit" call
+ */
+static void dict_level_traverse_helper(dict_node_t *start_node, size_t level, visit_func visit, void *data) {
+	if (start_node == NULL) {
+		return;
+	}
+
+	if (level == 1) {
+		visit(start_node, data);
+		return;
+	}
+
+	dict_level_traverse_helper(start_node->left, level - 1, visit, data);
+	dict_level_traverse_helper(start_node->right, level - 1, visit, data);
+}
+
+/**
+ * @brief Function to visit, in order, every key head found on one
+ * level of the dictionary tree. Only the nodes above the level are
+ * walked through, the nodes below it are never touched.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param level level to visit, the root is on level 1
+ * @param visit Function to call for every key head on the level
+ * @param data pointer passed to every "visit" call
+ */
+void dict_level_traverse(dict_t *dict, size_t level, visit_func visit, void *data) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (visit == NULL) || (level == 0)) {
+		return;
+	}
+
+	dict_level_traverse_helper(dict->root, level, visit, data);
+}
+
 /**
  * @brief Function to update the height of a rotated node
  * 
@@ -283,6 +700,44 @@ void update_height(dict_node_t *fix_node) {
 	}
 }
 
+/**
+ * @brief Function to update the number of entries and of distinct
+ * keys found in the sub-tree of a node, together with the key of the
+ * sub-tree that has the most entries. On ties the greatest key wins.
+ * 
+ * @param fix_node pointer to an allocated dictionary node to fix
+ */
+void update_subtree_size(dict_node_t *fix_node) {
+	/* Check if input node is valid */
+	if (fix_node != NULL) {
+		fix_node->subtree_size = fix_node->count;
+		fix_node->subtree_keys = 1;
+
+		/* Add the left sub-tree */
+		if (fix_node->left != NULL) {
+			fix_node->subtree_size += fix_node->left->subtree_size;
+			fix_node->subtree_keys += fix_node->left->subtree_keys;
+		}
+
+		/* Add the right sub-tree */
+		if (fix_node->right != NULL) {
+			fix_node->subtree_size += fix_node->right->subtree_size;
+			fix_node->subtree_keys += fix_node->right->subtree_keys;
+		}
+
+		/* Pick the most frequent key, the later key wins a tie */
+		fix_node->max_freq = fix_node;
+
+		if ((fix_node->left != NULL) && (fix_node->left->max_freq->count > fix_node->count)) {
+			fix_node->max_freq = fix_node->left->max_freq;
+		}
+
+		if ((fix_node->right != NULL) && (fix_node->right->max_freq->count >= fix_node->max_freq->count)) {
+			fix_node->max_freq = fix_node->right->max_freq;
+		}
+	}
+}
+
 /**
  * @brief Function to rotate to left the fix_node
  * 
@@ -322,9 +777,11 @@ void dict_rotate_left(dict_t *dict, dict_node_t *fix_node) {
 		dict->root = rotate_node;
 	}
 
-	/* Update nodes height */
+	/* Update nodes height and sizes */
 	update_height(fix_node);
 	update_height(rotate_node);
+	update_subtree_size(fix_node);
+	update_subtree_size(rotate_node);
 }
 
 /**
@@ -366,9 +823,11 @@ void dict_rotate_right(dict_t *dict, dict_node_t *fix_node) {
 		dict->root = rotate_node;
 	}
 
-	/* Update nodes height */
+	/* Update nodes height and sizes */
 	update_height(fix_node);
 	update_height(rotate_node);
+	update_subtree_size(fix_node);
+	update_subtree_size(rotate_node);
 }
 
 /**
@@ -409,6 +868,7 @@ static void dict_insert_fix_up(dict_t *dict, dict_node_t *fix_node) {
 	/* Fix every parent node */
 	while (fix_node != NULL) {
 		update_height(fix_node);
+		update_subtree_size(fix_node);
 
 		/* Get balance factors */
 		int64_t balance_fact = dict_get_balance(fix_node);
@@ -486,6 +946,21 @@ void dict_insert(dict_t *dict, const void *key, const void *value) {
 		}
 	}
 
+	/* Same key in a dictionary with value vectors, no new node is needed */
+	if ((iter != NULL) && (dict->value_vectors != 0)) {
+		if (dict_node_push_value(dict, iter, value) != 0) {
+
+			/* The sub-trees above got one more entry */
+			for (dict_node_t *fix_node = iter; fix_node != NULL; fix_node = fix_node->parent) {
+				update_subtree_size(fix_node);
+			}
+
+			++(dict->size);
+		}
+
+		return;
+	}
+
 	dict_node_t *new_node = create_dict_node(dict, key, value);
 
 	if (new_node != NULL) {
@@ -502,6 +977,12 @@ void dict_insert(dict_t *dict, const void *key, const void *value) {
 			iter->end->next = new_node;
 			new_node->prev = iter->end;
 			iter->end = new_node;
+			++(iter->count);
+
+			/* The sub-trees above got one more entry */
+			for (dict_node_t *fix_node = iter; fix_node != NULL; fix_node = fix_node->parent) {
+				update_subtree_size(fix_node);
+			}
 		} else {
 
 			/* No dublicate was found so insert a new node */
@@ -521,7 +1002,7 @@ void dict_insert(dict_t *dict, const void *key, const void *value) {
 				parent_iter->prev = new_node;
 			} else {
 				parent_iter->right = new_node;
-				new_node->prev = parent_iter;
+				new_node->prev = parent_iter->end;
 				new_node->next = parent_iter->end->next;
 
 				if (parent_iter->end->next != NULL) {
@@ -556,6 +1037,7 @@ static void dict_delete_fix_up(dict_t *dict, dict_node_t *fix_node) {
 	/* Fix parent nodes */
 	while (fix_node != NULL) {
 		update_height(fix_node);
+		update_subtree_size(fix_node);
 
 		int64_t balance_fact = dict_get_balance(fix_node);
 		int64_t balance_fact_left = dict_get_balance(fix_node->left);
@@ -588,6 +1070,27 @@ static void dict_delete_fix_up(dict_t *dict, dict_node_t *fix_node) {
 	}
 }
 
+/**
+ * @brief Function to put "new_node" in the tree position of "old_node"
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param old_node pointer to the dictionary node to be replaced
+ * @param new_node pointer to the replacing dictionary node or NULL
+ */
+static void dict_transplant(dict_t *dict, dict_node_t *old_node, dict_node_t *new_node) {
+	if (old_node->parent == NULL) {
+		dict->root = new_node;
+	} else if (old_node->parent->left == old_node) {
+		old_node->parent->left = new_node;
+	} else {
+		old_node->parent->right = new_node;
+	}
+
+	if (new_node != NULL) {
+		new_node->parent = old_node->parent;
+	}
+}
+
 /**
  * @brief Subroutine function fo the dict_delete
  * 
@@ -606,108 +1109,79 @@ static void dict_delete_helper(dict_t *dict, dict_node_t *start_node, const void
 		return;
 	}
 
-	dict_node_t *parent_iter = iter->parent;
+	if (iter->count > 1) {
+		if (dict->value_vectors != 0) {
 
-	if (iter->end == iter) {
-		if (iter->left && iter->right) {
-			dict_node_t *successor_iter = dict_minimum(iter->right);
+			/* Remove the last value from the vector */
+			dict_destroy_value(dict, iter->dup_values[iter->count - 2]);
+		} else {
 
-			dict->destroy_key(iter->key);
-			dict->destroy_value(iter->value);
-			iter->key = dict->create_key(successor_iter->key);
-			iter->value = dict->create_value(successor_iter->value);
+			/* Remove the last duplicate from the list */
+			dict_node_t *delete_node = iter->end;
+			delete_node->prev->next = delete_node->next;
 
-			dict_delete_helper(dict, iter->right, successor_iter->key);
-		} else {
-			if (iter->left != NULL) {
-				iter->left->parent = parent_iter;
-
-				if (parent_iter != NULL) {
-					if (parent_iter->right == iter) {
-						parent_iter->right = iter->left;
-						iter->next->prev = iter->prev;
-						iter->prev->next = iter->next;
-					} else {
-						parent_iter->left = iter->left;
-						parent_iter->prev = iter->prev;
-
-						if (iter->prev != NULL) {
-							iter->prev->next = parent_iter;
-						}
-					}
-				} else {
-					dict->root = iter->left;
-					dict->root->prev = NULL;
-					dict->root->next = NULL;
-				}
-				
-			} else if (iter->right != NULL) {
-				iter->right->parent = parent_iter;
-
-				if (parent_iter != NULL) {
-
-					if (parent_iter->right == iter) {
-						parent_iter->right = iter->right;
-						parent_iter->next = iter->next;
-
-						if (iter->next != NULL) {
-							iter->next->prev = parent_iter;
-						}
-					} else {
-						parent_iter->left = iter->right;
-						iter->prev->next = iter->next;
-						iter->next->prev = iter->prev;
-					}			
-				} else {
-					dict->root = iter->right;
-					dict->root->prev = NULL;
-					dict->root->next = NULL;
-				}
-			} else {
-				if (parent_iter != NULL) {
-					if (parent_iter->right == iter) {
-						parent_iter->right = NULL;
-						parent_iter->next = iter->next;
-
-						if (iter->next != NULL) {
-							iter->next->prev = iter->prev;
-						}
-					}
-					else {
-						parent_iter->left = NULL;
-						parent_iter->prev = iter->prev;
-
-						if (iter->prev != NULL) {
-							iter->prev->next = iter->next;
-						}
-					}
-				} else {
-					dict->root = NULL;
-				}
+			if (delete_node->next != NULL) {
+				delete_node->next->prev = delete_node->prev;
 			}
 
-			destroy_dict_node(dict, iter);
+			iter->end = delete_node->prev;
 
-			dict_delete_fix_up(dict, parent_iter);
+			destroy_dict_node(dict, delete_node);
+		}
+
+		--(iter->count);
 
-			--(dict->size);
+		/* The sub-trees above lost one entry */
+		for (dict_node_t *fix_node = iter; fix_node != NULL; fix_node = fix_node->parent) {
+			update_subtree_size(fix_node);
 		}
-	} else {
-		dict_node_t *delete_node = iter->end;
-		delete_node->prev->next = delete_node->next;
 
-		if (delete_node->next != NULL) {
-			delete_node->next->prev = delete_node->prev;
+		--(dict->size);
+
+		return;
+	}
+
+	dict_node_t *fix_node = iter->parent;
+
+	if ((iter->left != NULL) && (iter->right != NULL)) {
+
+		/* The successor node, with its list, takes the place of the node */
+		dict_node_t *successor_iter = dict_minimum(iter->right);
+
+		if (successor_iter->parent != iter) {
+			fix_node = successor_iter->parent;
+
+			dict_transplant(dict, successor_iter, successor_iter->right);
+			successor_iter->right = iter->right;
+			successor_iter->right->parent = successor_iter;
+		} else {
+			fix_node = successor_iter;
 		}
 
-		iter->end = delete_node->prev;
+		dict_transplant(dict, iter, successor_iter);
+		successor_iter->left = iter->left;
+		successor_iter->left->parent = successor_iter;
+	} else if (iter->left != NULL) {
+		dict_transplant(dict, iter, iter->left);
+	} else {
+		dict_transplant(dict, iter, iter->right);
+	}
 
-		destroy_dict_node(dict, delete_node);
+	/* Remove the node from the list */
+	if (iter->prev != NULL) {
+		iter->prev->next = iter->next;
+	}
 
-		--(dict->size);
+	if (iter->next != NULL) {
+		iter->next->prev = iter->prev;
 	}
-}
 
+	destroy_dict_node(dict, iter);
+
+	dict_delete_fix_up(dict, fix_node);
+
+	--(dict->size);
+}
 
 /**
  * @brief Function to delete one key node from the dictionary
@@ -717,4 +1191,1670 @@ static void dict_delete_helper(dict_t *dict, dict_node_t *start_node, const void
  */
 void dict_delete(dict_t *dict, const void *key) {
 	dict_delete_helper(dict, dict->root, key);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Subroutine function of the bulk load to link a perfectly
+ * balanced tree over the next "len" key heads of a sorted list
+ * 
+ * @param cursor pointer to the next key head to be linked in the tree
+ * @param len number of key heads to link in the tree
+ * @param parent pointer to the parent of the new sub-tree
+ * @return dict_node_t* pointer to the root of the new sub-tree or NULL
+ */
+static dict_node_t* dict_build_balanced(dict_node_t **cursor, size_t len, dict_node_t *parent) {
+	if (len == 0) {
+		return NULL;
+	}
+
+	/* The left half goes first to follow the list order */
+	size_t left_len = len / 2;
+
+	dict_node_t *left_node = dict_build_balanced(cursor, left_len, NULL);
+
+	dict_node_t *root_node = *cursor;
+	*cursor = root_node->end->next;
+
+	root_node->parent = parent;
+	root_node->left = left_node;
+
+	if (left_node != NULL) {
+		left_node->parent = root_node;
+	}
+
+	root_node->right = dict_build_balanced(cursor, len - left_len - 1, root_node);
+
+	update_height(root_node);
+	update_subtree_size(root_node);
+
+	return root_node;
+}
+
+/**
+ * @brief Function to link a dictionary tree over a sorted list of
+ * key heads in linear time. The list and the end links are kept.
+ * 
+ * @param dict pointer to an allocated and empty dictionary object
+ * @param first_node pointer to the first node of the sorted list
+ * @param heads number of distinct keys in the list
+ */
+static void dict_build_from_list(dict_t *dict, dict_node_t *first_node, size_t heads) {
+	dict_node_t *cursor = first_node;
+
+	dict->root = dict_build_balanced(&cursor, heads, NULL);
+}
+
+/**
+ * @brief Function to load an empty dictionary from a stream of sorted
+ * (key, value) pairs. The pairs are linked in the next/prev list as they
+ * come and the balanced tree is built over the list in linear time,
+ * runs of equal keys become duplicate lists in stream order.
+ * A pair that breaks the order, and every pair after it,
+ * is added with dict_insert.
+ * 
+ * @param dict pointer to an allocated and empty dictionary object
+ * @param next_pair Function to read the next pair from the stream
+ * @param stream pointer to the stream state passed to "next_pair"
+ */
+void dict_bulk_load_stream(dict_t *dict, bulk_next_func next_pair, void *stream) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (next_pair == NULL) || (dict->root != NULL)) {
+		return;
+	}
+
+	dict_node_t *first_node = NULL;
+	dict_node_t *last_node = NULL;
+	dict_node_t *last_head = NULL;
+
+	size_t heads = 0;
+
+	const void *key = NULL;
+	const void *value = NULL;
+
+	uint8_t is_sorted = 1;
+
+	/* Link the sorted pairs in the list */
+	while (next_pair(stream, &key, &value) != 0) {
+		if ((last_head != NULL) && (dict->cmp(last_head->key, key) > 0)) {
+			is_sorted = 0;
+			break;
+		}
+
+		/* Same key in a dictionary with value vectors, no new node is needed */
+		if ((last_head != NULL) && (dict->value_vectors != 0) && (dict->cmp(last_head->key, key) == 0)) {
+			if (dict_node_push_value(dict, last_head, value) != 0) {
+				++(dict->size);
+			}
+
+			continue;
+		}
+
+		dict_node_t *new_node = create_dict_node(dict, key, value);
+
+		if (new_node == NULL) {
+			continue;
+		}
+
+		if ((last_head != NULL) && (dict->cmp(last_head->key, key) == 0)) {
+
+			/* Same key, add to the duplicate list */
+			last_head->end = new_node;
+			++(last_head->count);
+		} else {
+			new_node->end = new_node;
+			last_head = new_node;
+			++heads;
+		}
+
+		new_node->prev = last_node;
+
+		if (last_node != NULL) {
+			last_node->next = new_node;
+		} else {
+			first_node = new_node;
+		}
+
+		last_node = new_node;
+		++(dict->size);
+	}
+
+	/* Build the tree over the list */
+	dict_build_from_list(dict, first_node, heads);
+
+	/* Insert the rest of an unsorted stream */
+	if (is_sorted == 0) {
+		do {
+			dict_insert(dict, key, value);
+		} while (next_pair(stream, &key, &value) != 0);
+	}
+}
+
+/**
+ * @brief Definition of an array stream used by dict_bulk_load
+ * 
+ */
+typedef struct dict_array_stream_s {
+	const void * const *keys;				/* Array of key locations */
+	const void * const *values;				/* Array of value locations */
+	size_t len;								/* Number of pairs in the arrays */
+	size_t idx;								/* Index of the next pair */
+} dict_array_stream_t;
+
+/**
+ * @brief Function to read the next pair from an array stream
+ * 
+ * @param stream pointer to a dict_array_stream_t object
+ * @param key pointer to store the key location
+ * @param value pointer to store the value location
+ * @return uint8_t 1 if a pair was read, 0 at the end of the arrays
+ */
+static uint8_t dict_array_next_pair(void *stream, const void **key, const void **value) {
+	dict_array_stream_t *array_stream = stream;
+
+	if (array_stream->idx == array_stream->len) {
+		return 0;
+	}
+
+	*key = array_stream->keys[array_stream->idx];
+	*value = array_stream->values[array_stream->idx];
+	++(array_stream->idx);
+
+	return 1;
+}
+
+/**
+ * @brief Function to load an empty dictionary from sorted arrays
+ * of keys and values in linear time, see dict_bulk_load_stream
+ * 
+ * @param dict pointer to an allocated and empty dictionary object
+ * @param keys array of sorted key locations
+ * @param values array of value locations
+ * @param len number of (key, value) pairs
+ */
+void dict_bulk_load(dict_t *dict, const void * const *keys, const void * const *values, size_t len) {
+	/* Check if input data is valid */
+	if ((keys == NULL) || (values == NULL)) {
+		return;
+	}
+
+	dict_array_stream_t array_stream = { keys, values, len, 0 };
+
+	dict_bulk_load_stream(dict, dict_array_next_pair, &array_stream);
+}
+
+
+/**
+ * @brief Subroutine function of the rank queries
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param key pointer to a key location
+ * @param inclusive 1 to count the entries equal to the key as well
+ * @return size_t number of entries smaller (or equal) than the key
+ */
+static size_t dict_rank_helper(dict_t *dict, const void *key, uint8_t inclusive) {
+	size_t rank = 0;
+
+	dict_node_t *iter = dict->root;
+
+	while (iter != NULL) {
+		int32_t cmp_result = dict->cmp(iter->key, key);
+
+		if (cmp_result > 0) {
+			iter = iter->left;
+			continue;
+		}
+
+		/* The left sub-tree is before the key */
+		if (iter->left != NULL) {
+			rank += iter->left->subtree_size;
+		}
+
+		if (cmp_result == 0) {
+			if (inclusive != 0) {
+				rank += iter->count;
+			}
+
+			break;
+		}
+
+		/* The node is before the key as well */
+		rank += iter->count;
+		iter = iter->right;
+	}
+
+	return rank;
+}
+
+/**
+ * @brief Function to find how many entries, duplicates included,
+ * have a key smaller than the input key
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param key pointer to a key location
+ * @return size_t the rank of the key
+ */
+size_t dict_rank(dict_t *dict, const void *key) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (key == NULL)) {
+		return 0;
+	}
+
+	return dict_rank_helper(dict, key, 0);
+}
+
+/**
+ * @brief Function to find the key whose duplicate list holds the
+ * entry with the index "idx" in sorted order, counting from 0
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param idx index of the entry
+ * @return dict_node_t* pointer to the key head or NULL
+ */
+dict_node_t* dict_select(dict_t *dict, size_t idx) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (dict->root == NULL) || (idx >= dict->root->subtree_size)) {
+		return NULL;
+	}
+
+	dict_node_t *iter = dict->root;
+
+	while (iter != NULL) {
+		size_t left_size = (iter->left != NULL) ? iter->left->subtree_size : 0;
+
+		if (idx < left_size) {
+			iter = iter->left;
+		} else if (idx < left_size + iter->count) {
+			return iter;
+		} else {
+			idx -= left_size + iter->count;
+			iter = iter->right;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Function to find the distinct key with the index "idx"
+ * in sorted order, counting from 0
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param idx index of the distinct key
+ * @return dict_node_t* pointer to the key head or NULL
+ */
+dict_node_t* dict_select_key(dict_t *dict, size_t idx) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (dict->root == NULL) || (idx >= dict->root->subtree_keys)) {
+		return NULL;
+	}
+
+	dict_node_t *iter = dict->root;
+
+	while (iter != NULL) {
+		size_t left_keys = (iter->left != NULL) ? iter->left->subtree_keys : 0;
+
+		if (idx < left_keys) {
+			iter = iter->left;
+		} else if (idx == left_keys) {
+			return iter;
+		} else {
+			idx -= left_keys + 1;
+			iter = iter->right;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Function to find the key with the most entries in the
+ * dictionary, when more keys have the same number of entries
+ * the greatest of them is returned
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @return dict_node_t* pointer to the key head or NULL
+ */
+dict_node_t* dict_most_frequent(dict_t *dict) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (dict->root == NULL)) {
+		return NULL;
+	}
+
+	return dict->root->max_freq;
+}
+
+/**
+ * @brief Function to count the entries, duplicates included,
+ * with a key between "left" and "right", both ends included
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param left pointer to the lower key of the range
+ * @param right pointer to the upper key of the range
+ * @return size_t number of entries in the range
+ */
+size_t dict_count_range(dict_t *dict, const void *left, const void *right) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (left == NULL) || (right == NULL) || (dict->cmp(left, right) > 0)) {
+		return 0;
+	}
+
+	return dict_rank_helper(dict, right, 1) - dict_rank_helper(dict, left, 0);
+}
+
+/**
+ * @brief Definition of a detached part of a dictionary tree, together
+ * with the first and the last entry of its ordered list
+ * 
+ */
+typedef struct dict_part_s {
+	dict_node_t *root;						/* Pointer to the root of the part or NULL */
+	dict_node_t *first;						/* Pointer to the first entry of the part */
+	dict_node_t *last;						/* Pointer to the last entry of the part */
+} dict_part_t;
+
+/**
+ * @brief Definition of the data used to copy the values of one key
+ * 
+ */
+typedef struct dict_copy_s {
+	dict_t *dict;							/* Dictionary that takes the entries */
+	const void *key;						/* Key of the copied values */
+} dict_copy_t;
+
+/**
+ * @brief Function to detach the left sub-tree of a part root. It has to be
+ * called before the list links of the root are changed.
+ * 
+ * @param tree a non empty part
+ * @return dict_part_t the left sub-tree as a part
+ */
+static dict_part_t dict_part_left(dict_part_t tree) {
+	dict_part_t part = {tree.root->left, NULL, NULL};
+
+	if (part.root != NULL) {
+		part.root->parent = NULL;
+		part.first = tree.first;
+		part.last = tree.root->prev;
+	}
+
+	return part;
+}
+
+/**
+ * @brief Function to detach the right sub-tree of a part root. It has to be
+ * called before the list links of the root are changed.
+ * 
+ * @param tree a non empty part
+ * @return dict_part_t the right sub-tree as a part
+ */
+static dict_part_t dict_part_right(dict_part_t tree) {
+	dict_part_t part = {tree.root->right, NULL, NULL};
+
+	if (part.root != NULL) {
+		part.root->parent = NULL;
+		part.first = tree.root->end->next;
+		part.last = tree.last;
+	}
+
+	return part;
+}
+
+/**
+ * @brief Function to join two AVL trees and a middle node, all the keys of
+ * "left" are smaller and all the keys of "right" are greater than its key.
+ * The middle node goes down the spine of the higher tree until the heights
+ * match, so the cost is the difference of the two heights.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param left pointer to the root of the left tree or NULL
+ * @param mid pointer to the middle node
+ * @param right pointer to the root of the right tree or NULL
+ * @return dict_node_t* pointer to the root of the joined tree
+ */
+static dict_node_t* dict_join_tree(dict_t *dict, dict_node_t *left, dict_node_t *mid, dict_node_t *right) {
+	int64_t left_height = (left != NULL) ? left->height : 0;
+	int64_t right_height = (right != NULL) ? right->height : 0;
+
+	/* The rotations update the root of a scratch dictionary */
+	dict_t work = *dict;
+	dict_node_t *parent = NULL;
+	dict_node_t *iter = NULL;
+
+	if (left_height > right_height + 1) {
+
+		/* Walk down the right spine of the left tree */
+		work.root = left;
+
+		for (iter = left; (iter != NULL) && (iter->height > right_height + 1); iter = iter->right) {
+			parent = iter;
+		}
+
+		mid->left = iter;
+		mid->right = right;
+		parent->right = mid;
+	} else if (right_height > left_height + 1) {
+
+		/* Walk down the left spine of the right tree */
+		work.root = right;
+
+		for (iter = right; (iter != NULL) && (iter->height > left_height + 1); iter = iter->left) {
+			parent = iter;
+		}
+
+		mid->left = left;
+		mid->right = iter;
+		parent->left = mid;
+	} else {
+		work.root = mid;
+		mid->left = left;
+		mid->right = right;
+	}
+
+	mid->parent = parent;
+
+	if (mid->left != NULL) {
+		mid->left->parent = mid;
+	}
+
+	if (mid->right != NULL) {
+		mid->right->parent = mid;
+	}
+
+	update_height(mid);
+	update_subtree_size(mid);
+
+	/* Rebalance the spine above the middle node */
+	dict_delete_fix_up(&work, parent);
+
+	return work.root;
+}
+
+/**
+ * @brief Function to join two parts and a middle key head,
+ * the entries of the key are linked between the two lists
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param left the part with the smaller keys
+ * @param mid pointer to the key head
+ * @param right the part with the greater keys
+ * @return dict_part_t the joined part
+ */
+static dict_part_t dict_part_join(dict_t *dict, dict_part_t left, dict_node_t *mid, dict_part_t right) {
+	mid->prev = left.last;
+	mid->end->next = right.first;
+
+	if (left.last != NULL) {
+		left.last->next = mid;
+	}
+
+	if (right.first != NULL) {
+		right.first->prev = mid->end;
+	}
+
+	dict_part_t part = {dict_join_tree(dict, left.root, mid, right.root), left.first, right.last};
+
+	if (part.first == NULL) {
+		part.first = mid;
+	}
+
+	if (part.last == NULL) {
+		part.last = mid->end;
+	}
+
+	return part;
+}
+
+/**
+ * @brief Function to split a part by a key, in the part with the smaller
+ * keys, the head of the key and the part with the greater keys
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param tree the part to split
+ * @param key pointer to the key location
+ * @param left where to write the part with the smaller keys
+ * @param match where to write the head of the key or NULL
+ * @param right where to write the part with the greater keys
+ */
+static void dict_part_split(dict_t *dict, dict_part_t tree, const void *key, dict_part_t *left, dict_node_t **match, dict_part_t *right) {
+	if (tree.root == NULL) {
+		*left = *right = tree;
+		*match = NULL;
+		return;
+	}
+
+	dict_node_t *mid = tree.root;
+	dict_part_t sub_left = dict_part_left(tree);
+	dict_part_t sub_right = dict_part_right(tree);
+	dict_part_t inner;
+
+	int32_t cmp_result = dict->cmp(mid->key, key);
+
+	if (cmp_result == 0) {
+		*left = sub_left;
+		*match = mid;
+		*right = sub_right;
+	} else if (cmp_result > 0) {
+		dict_part_split(dict, sub_left, key, left, match, &inner);
+		*right = dict_part_join(dict, inner, mid, sub_right);
+	} else {
+		dict_part_split(dict, sub_right, key, &inner, match, right);
+		*left = dict_part_join(dict, sub_left, mid, inner);
+	}
+}
+
+/**
+ * @brief Function to detach the key head with the greatest key of a part
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param tree a non empty part
+ * @param last where to write the detached key head
+ * @return dict_part_t the part without the greatest key
+ */
+static dict_part_t dict_part_split_last(dict_t *dict, dict_part_t tree, dict_node_t **last) {
+	dict_node_t *mid = tree.root;
+	dict_part_t sub_left = dict_part_left(tree);
+
+	if (mid->right == NULL) {
+		*last = mid;
+		return sub_left;
+	}
+
+	dict_part_t sub_right = dict_part_right(tree);
+	dict_part_t rest = dict_part_split_last(dict, sub_right, last);
+
+	return dict_part_join(dict, sub_left, mid, rest);
+}
+
+/**
+ * @brief Function to join two parts without a middle key head
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param left the part with the smaller keys
+ * @param right the part with the greater keys
+ * @return dict_part_t the joined part
+ */
+static dict_part_t dict_part_concat(dict_t *dict, dict_part_t left, dict_part_t right) {
+	if (left.root == NULL) {
+		return right;
+	}
+
+	if (right.root == NULL) {
+		return left;
+	}
+
+	dict_node_t *mid = NULL;
+	dict_part_t rest = dict_part_split_last(dict, left, &mid);
+
+	return dict_part_join(dict, rest, mid, right);
+}
+
+/**
+ * @brief Function to destroy the list entries from "first" to "last"
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param first pointer to the first entry or NULL
+ * @param last pointer to the last entry
+ */
+static void dict_destroy_entries(dict_t *dict, dict_node_t *first, dict_node_t *last) {
+	dict_node_t *iter = first;
+
+	while (iter != NULL) {
+		dict_node_t *delete_node = iter;
+
+		iter = (iter == last) ? NULL : iter->next;
+
+		destroy_dict_node(dict, delete_node);
+	}
+}
+
+/**
+ * @brief Function to move the entries of a key head after the entries
+ * of the head with the same key, "other" is not a head anymore
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param head pointer to the key head that keeps the entries
+ * @param other pointer to the key head to move
+ */
+static void dict_node_absorb(dict_t *dict, dict_node_t *head, dict_node_t *other) {
+	if (dict->value_vectors != 0) {
+		void *value = other->value;
+
+		/* Move the value objects, then free the rest of the node */
+		for (size_t iter = 0; iter < other->count; ++iter) {
+			if (dict_node_append_value(head, value) == 0) {
+				dict_destroy_value(dict, value);
+			}
+
+			value = (iter + 1 < other->count) ? other->dup_values[iter] : NULL;
+		}
+
+		dict_node_destroy_key(dict, other);
+		free(other->dup_values);
+		dict_node_free(dict, other);
+
+		return;
+	}
+
+	/* Append the duplicate list of "other" */
+	head->end->next = other;
+	other->prev = head->end;
+	head->end = other->end;
+	head->count += other->count;
+
+	other->end = NULL;
+	other->parent = other->left = other->right = NULL;
+}
+
+/**
+ * @brief Subroutine function of the dict_union
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param tree1 the part that keeps its entries first
+ * @param tree2 the part to add
+ * @return dict_part_t the union of the two parts
+ */
+static dict_part_t dict_union_helper(dict_t *dict, dict_part_t tree1, dict_part_t tree2) {
+	if (tree1.root == NULL) {
+		return tree2;
+	}
+
+	if (tree2.root == NULL) {
+		return tree1;
+	}
+
+	dict_node_t *mid = tree1.root;
+	dict_part_t sub_left = dict_part_left(tree1);
+	dict_part_t sub_right = dict_part_right(tree1);
+
+	dict_part_t left2, right2;
+	dict_node_t *match = NULL;
+
+	dict_part_split(dict, tree2, mid->key, &left2, &match, &right2);
+
+	dict_part_t left = dict_union_helper(dict, sub_left, left2);
+	dict_part_t right = dict_union_helper(dict, sub_right, right2);
+
+	if (match != NULL) {
+		dict_node_absorb(dict, mid, match);
+	}
+
+	return dict_part_join(dict, left, mid, right);
+}
+
+/**
+ * @brief Subroutine function of the dict_intersection
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param tree1 the part that keeps its entries
+ * @param tree2 the part with the keys to keep, its entries are destroyed
+ * @return dict_part_t the intersection of the two parts
+ */
+static dict_part_t dict_intersection_helper(dict_t *dict, dict_part_t tree1, dict_part_t tree2) {
+	if ((tree1.root == NULL) || (tree2.root == NULL)) {
+		dict_part_t empty = {NULL, NULL, NULL};
+
+		dict_destroy_entries(dict, tree1.first, tree1.last);
+		dict_destroy_entries(dict, tree2.first, tree2.last);
+
+		return empty;
+	}
+
+	dict_node_t *mid = tree1.root;
+	dict_part_t sub_left = dict_part_left(tree1);
+	dict_part_t sub_right = dict_part_right(tree1);
+
+	dict_part_t left2, right2;
+	dict_node_t *match = NULL;
+
+	dict_part_split(dict, tree2, mid->key, &left2, &match, &right2);
+
+	dict_part_t left = dict_intersection_helper(dict, sub_left, left2);
+	dict_part_t right = dict_intersection_helper(dict, sub_right, right2);
+
+	if (match != NULL) {
+		dict_destroy_entries(dict, match, match->end);
+
+		return dict_part_join(dict, left, mid, right);
+	}
+
+	dict_destroy_entries(dict, mid, mid->end);
+
+	return dict_part_concat(dict, left, right);
+}
+
+/**
+ * @brief Subroutine function of the dict_difference
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param tree1 the part that keeps its entries
+ * @param tree2 the part with the keys to remove, its entries are destroyed
+ * @return dict_part_t the difference of the two parts
+ */
+static dict_part_t dict_difference_helper(dict_t *dict, dict_part_t tree1, dict_part_t tree2) {
+	if ((tree1.root == NULL) || (tree2.root == NULL)) {
+		dict_destroy_entries(dict, tree2.first, tree2.last);
+
+		return tree1;
+	}
+
+	dict_node_t *mid = tree1.root;
+	dict_part_t sub_left = dict_part_left(tree1);
+	dict_part_t sub_right = dict_part_right(tree1);
+
+	dict_part_t left2, right2;
+	dict_node_t *match = NULL;
+
+	dict_part_split(dict, tree2, mid->key, &left2, &match, &right2);
+
+	dict_part_t left = dict_difference_helper(dict, sub_left, left2);
+	dict_part_t right = dict_difference_helper(dict, sub_right, right2);
+
+	if (match != NULL) {
+		dict_destroy_entries(dict, match, match->end);
+		dict_destroy_entries(dict, mid, mid->end);
+
+		return dict_part_concat(dict, left, right);
+	}
+
+	return dict_part_join(dict, left, mid, right);
+}
+
+/**
+ * @brief Function to take the whole tree of a dictionary as a part,
+ * the dictionary is left empty
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @return dict_part_t the tree of the dictionary
+ */
+static dict_part_t dict_take_part(dict_t *dict) {
+	dict_part_t part = {dict->root, NULL, NULL};
+
+	if (part.root != NULL) {
+		part.first = dict_minimum(part.root);
+		part.last = dict_maximum(part.root)->end;
+	}
+
+	dict->root = NULL;
+	dict->size = 0;
+
+	return part;
+}
+
+/**
+ * @brief Function to make a part the tree of an empty dictionary
+ * 
+ * @param dict pointer to an allocated and empty dictionary object
+ * @param part the new tree of the dictionary
+ */
+static void dict_put_part(dict_t *dict, dict_part_t part) {
+	dict->root = part.root;
+	dict->size = 0;
+
+	if (part.root != NULL) {
+		part.root->parent = NULL;
+		part.first->prev = NULL;
+		part.last->next = NULL;
+
+		dict->size = part.root->subtree_size;
+	}
+}
+
+/**
+ * @brief Function to create an empty dictionary with the same functions
+ * and node layout, the node arena is shared with "dict"
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @return dict_t* pointer to the new dictionary or NULL
+ */
+static dict_t* dict_create_like(dict_t *dict) {
+	dict_t *new_dict = create_dict(dict->create_key, dict->destroy_key, dict->create_value, dict->destroy_value, dict->cmp);
+
+	if (new_dict != NULL) {
+		new_dict->arena = dict_arena_share(dict->arena);
+		new_dict->inline_key = dict->inline_key;
+		new_dict->inline_key_len = dict->inline_key_len;
+		new_dict->value_vectors = dict->value_vectors;
+	}
+
+	return new_dict;
+}
+
+/**
+ * @brief Function to insert a copy of one value, used by dict_foreach_value
+ * 
+ * @param value pointer to the value location
+ * @param data pointer to a dict_copy_t object
+ */
+static void dict_copy_value(void *value, void *data) {
+	dict_copy_t *copy = data;
+
+	dict_insert(copy->dict, copy->key, value);
+}
+
+/**
+ * @brief Function to take the tree of "other" for a set operation with
+ * "dict" and to free the "other" object. The nodes are moved when both
+ * dictionaries have the same functions and node layout, otherwise they
+ * are copied in a dictionary like "dict" first.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param other pointer to an allocated dictionary object, it is freed
+ * @return dict_part_t the tree of "other"
+ */
+static dict_part_t dict_adopt_part(dict_t *dict, dict_t *other) {
+	uint8_t is_compatible = (dict->create_key == other->create_key) && (dict->destroy_key == other->destroy_key) &&
+							(dict->create_value == other->create_value) && (dict->destroy_value == other->destroy_value) &&
+							(dict->cmp == other->cmp) && (dict->inline_key == other->inline_key) &&
+							(dict->inline_key_len == other->inline_key_len) && (dict->value_vectors == other->value_vectors);
+
+	/* The nodes of "other" have to come from the same arena or move with their slabs */
+	if ((is_compatible != 0) && (dict->arena != other->arena)) {
+		is_compatible = dict_arena_merge(dict->arena, other->arena);
+
+		if (is_compatible != 0) {
+			other->arena = NULL;
+		}
+	}
+
+	if (is_compatible == 0) {
+		dict_t *copy = dict_create_like(dict);
+
+		if (copy == NULL) {
+			destroy_dict(other);
+
+			dict_part_t empty = {NULL, NULL, NULL};
+			return empty;
+		}
+
+		/* Copy the entries in order, key by key */
+		for (dict_node_t *iter = dict_minimum(other->root); iter != NULL; iter = iter->end->next) {
+			dict_copy_t copy_data = {copy, iter->key};
+
+			dict_foreach_value(iter, dict_copy_value, &copy_data);
+		}
+
+		destroy_dict(other);
+		other = copy;
+	}
+
+	dict_part_t part = dict_take_part(other);
+
+	/* The heap keys of "other" belong to "dict" now */
+	dict->heap_keys += other->heap_keys;
+	destroy_dict(other);
+
+	return part;
+}
+
+/**
+ * @brief Function to join two dictionaries, all the keys of "other" have
+ * to be greater than the keys of "dict". The entries of "other" move to
+ * "dict" in O(log n) time and the "other" object is freed.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param other pointer to an allocated dictionary object with greater keys
+ * @return uint8_t 1 if the dictionaries were joined, 0 otherwise
+ */
+uint8_t dict_join(dict_t *dict, dict_t *other) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (other == NULL) || (dict == other)) {
+		return 0;
+	}
+
+	/* The keys have to be ordered */
+	if ((dict->root != NULL) && (other->root != NULL) &&
+		(dict->cmp(dict_maximum(dict->root)->key, dict_minimum(other->root)->key) >= 0)) {
+		return 0;
+	}
+
+	dict_part_t part2 = dict_adopt_part(dict, other);
+	dict_part_t part1 = dict_take_part(dict);
+
+	dict_put_part(dict, dict_part_concat(dict, part1, part2));
+
+	return 1;
+}
+
+/**
+ * @brief Function to split a dictionary by a key in O(log n) time. The
+ * entries with a key greater or equal than "key" move to a new dictionary
+ * with the same functions, node layout and node arena.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param key pointer to the key location
+ * @return dict_t* pointer to the dictionary with the greater keys or NULL
+ */
+dict_t* dict_split_at(dict_t *dict, const void *key) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (key == NULL)) {
+		return NULL;
+	}
+
+	dict_t *new_dict = dict_create_like(dict);
+
+	if (new_dict == NULL) {
+		return NULL;
+	}
+
+	dict_part_t left, right;
+	dict_node_t *match = NULL;
+
+	dict_part_split(dict, dict_take_part(dict), key, &left, &match, &right);
+
+	/* The entries of the key go to the right */
+	if (match != NULL) {
+		dict_part_t empty = {NULL, NULL, NULL};
+
+		right = dict_part_join(dict, empty, match, right);
+	}
+
+	dict_put_part(dict, left);
+	dict_put_part(new_dict, right);
+
+	/* Both sides keep the bound, the keys are not counted again */
+	new_dict->heap_keys = dict->heap_keys;
+
+	return new_dict;
+}
+
+/**
+ * @brief Function to add all the entries of "other" to "dict" in
+ * O(m log(n/m + 1)) time, for a key found in both dictionaries the
+ * entries of "other" go after the ones of "dict". The "other"
+ * object is freed.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param other pointer to an allocated dictionary object
+ */
+void dict_union(dict_t *dict, dict_t *other) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (other == NULL) || (dict == other)) {
+		return;
+	}
+
+	dict_part_t part2 = dict_adopt_part(dict, other);
+	dict_part_t part1 = dict_take_part(dict);
+
+	dict_put_part(dict, dict_union_helper(dict, part1, part2));
+}
+
+/**
+ * @brief Function to keep in "dict" just the keys found in "other" as well,
+ * in O(m log(n/m + 1)) time. The kept keys keep the entries of "dict",
+ * the "other" object is freed.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param other pointer to an allocated dictionary object
+ */
+void dict_intersection(dict_t *dict, dict_t *other) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (other == NULL) || (dict == other)) {
+		return;
+	}
+
+	dict_part_t part2 = dict_adopt_part(dict, other);
+	dict_part_t part1 = dict_take_part(dict);
+
+	dict_put_part(dict, dict_intersection_helper(dict, part1, part2));
+}
+
+/**
+ * @brief Function to remove from "dict" all the keys found in "other",
+ * in O(m log(n/m + 1)) time. The "other" object is freed.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param other pointer to an allocated dictionary object
+ */
+void dict_difference(dict_t *dict, dict_t *other) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (other == NULL) || (dict == other)) {
+		return;
+	}
+
+	dict_part_t part2 = dict_adopt_part(dict, other);
+	dict_part_t part1 = dict_take_part(dict);
+
+	dict_put_part(dict, dict_difference_helper(dict, part1, part2));
+}
+
+/**
+ * @brief Function to sort the positions of a batch by key, equal keys
+ * keep the order of the batch
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param keys array of key locations
+ * @param order array with the positions 0, ..., len - 1 to sort
+ * @param len number of keys
+ * @return uint8_t 1 if the positions were sorted, 0 otherwise
+ */
+static uint8_t dict_sort_batch(dict_t *dict, const void * const *keys, size_t *order, size_t len) {
+	size_t *buffer = malloc(sizeof(*buffer) * len);
+
+	if (buffer == NULL) {
+		return 0;
+	}
+
+	/* Bottom-up merge sort */
+	for (size_t width = 1; width < len; width *= 2) {
+		for (size_t low = 0; low < len; low += 2 * width) {
+			size_t mid = MIN(low + width, len);
+			size_t high = MIN(low + 2 * width, len);
+			size_t left = low, right = mid, out = low;
+
+			while ((left < mid) && (right < high)) {
+				if (dict->cmp(keys[order[right]], keys[order[left]]) < 0) {
+					buffer[out++] = order[right++];
+				} else {
+					buffer[out++] = order[left++];
+				}
+			}
+
+			while (left < mid) {
+				buffer[out++] = order[left++];
+			}
+
+			while (right < high) {
+				buffer[out++] = order[right++];
+			}
+		}
+
+		memcpy(order, buffer, sizeof(*order) * len);
+	}
+
+	free(buffer);
+
+	return 1;
+}
+
+/**
+ * @brief Function to insert a batch of entries. The batch is sorted,
+ * linked in a balanced tree and added with dict_union, so every sub-tree
+ * of the dictionary is visited and rebalanced at most once.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param keys array of key locations
+ * @param values array of value locations
+ * @param len number of entries in the batch
+ */
+void dict_insert_batch(dict_t *dict, const void * const *keys, const void * const *values, size_t len) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (keys == NULL) || (values == NULL) || (len == 0)) {
+		return;
+	}
+
+	size_t *order = malloc(sizeof(*order) * len);
+	const void **sorted_keys = malloc(sizeof(*sorted_keys) * len);
+	const void **sorted_values = malloc(sizeof(*sorted_values) * len);
+	dict_t *batch = dict_create_like(dict);
+
+	if ((order == NULL) || (sorted_keys == NULL) || (sorted_values == NULL) || (batch == NULL)) {
+		free(order);
+		free(sorted_keys);
+		free(sorted_values);
+		destroy_dict(batch);
+		return;
+	}
+
+	for (size_t iter = 0; iter < len; ++iter) {
+		order[iter] = iter;
+	}
+
+	if (dict_sort_batch(dict, keys, order, len) != 0) {
+		for (size_t iter = 0; iter < len; ++iter) {
+			sorted_keys[iter] = keys[order[iter]];
+			sorted_values[iter] = values[order[iter]];
+		}
+
+		dict_bulk_load(batch, sorted_keys, sorted_values, len);
+	} else {
+
+		/* No memory to sort, the bulk load inserts the pairs one by one */
+		dict_bulk_load(batch, keys, values, len);
+	}
+
+	dict_union(dict, batch);
+
+	free(order);
+	free(sorted_keys);
+	free(sorted_values);
+}
+
+/**
+ * @brief Function to remove the last "len" entries of a key head
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param head pointer to the key head
+ * @param len number of entries to remove, smaller than the entries of the key
+ */
+static void dict_node_remove_last(dict_t *dict, dict_node_t *head, size_t len) {
+	for (size_t iter = 0; iter < len; ++iter) {
+		if (dict->value_vectors != 0) {
+			dict_destroy_value(dict, head->dup_values[head->count - 2]);
+		} else {
+			dict_node_t *delete_node = head->end;
+
+			head->end = delete_node->prev;
+			destroy_dict_node(dict, delete_node);
+		}
+
+		--(head->count);
+	}
+}
+
+/**
+ * @brief Subroutine function of the dict_delete_batch, it splits the part
+ * at the middle key of the sorted batch and deletes the two halves of
+ * the batch from the two sides
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param tree the part to delete from
+ * @param keys sorted array of key locations
+ * @param len number of keys
+ * @return dict_part_t the part without the deleted entries
+ */
+static dict_part_t dict_delete_batch_helper(dict_t *dict, dict_part_t tree, const void * const *keys, size_t len) {
+	if ((tree.root == NULL) || (len == 0)) {
+		return tree;
+	}
+
+	/* The run of the middle key in the batch */
+	size_t first = len / 2, last = len / 2;
+
+	while ((first > 0) && (dict->cmp(keys[first - 1], keys[len / 2]) == 0)) {
+		--first;
+	}
+
+	while ((last + 1 < len) && (dict->cmp(keys[last + 1], keys[len / 2]) == 0)) {
+		++last;
+	}
+
+	dict_part_t left, right;
+	dict_node_t *match = NULL;
+
+	dict_part_split(dict, tree, keys[len / 2], &left, &match, &right);
+
+	left = dict_delete_batch_helper(dict, left, keys, first);
+	right = dict_delete_batch_helper(dict, right, keys + last + 1, len - last - 1);
+
+	if (match == NULL) {
+		return dict_part_concat(dict, left, right);
+	}
+
+	/* Every key of the batch removes the last entry */
+	if (last - first + 1 >= match->count) {
+		dict_destroy_entries(dict, match, match->end);
+
+		return dict_part_concat(dict, left, right);
+	}
+
+	dict_node_remove_last(dict, match, last - first + 1);
+
+	return dict_part_join(dict, left, match, right);
+}
+
+/**
+ * @brief Function to delete a batch of keys, every key of the batch
+ * removes the last entry of the key like dict_delete. The sorted batch
+ * splits the tree once per distinct key and the parts are joined back,
+ * so every sub-tree is rebalanced at most once.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param keys array of key locations
+ * @param len number of keys in the batch
+ */
+void dict_delete_batch(dict_t *dict, const void * const *keys, size_t len) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (keys == NULL) || (len == 0) || (dict->root == NULL)) {
+		return;
+	}
+
+	size_t *order = malloc(sizeof(*order) * len);
+	const void **sorted_keys = malloc(sizeof(*sorted_keys) * len);
+	uint8_t is_sorted = 0;
+
+	if ((order != NULL) && (sorted_keys != NULL)) {
+		for (size_t iter = 0; iter < len; ++iter) {
+			order[iter] = iter;
+		}
+
+		is_sorted = dict_sort_batch(dict, keys, order, len);
+	}
+
+	if (is_sorted == 0) {
+		free(order);
+		free(sorted_keys);
+
+		/* No memory to sort, delete the keys one by one */
+		for (size_t iter = 0; iter < len; ++iter) {
+			dict_delete(dict, keys[iter]);
+		}
+
+		return;
+	}
+
+	for (size_t iter = 0; iter < len; ++iter) {
+		sorted_keys[iter] = keys[order[iter]];
+	}
+
+	dict_put_part(dict, dict_delete_batch_helper(dict, dict_take_part(dict), sorted_keys, len));
+
+	free(order);
+	free(sorted_keys);
+}
+
+/**
+ * @brief Definition of the header of a dictionary snapshot file. The
+ * numbers are stored in the byte order of the machine that saved them.
+ * 
+ */
+typedef struct dict_snapshot_header_s {
+	char magic[8];							/* DICT_SNAPSHOT_MAGIC */
+	uint32_t version;						/* DICT_SNAPSHOT_VERSION */
+	uint32_t flags;							/* 1 if the dictionary used value vectors */
+	uint64_t entries;						/* Number of entries, duplicates included */
+	uint64_t keys;							/* Number of distinct keys */
+	uint64_t payload_len;					/* Number of bytes after the header */
+	uint64_t checksum;						/* Checksum of the bytes after the header */
+} dict_snapshot_header_t;
+
+/**
+ * @brief Definition of the running checksum of a snapshot. Four lanes
+ * mix the 8-byte words one after the other, so the lanes do not wait
+ * for each other.
+ * 
+ */
+typedef struct dict_checksum_s {
+	uint64_t lanes[4];						/* Running value of every lane */
+	size_t words;							/* Number of words mixed so far */
+} dict_checksum_t;
+
+/**
+ * @brief Function to start a checksum
+ * 
+ * @param checksum pointer to the checksum to start
+ */
+static void dict_checksum_init(dict_checksum_t *checksum) {
+	checksum->lanes[0] = 0x243F6A8885A308D3ULL;
+	checksum->lanes[1] = 0x13198A2E03707344ULL;
+	checksum->lanes[2] = 0xA4093822299F31D0ULL;
+	checksum->lanes[3] = 0x082EFA98EC4E6C89ULL;
+	checksum->words = 0;
+}
+
+/**
+ * @brief Function to mix whole words in a checksum
+ * 
+ * @param checksum pointer to a started checksum
+ * @param data pointer to the words
+ * @param len number of bytes, a multiple of 8
+ */
+static void dict_checksum_update(dict_checksum_t *checksum, const void *data, size_t len) {
+	const uint8_t *bytes = data;
+
+	for (size_t iter = 0; iter + sizeof(uint64_t) <= len; iter += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, bytes + iter, sizeof(word));
+
+		uint64_t *lane = &checksum->lanes[checksum->words & 3];
+
+		*lane = (*lane ^ word) * 0x9E3779B97F4A7C15ULL;
+		*lane ^= *lane >> 29;
+
+		++(checksum->words);
+	}
+}
+
+/**
+ * @brief Function to give the final value of a checksum
+ * 
+ * @param checksum pointer to a started checksum
+ * @return uint64_t the checksum of all the words
+ */
+static uint64_t dict_checksum_final(const dict_checksum_t *checksum) {
+	uint64_t result = checksum->words;
+
+	for (size_t iter = 0; iter < 4; ++iter) {
+		result = (result ^ checksum->lanes[iter]) * 0xFF51AFD7ED558CCDULL;
+		result ^= result >> 33;
+	}
+
+	return result;
+}
+
+/**
+ * @brief Definition of the writer state of dict_save
+ * 
+ */
+typedef struct dict_snapshot_writer_s {
+	FILE *fout;								/* Snapshot file */
+	dict_checksum_t checksum;				/* Checksum of the payload written so far */
+	uint64_t payload_len;					/* Number of payload bytes written so far */
+	uint8_t *record;						/* Growable buffer for one object */
+	size_t record_capacity;					/* Number of bytes the buffer can hold */
+	inline_func save;						/* Function to copy the next object in the buffer */
+	uint8_t is_failed;						/* 1 after the first error */
+} dict_snapshot_writer_t;
+
+/**
+ * @brief Function to write words to the snapshot and to the checksum
+ * 
+ * @param writer pointer to the writer state
+ * @param data pointer to the words
+ * @param len number of bytes, a multiple of 8
+ */
+static void dict_snapshot_write(dict_snapshot_writer_t *writer, const void *data, size_t len) {
+	if ((writer->is_failed != 0) || (fwrite(data, 1, len, writer->fout) != len)) {
+		writer->is_failed = 1;
+		return;
+	}
+
+	dict_checksum_update(&writer->checksum, data, len);
+	writer->payload_len += len;
+}
+
+/**
+ * @brief Function to write one object as its length followed by its
+ * bytes, padded with zeros to a multiple of 8 bytes
+ * 
+ * @param obj pointer to the object, passed as value_visit_func
+ * @param data pointer to the writer state, the object is copied with its "save" function
+ */
+static void dict_snapshot_write_object(void *obj, void *data) {
+	dict_snapshot_writer_t *writer = data;
+
+	if (writer->is_failed != 0) {
+		return;
+	}
+
+	/* Ask again with a larger buffer until the object fits */
+	size_t obj_len = writer->save(writer->record + sizeof(uint64_t), writer->record_capacity - sizeof(uint64_t), obj);
+
+	while (obj_len > writer->record_capacity - sizeof(uint64_t)) {
+		size_t new_capacity = writer->record_capacity * 2;
+
+		while (obj_len + 2 * sizeof(uint64_t) > new_capacity) {
+			new_capacity *= 2;
+		}
+
+		uint8_t *new_record = realloc(writer->record, new_capacity);
+
+		if (new_record == NULL) {
+			writer->is_failed = 1;
+			return;
+		}
+
+		writer->record = new_record;
+		writer->record_capacity = new_capacity;
+
+		obj_len = writer->save(writer->record + sizeof(uint64_t), writer->record_capacity - sizeof(uint64_t), obj);
+	}
+
+	uint64_t len_word = obj_len;
+	size_t padded_len = (obj_len + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+
+	memcpy(writer->record, &len_word, sizeof(len_word));
+	memset(writer->record + sizeof(uint64_t) + obj_len, 0, padded_len - obj_len);
+
+	dict_snapshot_write(writer, writer->record, sizeof(uint64_t) + padded_len);
+}
+
+/**
+ * @brief Function to save a dictionary in a binary snapshot file. The keys
+ * are written in order, every key with the number of its entries and its
+ * values in insertion order. Each object is stored as the bytes given by
+ * its save function, those bytes are passed to create_key and create_value
+ * by dict_load, so they have to be a valid input for them.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param filename name of the snapshot file
+ * @param save_key Function to copy a key object in a buffer
+ * @param save_value Function to copy a value object in a buffer
+ * @return uint8_t 1 if the snapshot was written, 0 otherwise
+ */
+uint8_t dict_save(dict_t *dict, const char * const filename, inline_func save_key, inline_func save_value) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (filename == NULL) || (save_key == NULL) || (save_value == NULL)) {
+		return 0;
+	}
+
+	FILE *fout = fopen(filename, "wb");
+
+	if (fout == NULL) {
+		return 0;
+	}
+
+	dict_snapshot_header_t header;
+	memset(&header, 0, sizeof(header));
+
+	memcpy(header.magic, DICT_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = DICT_SNAPSHOT_VERSION;
+	header.flags = dict->value_vectors;
+	header.entries = dict->size;
+
+	dict_snapshot_writer_t writer = {fout, {{0}, 0}, 0, malloc(DICT_SNAPSHOT_RECORD_LEN), DICT_SNAPSHOT_RECORD_LEN, NULL, 0};
+
+	dict_checksum_init(&writer.checksum);
+
+	/* The header is written again at the end, with the checksum */
+	if ((writer.record == NULL) || (fwrite(&header, sizeof(header), 1, fout) != 1)) {
+		writer.is_failed = 1;
+	}
+
+	dict_node_t *head = (dict->root != NULL) ? dict_minimum(dict->root) : NULL;
+
+	while ((head != NULL) && (writer.is_failed == 0)) {
+		writer.save = save_key;
+		dict_snapshot_write_object(head->key, &writer);
+
+		uint64_t count = head->count;
+		dict_snapshot_write(&writer, &count, sizeof(count));
+
+		writer.save = save_value;
+		dict_foreach_value(head, dict_snapshot_write_object, &writer);
+
+		++(header.keys);
+		head = head->end->next;
+	}
+
+	header.payload_len = writer.payload_len;
+	header.checksum = dict_checksum_final(&writer.checksum);
+
+	if ((writer.is_failed == 0) && ((fseek(fout, 0, SEEK_SET) != 0) || (fwrite(&header, sizeof(header), 1, fout) != 1))) {
+		writer.is_failed = 1;
+	}
+
+	if (fclose(fout) != 0) {
+		writer.is_failed = 1;
+	}
+
+	free(writer.record);
+
+	return (writer.is_failed == 0);
+}
+
+/**
+ * @brief Definition of the reader state of dict_load, it gives the
+ * (key, value) pairs of a checked snapshot to dict_bulk_load_stream
+ * 
+ */
+typedef struct dict_snapshot_reader_s {
+	const uint8_t *iter;					/* Next word of the payload */
+	const uint8_t *end;						/* End of the payload */
+	const void *key;						/* Key of the current run */
+	uint64_t values_left;					/* Number of values left in the current run */
+} dict_snapshot_reader_t;
+
+/**
+ * @brief Function to read one object from the payload
+ * 
+ * @param iter where the object starts, it is moved after the object
+ * @param end end of the payload
+ * @return const void* pointer to the bytes of the object or NULL if it goes past the end
+ */
+static const void* dict_snapshot_read_object(const uint8_t **iter, const uint8_t *end) {
+	uint64_t obj_len;
+
+	if ((size_t)(end - *iter) < sizeof(obj_len)) {
+		return NULL;
+	}
+
+	memcpy(&obj_len, *iter, sizeof(obj_len));
+
+	uint64_t padded_len = (obj_len + sizeof(uint64_t) - 1) & ~(uint64_t)(sizeof(uint64_t) - 1);
+
+	if ((padded_len < obj_len) || (padded_len > (uint64_t)(end - *iter) - sizeof(obj_len))) {
+		return NULL;
+	}
+
+	const void *obj = *iter + sizeof(obj_len);
+	*iter += sizeof(obj_len) + padded_len;
+
+	return obj;
+}
+
+/**
+ * @brief Function to read the start of a key run, the key and the number of values
+ * 
+ * @param reader pointer to the reader state
+ * @return uint8_t 1 if a run was read, 0 at the end or on a broken run
+ */
+static uint8_t dict_snapshot_read_run(dict_snapshot_reader_t *reader) {
+	reader->key = dict_snapshot_read_object(&reader->iter, reader->end);
+
+	if ((reader->key == NULL) || ((size_t)(reader->end - reader->iter) < sizeof(reader->values_left))) {
+		return 0;
+	}
+
+	memcpy(&reader->values_left, reader->iter, sizeof(reader->values_left));
+	reader->iter += sizeof(reader->values_left);
+
+	return (reader->values_left != 0);
+}
+
+/**
+ * @brief Function to give the next pair of a snapshot, passed to dict_bulk_load_stream
+ * 
+ * @param stream pointer to a dict_snapshot_reader_t object
+ * @param key where to write the pointer to the key
+ * @param value where to write the pointer to the value
+ * @return uint8_t 1 if a pair was given, 0 at the end of the snapshot
+ */
+static uint8_t dict_snapshot_next(void *stream, const void **key, const void **value) {
+	dict_snapshot_reader_t *reader = stream;
+
+	if ((reader->values_left == 0) && ((reader->iter == reader->end) || (dict_snapshot_read_run(reader) == 0))) {
+		return 0;
+	}
+
+	*value = dict_snapshot_read_object(&reader->iter, reader->end);
+
+	if (*value == NULL) {
+		return 0;
+	}
+
+	*key = reader->key;
+	--(reader->values_left);
+
+	return 1;
+}
+
+/**
+ * @brief Function to check the runs of a payload before the load,
+ * every object has to be inside the payload
+ * 
+ * @param payload pointer to the payload
+ * @param header pointer to the header of the snapshot
+ * @return uint8_t 1 if the runs match the header, 0 otherwise
+ */
+static uint8_t dict_snapshot_check_runs(const uint8_t *payload, const dict_snapshot_header_t *header) {
+	dict_snapshot_reader_t reader = {payload, payload + header->payload_len, NULL, 0};
+
+	uint64_t keys = 0, entries = 0;
+
+	while (reader.iter != reader.end) {
+		if (dict_snapshot_read_run(&reader) == 0) {
+			return 0;
+		}
+
+		++keys;
+		entries += reader.values_left;
+
+		for (; reader.values_left != 0; --reader.values_left) {
+			if (dict_snapshot_read_object(&reader.iter, reader.end) == NULL) {
+				return 0;
+			}
+		}
+	}
+
+	return (keys == header->keys) && (entries == header->entries);
+}
+
+/**
+ * @brief Function to load an empty dictionary from a snapshot written by
+ * dict_save. The file is mapped in memory, the header, the checksum and
+ * the runs are checked and the entries are linked in order by
+ * dict_bulk_load_stream, without a search for every entry.
+ * 
+ * @param dict pointer to an allocated and empty dictionary object,
+ * with the same create functions and key order as the saved one
+ * @param filename name of the snapshot file
+ * @return uint8_t 1 if the snapshot was loaded, 0 if it is missing, broken or from another version
+ */
+uint8_t dict_load(dict_t *dict, const char * const filename) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (filename == NULL) || (dict->root != NULL)) {
+		return 0;
+	}
+
+	int fd = open(filename, O_RDONLY);
+
+	if (fd < 0) {
+		return 0;
+	}
+
+	struct stat file_stat;
+	dict_snapshot_header_t header;
+
+	if ((fstat(fd, &file_stat) != 0) || ((size_t)file_stat.st_size < sizeof(header))) {
+		close(fd);
+		return 0;
+	}
+
+	size_t file_len = (size_t)file_stat.st_size;
+	uint8_t *file = mmap(NULL, file_len, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	close(fd);
+
+	if (file == MAP_FAILED) {
+		return 0;
+	}
+
+	madvise(file, file_len, MADV_SEQUENTIAL);
+	memcpy(&header, file, sizeof(header));
+
+	uint8_t is_valid = (memcmp(header.magic, DICT_SNAPSHOT_MAGIC, sizeof(header.magic)) == 0) &&
+					   (header.version == DICT_SNAPSHOT_VERSION) &&
+					   (header.payload_len == file_len - sizeof(header));
+
+	const uint8_t *payload = file + sizeof(header);
+
+	if (is_valid != 0) {
+		dict_checksum_t checksum;
+
+		dict_checksum_init(&checksum);
+		dict_checksum_update(&checksum, payload, header.payload_len);
+
+		is_valid = (header.payload_len % sizeof(uint64_t) == 0) && (dict_checksum_final(&checksum) == header.checksum) &&
+				   (dict_snapshot_check_runs(payload, &header) != 0);
+	}
+
+	if (is_valid != 0) {
+		dict_snapshot_reader_t reader = {payload, payload + header.payload_len, NULL, 0};
+
+		dict_bulk_load_stream(dict, dict_snapshot_next, &reader);
+	}
+
+	munmap(file, file_len);
+
+	return is_valid;
+}
@@ -0,0 +1,605 @@
+#include <time.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "include/sharded_dict.h"
+#include "include/word_scanner.h"
+#include "include/cipher_kernels.h"
+#include "include/frozen_dict.h"
+#include "include/btree_dict.h"
+
+#define BENCH_KEYS (1 << 16)
+#define BENCH_OPS 200000
+#define BENCH_MAX_THREADS 8
+#define BENCH_SHARDS 8
+#define BENCH_TEXT_LEN (64 << 20)
+#define BENCH_SLICES_LEN 256
+#define BENCH_LOOKUPS 1000000
+
+/**
+ * @brief Definition of the arguments of one benchmark thread
+ * 
+ */
+typedef struct bench_args_s {
+	concurrent_dict_t *cdict;				/* Dictionary shared by the threads */
+	sharded_dict_t *sdict;					/* Sharded dictionary shared by the threads, NULL if not used */
+	pthread_mutex_t *mutex;					/* External mutex, NULL to use the dictionary lock */
+	uint64_t seed;							/* Seed of the key generator */
+	size_t ops;								/* Number of operations */
+	uint32_t read_percent;					/* Percent of the operations that only search */
+} bench_args_t;
+
+void* create_long(const void *value) {
+	long *l = malloc(sizeof(*l));
+	*l = *(long *)value;
+	return l;
+}
+
+void destroy_long(void *value) {
+	free(value);
+}
+
+int32_t compare_long(const void *a, const void *b) {
+	if(*(long*)a < *(long*)b) return -1;
+	if(*(long*)a > *(long*)b) return  1;
+	return 0;
+}
+
+static uint64_t bench_next(uint64_t *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+static double bench_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void* bench_worker(void *data) {
+	bench_args_t *args = data;
+	uint64_t state = args->seed;
+
+	for (size_t i = 0; i < args->ops; ++i) {
+		uint64_t rnd = bench_next(&state);
+		long key = (long)(rnd % BENCH_KEYS);
+		uint8_t is_read = ((rnd >> 32) % 100) < args->read_percent;
+
+		if (args->mutex != NULL) {
+
+			/* Every call is serialized, like the callers do today */
+			pthread_mutex_lock(args->mutex);
+
+			if (is_read) {
+				dict_search(args->cdict->dict, args->cdict->dict->root, &key);
+			} else if (rnd & (1ULL << 63)) {
+				dict_insert(args->cdict->dict, &key, &key);
+			} else {
+				dict_delete(args->cdict->dict, &key);
+			}
+
+			pthread_mutex_unlock(args->mutex);
+		} else {
+			if (is_read) {
+				concurrent_dict_search(args->cdict, &key, NULL, NULL);
+			} else if (rnd & (1ULL << 63)) {
+				concurrent_dict_insert(args->cdict, &key, &key);
+			} else {
+				concurrent_dict_delete(args->cdict, &key);
+			}
+		}
+	}
+
+	return NULL;
+}
+
+void* bench_insert_worker(void *data) {
+	bench_args_t *args = data;
+	uint64_t state = args->seed;
+
+	for (size_t i = 0; i < args->ops; ++i) {
+		long key = (long)(bench_next(&state) % BENCH_KEYS);
+
+		if (args->sdict != NULL) {
+			sharded_dict_insert(args->sdict, &key, &key);
+		} else {
+			concurrent_dict_insert(args->cdict, &key, &key);
+		}
+	}
+
+	return NULL;
+}
+
+static double bench_run_inserts(size_t threads, size_t ops, uint8_t use_shards) {
+	concurrent_dict_t *cdict = NULL;
+	sharded_dict_t *sdict = NULL;
+
+	if (use_shards) {
+		long splits[BENCH_SHARDS - 1];
+		const void *split_keys[BENCH_SHARDS - 1];
+
+		/* Equal key ranges for the shards */
+		for (size_t i = 0; i < BENCH_SHARDS - 1; ++i) {
+			splits[i] = (long)((i + 1) * (BENCH_KEYS / BENCH_SHARDS));
+			split_keys[i] = splits + i;
+		}
+
+		sdict = create_sharded_dict(create_long, destroy_long, create_long, destroy_long, compare_long, split_keys, BENCH_SHARDS - 1);
+	} else {
+		cdict = create_concurrent_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	}
+
+	pthread_t tids[BENCH_MAX_THREADS];
+	bench_args_t args[BENCH_MAX_THREADS];
+
+	double start = bench_now();
+
+	for (size_t i = 0; i < threads; ++i) {
+		args[i] = (bench_args_t){cdict, sdict, NULL, 0x9E3779B97F4A7C15ULL * (i + 1), ops, 0};
+		pthread_create(&tids[i], NULL, bench_insert_worker, &args[i]);
+	}
+
+	for (size_t i = 0; i < threads; ++i) {
+		pthread_join(tids[i], NULL);
+	}
+
+	double elapsed = bench_now() - start;
+
+	destroy_concurrent_dict(cdict);
+	destroy_sharded_dict(sdict);
+
+	return (threads * ops) / elapsed / 1e6;
+}
+
+/**
+ * @brief Function to time the insert and the delete of one batch of
+ * random keys in a dictionary with BENCH_KEYS keys, with single calls
+ * or with the batch functions
+ * 
+ * @param batch_len number of keys in the batch
+ * @param use_batch 1 to use dict_insert_batch and dict_delete_batch
+ * @param insert_rate where to write the inserted keys per second, in millions
+ * @param delete_rate where to write the deleted keys per second, in millions
+ */
+static void bench_run_batch(size_t batch_len, uint8_t use_batch, double *insert_rate, double *delete_rate) {
+	dict_t *dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	uint64_t state = 0x2545F4914F6CDD1DULL;
+
+	for (long key = 0; key < BENCH_KEYS; ++key) {
+		long spread = key * 4;
+		dict_insert(dict, &spread, &spread);
+	}
+
+	long *keys = malloc(sizeof(*keys) * batch_len);
+	const void **key_ptrs = malloc(sizeof(*key_ptrs) * batch_len);
+
+	for (size_t i = 0; i < batch_len; ++i) {
+		keys[i] = (long)(bench_next(&state) % (4 * BENCH_KEYS));
+		key_ptrs[i] = keys + i;
+	}
+
+	double start = bench_now();
+
+	if (use_batch) {
+		dict_insert_batch(dict, key_ptrs, key_ptrs, batch_len);
+	} else {
+		for (size_t i = 0; i < batch_len; ++i) {
+			dict_insert(dict, keys + i, keys + i);
+		}
+	}
+
+	double middle = bench_now();
+
+	if (use_batch) {
+		dict_delete_batch(dict, key_ptrs, batch_len);
+	} else {
+		for (size_t i = 0; i < batch_len; ++i) {
+			dict_delete(dict, keys + i);
+		}
+	}
+
+	double end = bench_now();
+
+	*insert_rate = batch_len / (middle - start) / 1e6;
+	*delete_rate = batch_len / (end - middle) / 1e6;
+
+	free(keys);
+	free(key_ptrs);
+	destroy_dict(dict);
+}
+
+/**
+ * @brief Function to time the word scanner on a random text
+ * 
+ * @param text pointer to the text
+ * @param len number of characters in the text
+ * @param words where to write the number of words found
+ * @return double the characters scanned per second, in GB
+ */
+static double bench_run_scan(const char *text, size_t len, size_t *words) {
+	word_slice_t slices[BENCH_SLICES_LEN];
+	size_t pos = 0;
+
+	*words = 0;
+
+	double start = bench_now();
+
+	while (pos < len) {
+		*words += word_scan(text, len, &pos, slices, BENCH_SLICES_LEN);
+	}
+
+	return len / (bench_now() - start) / 1e9;
+}
+
+/**
+ * @brief Function to time the encrypt kernel on a text of letters,
+ * spaces and new lines
+ * 
+ * @param text pointer to the text, it is encrypted in place
+ * @param len number of characters in the text
+ * @return double the characters encrypted per second, in GB
+ */
+static double bench_run_cipher(char *text, size_t len) {
+	int32_t index[] = {3, 25, 0, 14, 7, 19, 11, 2, 8, 23, 5};
+	cipher_key_t *prepared = create_cipher_key(index, sizeof(index) / sizeof(*index));
+	cipher_stream_t stream = {prepared, 0};
+
+	double start = bench_now();
+
+	cipher_encrypt_block(&stream, text, len);
+
+	double end = bench_now();
+
+	destroy_cipher_key(prepared);
+
+	return len / (end - start) / 1e9;
+}
+
+/**
+ * @brief Function to save a long object in a snapshot
+ * 
+ * @param dest where to copy the object
+ * @param dest_len number of bytes available in "dest"
+ * @param value pointer to the long object
+ * @return size_t number of bytes of the object
+ */
+static size_t bench_save_long(void *dest, size_t dest_len, const void *value) {
+	if (sizeof(long) <= dest_len) {
+		memcpy(dest, value, sizeof(long));
+	}
+
+	return sizeof(long);
+}
+
+/**
+ * @brief Function to time a dictionary snapshot against the inserts that
+ * build the same dictionary and against one read of the snapshot file
+ * 
+ * @param entries number of entries, every key has 4 of them
+ * @param rates where to write the inserted, saved, loaded and read entries per second, in millions
+ */
+static void bench_run_snapshot(size_t entries, double rates[4]) {
+	const char *filename = "bench_snapshot.bin";
+	dict_t *dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	uint64_t state = 0xD1B54A32D192ED03ULL;
+
+	double start = bench_now();
+
+	for (size_t i = 0; i < entries; ++i) {
+		long key = (long)(bench_next(&state) % (entries / 4));
+		dict_insert(dict, &key, &key);
+	}
+
+	double middle = bench_now();
+
+	dict_save(dict, filename, bench_save_long, bench_save_long);
+
+	double end = bench_now();
+
+	rates[0] = entries / (middle - start) / 1e6;
+	rates[1] = entries / (end - middle) / 1e6;
+
+	destroy_dict(dict);
+
+	dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+
+	start = bench_now();
+	dict_load(dict, filename);
+	rates[2] = entries / (bench_now() - start) / 1e6;
+
+	destroy_dict(dict);
+
+	/* The same bytes with one read, without building anything */
+	int fd = open(filename, O_RDONLY);
+	struct stat file_stat;
+
+	fstat(fd, &file_stat);
+
+	char *buffer = malloc(file_stat.st_size);
+
+	start = bench_now();
+
+	ssize_t done = read(fd, buffer, file_stat.st_size);
+
+	rates[3] = ((done == file_stat.st_size) ? entries : 0) / (bench_now() - start) / 1e6;
+
+	free(buffer);
+	close(fd);
+	unlink(filename);
+}
+
+/**
+ * @brief Function to time random searches in a dictionary and in its
+ * frozen copy, half of the searched keys are missing
+ * 
+ * @param len number of keys, a power of two
+ * @param latency where to write the time of one dict_search and one frozen_dict_search, in ns
+ */
+static void bench_run_frozen(size_t len, double latency[2]) {
+	dict_t *dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+
+	/* An odd step visits every key once, in a scattered order */
+	for (size_t i = 0; i < len; ++i) {
+		long key = 2 * (long)((i * 0x9E3779B1u) & (len - 1));
+		dict_insert(dict, &key, &key);
+	}
+
+	frozen_dict_t *frozen = dict_freeze(dict, sizeof(long), bench_save_long, sizeof(long), bench_save_long);
+	long *keys = malloc(sizeof(*keys) * BENCH_LOOKUPS);
+	uint64_t state = 0xBF58476D1CE4E5B9ULL;
+
+	for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+		keys[i] = (long)(bench_next(&state) % (2 * len));
+	}
+
+	size_t found = 0;
+	double start = bench_now();
+
+	for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+		found += (dict_search(dict, dict->root, keys + i) != NULL);
+	}
+
+	double middle = bench_now();
+
+	for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+		found -= (frozen_dict_search(frozen, keys + i) != FROZEN_NIL);
+	}
+
+	double end = bench_now();
+
+	/* Both have to find the same keys */
+	latency[0] = (found == 0) ? (middle - start) / BENCH_LOOKUPS * 1e9 : 0;
+	latency[1] = (found == 0) ? (end - middle) / BENCH_LOOKUPS * 1e9 : 0;
+
+	free(keys);
+	destroy_frozen_dict(frozen);
+	destroy_dict(dict);
+}
+
+/**
+ * @brief Function to time the inserts and random searches of the AVL
+ * dictionary and of the B+ tree dictionary, half of the searched keys are missing
+ * 
+ * @param len number of keys, a power of two
+ * @param latency where to write the time of one insert and one search for the AVL
+ * dictionary, then for the B+ tree dictionary, in ns
+ */
+static void bench_run_btree(size_t len, double latency[4]) {
+	dict_t *dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	btree_dict_t *btree = create_btree_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	long *keys = malloc(sizeof(*keys) * BENCH_LOOKUPS);
+	uint64_t state = 0x94D049BB133111EBULL;
+
+	double start = bench_now();
+
+	/* An odd step visits every key once, in a scattered order */
+	for (size_t i = 0; i < len; ++i) {
+		long key = 2 * (long)((i * 0x9E3779B1u) & (len - 1));
+		dict_insert(dict, &key, &key);
+	}
+
+	double middle = bench_now();
+
+	for (size_t i = 0; i < len; ++i) {
+		long key = 2 * (long)((i * 0x9E3779B1u) & (len - 1));
+		btree_dict_insert(btree, &key, &key);
+	}
+
+	double end = bench_now();
+
+	latency[0] = (middle - start) / len * 1e9;
+	latency[2] = (end - middle) / len * 1e9;
+
+	for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+		keys[i] = (long)(bench_next(&state) % (2 * len));
+	}
+
+	size_t found = 0;
+
+	start = bench_now();
+
+	for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+		found += (dict_search(dict, dict->root, keys + i) != NULL);
+	}
+
+	middle = bench_now();
+
+	for (size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+		found -= (btree_dict_search(btree, keys + i).leaf != NULL);
+	}
+
+	end = bench_now();
+
+	/* Both have to find the same keys */
+	latency[1] = (found == 0) ? (middle - start) / BENCH_LOOKUPS * 1e9 : 0;
+	latency[3] = (found == 0) ? (end - middle) / BENCH_LOOKUPS * 1e9 : 0;
+
+	free(keys);
+	destroy_btree_dict(btree);
+	destroy_dict(dict);
+}
+
+static double bench_run(size_t threads, uint32_t read_percent, size_t ops, uint8_t use_mutex) {
+	concurrent_dict_t *cdict = create_concurrent_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+	/* Half of the keys are there from the start */
+	for (long key = 0; key < BENCH_KEYS; key += 2) {
+		concurrent_dict_insert(cdict, &key, &key);
+	}
+
+	pthread_t tids[BENCH_MAX_THREADS];
+	bench_args_t args[BENCH_MAX_THREADS];
+
+	double start = bench_now();
+
+	for (size_t i = 0; i < threads; ++i) {
+		args[i] = (bench_args_t){cdict, NULL, use_mutex ? &mutex : NULL, 0x9E3779B97F4A7C15ULL * (i + 1), ops, read_percent};
+		pthread_create(&tids[i], NULL, bench_worker, &args[i]);
+	}
+
+	for (size_t i = 0; i < threads; ++i) {
+		pthread_join(tids[i], NULL);
+	}
+
+	double elapsed = bench_now() - start;
+
+	destroy_concurrent_dict(cdict);
+
+	return (threads * ops) / elapsed / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+	size_t max_threads = (argc > 1) ? strtoul(argv[1], NULL, 10) : BENCH_MAX_THREADS;
+	size_t ops = (argc > 2) ? strtoul(argv[2], NULL, 10) : BENCH_OPS;
+	uint32_t read_percents[] = {100, 95, 50};
+
+	if ((max_threads == 0) || (max_threads > BENCH_MAX_THREADS)) {
+		max_threads = BENCH_MAX_THREADS;
+	}
+
+	printf("%7s  %-8s %14s %14s\n", "reads", "threads", "mutex Mops/s", "rwlock Mops/s");
+
+	for (size_t r = 0; r < sizeof(read_percents) / sizeof(*read_percents); ++r) {
+		for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+			double mutex_rate = bench_run(threads, read_percents[r], ops, 1);
+			double rwlock_rate = bench_run(threads, read_percents[r], ops, 0);
+
+			printf("%6u%%  %-8zu %14.2f %14.2f\n", read_percents[r], threads, mutex_rate, rwlock_rate);
+		}
+	}
+
+	printf("\n%7s  %-8s %14s %14s\n", "inserts", "threads", "single Mops/s", "sharded Mops/s");
+
+	for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+		double single_rate = bench_run_inserts(threads, ops, 0);
+		double sharded_rate = bench_run_inserts(threads, ops, 1);
+
+		printf("%7s  %-8zu %14.2f %14.2f\n", "", threads, single_rate, sharded_rate);
+	}
+
+	printf("\n%7s  %14s %14s %14s %14s\n", "batch", "insert Mkeys/s", "batch Mkeys/s", "delete Mkeys/s", "batch Mkeys/s");
+
+	for (size_t batch_len = 1000; batch_len <= 100000; batch_len *= 10) {
+		double insert_rate, delete_rate, insert_batch_rate, delete_batch_rate;
+
+		bench_run_batch(batch_len, 0, &insert_rate, &delete_rate);
+		bench_run_batch(batch_len, 1, &insert_batch_rate, &delete_batch_rate);
+
+		printf("%7zu  %14.2f %14.2f %14.2f %14.2f\n", batch_len, insert_rate, insert_batch_rate, delete_rate, delete_batch_rate);
+	}
+
+	printf("\n%7s  %14s %14s %14s %14s\n", "snapshot", "insert Ment/s", "save Ment/s", "load Ment/s", "read Ment/s");
+
+	for (size_t entries = 1 << 16; entries <= (1 << 20); entries <<= 2) {
+		double rates[4];
+
+		bench_run_snapshot(entries, rates);
+
+		printf("%8zu %14.2f %14.2f %14.2f %14.2f\n", entries, rates[0], rates[1], rates[2], rates[3]);
+	}
+
+	printf("\n%8s %14s %14s\n", "frozen", "search ns", "frozen ns");
+
+	for (size_t len = 1 << 12; len <= (1 << 22); len <<= 2) {
+		double latency[2];
+
+		bench_run_frozen(len, latency);
+
+		printf("%8zu %14.1f %14.1f\n", len, latency[0], latency[1]);
+	}
+
+	printf("\n%8s %14s %14s %14s %14s\n", "btree", "avl insert ns", "avl search ns", "btree insert ns", "btree search ns");
+
+	for (size_t len = 1 << 12; len <= (1 << 22); len <<= 2) {
+		double latency[4];
+
+		bench_run_btree(len, latency);
+
+		printf("%8zu %14.1f %14.1f %14.1f %14.1f\n", len, latency[0], latency[1], latency[2], latency[3]);
+	}
+
+	/* Words of 1 to 12 letters, like a text file */
+	char *text = malloc(BENCH_TEXT_LEN);
+	const char separators[] = ",.? \n\r";
+	uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+	for (size_t pos = 0; pos < BENCH_TEXT_LEN; ) {
+		uint64_t rnd = bench_next(&state);
+		size_t word_len = 1 + rnd % 12;
+
+		for (size_t letter = 0; (letter < word_len) && (pos < BENCH_TEXT_LEN); ++letter) {
+			text[pos++] = 'A' + (char)((rnd >> (8 + letter * 4)) % 26);
+		}
+
+		if (pos < BENCH_TEXT_LEN) {
+			text[pos++] = separators[(rnd >> 60) % 6];
+		}
+	}
+
+	const char *level_names[] = {"scalar", "sse2", "avx2"};
+	uint8_t default_level = word_scan_level();
+
+	printf("\n%7s  %14s %14s\n", "scanner", "GB/s", "words");
+
+	for (uint8_t level = WORD_SCAN_SCALAR; level <= WORD_SCAN_AVX2; ++level) {
+		if (word_scan_set_level(level) == 0) {
+			continue;
+		}
+
+		size_t words = 0;
+		double rate = bench_run_scan(text, BENCH_TEXT_LEN, &words);
+
+		printf("%7s  %14.2f %14zu\n", level_names[level], rate, words);
+	}
+
+	word_scan_set_level(default_level);
+
+	/* Only spaces and new lines between the words of the message */
+	for (size_t pos = 0; pos < BENCH_TEXT_LEN; ++pos) {
+		if ((text[pos] < 'A') || (text[pos] > 'Z')) {
+			text[pos] = (text[pos] == '\n') ? '\n' : ' ';
+		}
+	}
+
+	const char *kernel_names[] = {"scalar", "ssse3", "avx2"};
+	uint8_t default_kernel = cipher_kernel_level();
+
+	printf("\n%7s  %14s\n", "cipher", "GB/s");
+
+	for (uint8_t level = CIPHER_KERNEL_SCALAR; level <= CIPHER_KERNEL_AVX2; ++level) {
+		if (cipher_kernel_set_level(level) == 0) {
+			continue;
+		}
+
+		printf("%7s  %14.2f\n", kernel_names[level], bench_run_cipher(text, BENCH_TEXT_LEN));
+	}
+
+	cipher_kernel_set_level(default_kernel);
+	free(text);
+
+	return 0;
+}
@@ -1,5 +1,16 @@
 #include "include/avl_dict.h"
 #include "include/cipher.h"
+#include "include/avl_dict_typed.h"
+#include "include/compact_dict.h"
+#include "include/sharded_dict.h"
+#include "include/persistent_dict.h"
+#include "include/word_scanner.h"
+#include "include/cipher_kernels.h"
+#include "include/frozen_dict.h"
+#include "include/btree_dict.h"
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #define ASSERT(fout, cond, msg) if (!(cond)) { failed(fout, msg); return; } else passed(fout, msg);
 
@@ -39,6 +50,17 @@ void destroy_str_element(void *elem){
 	free((char *)elem);
 }
 
+size_t inline_str_element(void *dest, size_t dest_len, const void *str){
+	size_t len = strnlen((const char *)str, ELEMENT_DICT_LENGTH) + 1;
+
+	if (len <= dest_len) {
+		memcpy(dest, str, len - 1);
+		((char *)dest)[len - 1] = '\0';
+	}
+
+	return len;
+}
+
 void* create_index_info(const void *index){
 	int32_t *idx = malloc(sizeof(*idx));
 	*idx = *(int*)index;
@@ -58,6 +80,16 @@ int32_t compare_str(const void *str1, const void *str2) {
 	return 0;
 }
 
+#define COMPARE_LONG_INLINE(a, b) (((a) > (b)) - ((a) < (b)))
+#define COMPARE_WORD_INLINE(a, b) strncmp((a).str, (b).str, ELEMENT_DICT_LENGTH)
+
+typedef struct word_key_s {
+	char str[ELEMENT_DICT_LENGTH + 1];
+} word_key_t;
+
+DEFINE_AVL_DICT(long_dict, long, long, COMPARE_LONG_INLINE)
+DEFINE_AVL_DICT(word_dict, word_key_t, int32_t, COMPARE_WORD_INLINE)
+
 void print_dot_aux(dict_node_t *node, FILE *fout, uint8_t type) {
 	if (node->left != NULL) {
 		if (type == 1) {
@@ -547,6 +579,2241 @@ void test_list_delete(dict_t **dict) {
 	fclose(fout);
 }
 
+void* share_element(const void *elem) {
+	return (void *)elem;
+}
+
+void test_arena(void) {
+	FILE *fout = fopen("outputs/output_dict_arena.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	dict_t *dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+
+	ASSERT(fout, dict_set_node_arena(dict, 4, 0) == 1, "dict_arena-01");
+	ASSERT(fout, dict_set_node_arena(dict, 4, 0) == 0, "dict_arena-02");
+
+	for (long i = 0; i < 16; ++i) {
+		dict_insert(dict, &i, &i);
+	}
+
+	ASSERT(fout, dict->size == 16, "dict_arena-03");
+	ASSERT(fout, *((long*)dict->root->key) == 7l, "dict_arena-04");
+
+	long expected = 0;
+	dict_node_t *iter = dict_minimum(dict->root);
+
+	while ((iter != NULL) && (*((long*)iter->key) == expected)) {
+		++expected;
+		iter = iter->next;
+	}
+
+	ASSERT(fout, (iter == NULL) && (expected == 16), "dict_arena-05");
+
+	long value = 15;
+	dict_node_t *freed_node = dict_search(dict, dict->root, &value);
+	dict_delete(dict, &value);
+	ASSERT(fout, dict_search(dict, dict->root, &value) == NULL, "dict_arena-06");
+
+	value = 20;
+	dict_insert(dict, &value, &value);
+	ASSERT(fout, dict_search(dict, dict->root, &value) == freed_node, "dict_arena-07");
+	ASSERT(fout, dict_set_node_arena(dict, 4, 0) == 0, "dict_arena-08");
+
+	destroy_dict(dict);
+
+	/* Inline keys and values without a destructor, the slabs go at once */
+	static const int32_t indexes[] = {0, 1, 2};
+
+	dict = create_dict(create_str_element, destroy_str_element, share_element, NULL, compare_str);
+	dict_set_node_arena(dict, 2, 0);
+	dict_set_inline_keys(dict, 4, inline_str_element);
+
+	dict_insert(dict, "AB", &indexes[0]);
+	dict_insert(dict, "XY", &indexes[1]);
+	ASSERT(fout, (dict->size == 2) && (dict->heap_keys == 0), "dict_arena-09");
+
+	dict_insert(dict, "ABCDEFG", &indexes[2]);
+	ASSERT(fout, dict->heap_keys == 1, "dict_arena-10");
+
+	dict_delete(dict, "ABCDEFG");
+	ASSERT(fout, (dict->size == 2) && (dict->heap_keys == 0), "dict_arena-11");
+	ASSERT(fout, dict_search(dict, dict->root, "XY")->value == (void *)&indexes[1], "dict_arena-12");
+
+	destroy_dict(dict);
+
+	fprintf(fout, "\nAll tests for dict_arena passed!\n");
+	fclose(fout);
+}
+
+void test_inline_keys(void) {
+	FILE *fout = fopen("outputs/output_dict_inline_keys.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	dict_t *dict = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+
+	ASSERT(fout, dict_set_node_arena(dict, 2, 0) == 1, "dict_inline_keys-01");
+	ASSERT(fout, dict_set_inline_keys(dict, 4, inline_str_element) == 1, "dict_inline_keys-02");
+
+	int32_t index = 0;
+	const char *words[] = {"ABC", "ABCDEFG", "XY", "ABC", "Q"};
+
+	for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i, ++index) {
+		dict_insert(dict, words[i], &index);
+	}
+
+	dict_node_t *node = dict_search(dict, dict->root, "ABC");
+	ASSERT(fout, node != NULL, "dict_inline_keys-03");
+	ASSERT(fout, node->key == (void *)node->key_data, "dict_inline_keys-04");
+	ASSERT(fout, node->end->key == (void *)node->end->key_data, "dict_inline_keys-05");
+	ASSERT(fout, *((int32_t *)node->end->value) == 3, "dict_inline_keys-06");
+
+	node = dict_search(dict, dict->root, "ABCDE");
+	ASSERT(fout, node != NULL, "dict_inline_keys-07");
+	ASSERT(fout, node->key != (void *)node->key_data, "dict_inline_keys-08");
+	ASSERT(fout, strcmp((const char *)node->key, "ABCDE") == 0, "dict_inline_keys-09");
+
+	ASSERT(fout, dict_set_inline_keys(dict, 8, inline_str_element) == 0, "dict_inline_keys-10");
+
+	dict_delete(dict, "ABC");
+	dict_delete(dict, "ABC");
+	dict_delete(dict, "XY");
+	ASSERT(fout, dict_search(dict, dict->root, "ABC") == NULL, "dict_inline_keys-11");
+	ASSERT(fout, dict->size == 2, "dict_inline_keys-12");
+
+	destroy_dict(dict);
+
+	/* A node size the arena refuses leaves the old layout */
+	dict = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	dict_set_node_arena(dict, 2, 0);
+
+	ASSERT(fout, dict_set_inline_keys(dict, SIZE_MAX - sizeof(dict_node_t) - 4, inline_str_element) == 0, "dict_inline_keys-13");
+	ASSERT(fout, (dict->inline_key == NULL) && (dict->inline_key_len == 0), "dict_inline_keys-14");
+	ASSERT(fout, dict_set_inline_keys(dict, SIZE_MAX, inline_str_element) == 0, "dict_inline_keys-15");
+	ASSERT(fout, (dict->inline_key == NULL) && (dict->inline_key_len == 0), "dict_inline_keys-16");
+
+	for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i, ++index) {
+		dict_insert(dict, words[i], &index);
+	}
+
+	node = dict_search(dict, dict->root, "ABCDE");
+	ASSERT(fout, (dict->size == 5) && (node != NULL) && (node->key != (void *)node->key_data), "dict_inline_keys-17");
+
+	destroy_dict(dict);
+
+	fprintf(fout, "\nAll tests for dict_inline_keys passed!\n");
+	fclose(fout);
+}
+
+int64_t check_avl_node(dict_node_t *node) {
+	if (node == NULL) {
+		return 0;
+	}
+
+	if ((node->left != NULL) && (node->left->parent != node)) return -1;
+	if ((node->right != NULL) && (node->right->parent != node)) return -1;
+
+	int64_t left_height = check_avl_node(node->left);
+	int64_t right_height = check_avl_node(node->right);
+
+	if ((left_height < 0) || (right_height < 0)) return -1;
+	if ((left_height - right_height > 1) || (right_height - left_height > 1)) return -1;
+	if (node->height != ((left_height >= right_height) ? left_height : right_height) + 1) return -1;
+
+	return node->height;
+}
+
+uint8_t check_dict_list(dict_t *dict) {
+	dict_node_t *iter = dict_minimum(dict->root);
+	dict_node_t *prev = NULL;
+	size_t count = 0;
+
+	while (iter != NULL) {
+		if (iter->prev != prev) return 0;
+		if ((prev != NULL) && (compare_long(prev->key, iter->key) > 0)) return 0;
+
+		prev = iter;
+		iter = iter->next;
+		++count;
+	}
+
+	return (count == dict->size);
+}
+
+void count_value(void *value, void *data) {
+	(void)value;
+	++(*(size_t *)data);
+}
+
+size_t check_subtree_size(dict_node_t *node) {
+	if (node == NULL) {
+		return 0;
+	}
+
+	size_t count = 0;
+
+	dict_foreach_value(node, count_value, &count);
+
+	size_t left_size = check_subtree_size(node->left);
+	size_t right_size = check_subtree_size(node->right);
+
+	if ((left_size == (size_t)-1) || (right_size == (size_t)-1) || (node->count != count)) {
+		return (size_t)-1;
+	}
+
+	if (node->subtree_size != left_size + right_size + count) {
+		return (size_t)-1;
+	}
+
+	return node->subtree_size;
+}
+
+void test_bulk_load(void) {
+	FILE *fout = fopen("outputs/output_dict_bulk_load.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	long keys[] = {0, 1, 2, 3, 3, 3, 4, 5, 6, 7, 8, 9, 9};
+	long values[] = {0, 1, 2, 30, 31, 32, 4, 5, 6, 7, 8, 90, 91};
+	const void *key_ptrs[13], *value_ptrs[13];
+
+	for (size_t i = 0; i < 13; ++i) {
+		key_ptrs[i] = keys + i;
+		value_ptrs[i] = values + i;
+	}
+
+	dict_t *dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+
+	dict_bulk_load(dict, key_ptrs, value_ptrs, 13);
+	ASSERT(fout, dict->size == 13, "dict_bulk_load-01");
+	ASSERT(fout, *((long*)dict->root->key) == 5l, "dict_bulk_load-02");
+	ASSERT(fout, check_avl_node(dict->root) == 4, "dict_bulk_load-03");
+	ASSERT(fout, check_dict_list(dict) == 1, "dict_bulk_load-04");
+
+	long value = 3;
+	dict_node_t *node = dict_search(dict, dict->root, &value);
+	ASSERT(fout, *((long*)node->value) == 30l, "dict_bulk_load-05");
+	ASSERT(fout, *((long*)node->end->value) == 32l, "dict_bulk_load-06");
+	ASSERT(fout, node->end->next == dict_successor(node), "dict_bulk_load-07");
+	ASSERT(fout, dict_maximum(dict->root)->end->next == NULL, "dict_bulk_load-08");
+
+	value = 10;
+	dict_insert(dict, &value, &value);
+	value = 3;
+	dict_delete(dict, &value);
+	value = 5;
+	dict_delete(dict, &value);
+	ASSERT(fout, check_avl_node(dict->root) > 0, "dict_bulk_load-09");
+	ASSERT(fout, check_dict_list(dict) == 1, "dict_bulk_load-10");
+
+	destroy_dict(dict);
+
+	dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+
+	key_ptrs[5] = keys;
+	dict_bulk_load(dict, key_ptrs, value_ptrs, 13);
+	ASSERT(fout, dict->size == 13, "dict_bulk_load-11");
+	ASSERT(fout, check_avl_node(dict->root) > 0, "dict_bulk_load-12");
+	ASSERT(fout, check_dict_list(dict) == 1, "dict_bulk_load-13");
+
+	destroy_dict(dict);
+
+	fprintf(fout, "\nAll tests for dict_bulk_load passed!\n");
+	fclose(fout);
+}
+
+void test_order_stats(void) {
+	FILE *fout = fopen("outputs/output_dict_order_stats.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	dict_t *dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+
+	/* Keys 0, 2, ..., 38 and key 2 * i repeated i % 3 more times */
+	for (long i = 0; i < 20; ++i) {
+		long key = 2 * i;
+
+		for (long j = 0; j <= i % 3; ++j) {
+			dict_insert(dict, &key, &j);
+		}
+	}
+
+	ASSERT(fout, dict->size == 39, "dict_order_stats-01");
+	ASSERT(fout, dict->root->subtree_size == 39, "dict_order_stats-02");
+	ASSERT(fout, dict->root->subtree_keys == 20, "dict_order_stats-03");
+	ASSERT(fout, check_subtree_size(dict->root) == 39, "dict_order_stats-04");
+
+	long value = 6;
+	ASSERT(fout, dict_rank(dict, &value) == 6, "dict_order_stats-05");
+	value = 7;
+	ASSERT(fout, dict_rank(dict, &value) == 7, "dict_order_stats-06");
+	value = -1;
+	ASSERT(fout, dict_rank(dict, &value) == 0, "dict_order_stats-07");
+	value = 100;
+	ASSERT(fout, dict_rank(dict, &value) == 39, "dict_order_stats-08");
+
+	ASSERT(fout, *((long*)dict_select(dict, 0)->key) == 0l, "dict_order_stats-09");
+	ASSERT(fout, *((long*)dict_select(dict, 6)->key) == 6l, "dict_order_stats-10");
+	ASSERT(fout, *((long*)dict_select(dict, 5)->key) == 4l, "dict_order_stats-11");
+	ASSERT(fout, *((long*)dict_select(dict, 38)->key) == 38l, "dict_order_stats-12");
+	ASSERT(fout, dict_select(dict, 39) == NULL, "dict_order_stats-13");
+	ASSERT(fout, *((long*)dict_select_key(dict, 19)->key) == 38l, "dict_order_stats-14");
+	ASSERT(fout, dict_select_key(dict, 20) == NULL, "dict_order_stats-15");
+
+	long left = 3, right = 10;
+	ASSERT(fout, dict_count_range(dict, &left, &right) == 9, "dict_order_stats-16");
+	left = 4;
+	ASSERT(fout, dict_count_range(dict, &left, &right) == 9, "dict_order_stats-17");
+	ASSERT(fout, dict_count_range(dict, &right, &left) == 0, "dict_order_stats-18");
+
+	/* Delete the root, its successor has duplicates */
+	value = *((long*)dict->root->key);
+	dict_delete(dict, &value);
+	ASSERT(fout, check_avl_node(dict->root) > 0, "dict_order_stats-19");
+	ASSERT(fout, check_dict_list(dict) == 1, "dict_order_stats-20");
+	ASSERT(fout, check_subtree_size(dict->root) == 38, "dict_order_stats-21");
+
+	for (long i = 0; i < 40; i += 3) {
+		dict_delete(dict, &i);
+	}
+
+	ASSERT(fout, check_avl_node(dict->root) > 0, "dict_order_stats-22");
+	ASSERT(fout, check_dict_list(dict) == 1, "dict_order_stats-23");
+	ASSERT(fout, check_subtree_size(dict->root) == dict->size, "dict_order_stats-24");
+	ASSERT(fout, *((long*)dict_most_frequent(dict)->key) == 34l, "dict_order_stats-25");
+
+	/* One more 10 makes it the only key with four entries */
+	value = 10;
+	dict_insert(dict, &value, &value);
+	ASSERT(fout, *((long*)dict_most_frequent(dict)->key) == 10l, "dict_order_stats-26");
+
+	destroy_dict(dict);
+
+	fprintf(fout, "\nAll tests for dict_order_stats passed!\n");
+	fclose(fout);
+}
+
+void test_bounds(void) {
+	FILE *fout = fopen("outputs/output_dict_bounds.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	dict_t *dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	long key = 4;
+
+	ASSERT(fout, dict_lower_bound(dict, &key) == NULL, "dict_bounds-01");
+	ASSERT(fout, dict_upper_bound(dict, &key) == NULL, "dict_bounds-02");
+
+	/* Keys 0, 2, ..., 38 and key 2 * i repeated i % 3 more times */
+	for (long i = 0; i < 20; ++i) {
+		long value = 2 * i;
+
+		for (long j = 0; j <= i % 3; ++j) {
+			dict_insert(dict, &value, &j);
+		}
+	}
+
+	ASSERT(fout, *((long*)dict_lower_bound(dict, &key)->key) == 4l, "dict_bounds-03");
+	ASSERT(fout, *((long*)dict_upper_bound(dict, &key)->key) == 6l, "dict_bounds-04");
+	ASSERT(fout, dict_lower_bound(dict, &key) == dict_search(dict, dict->root, &key), "dict_bounds-05");
+	key = 5;
+	ASSERT(fout, *((long*)dict_lower_bound(dict, &key)->key) == 6l, "dict_bounds-06");
+	ASSERT(fout, *((long*)dict_upper_bound(dict, &key)->key) == 6l, "dict_bounds-07");
+	key = 38;
+	ASSERT(fout, *((long*)dict_lower_bound(dict, &key)->key) == 38l, "dict_bounds-08");
+	ASSERT(fout, dict_upper_bound(dict, &key) == NULL, "dict_bounds-09");
+	key = -5;
+	ASSERT(fout, dict_lower_bound(dict, &key) == dict_minimum(dict->root), "dict_bounds-10");
+	ASSERT(fout, dict_upper_bound(dict, &key) == dict_minimum(dict->root), "dict_bounds-11");
+	ASSERT(fout, dict_lower_bound(dict, NULL) == NULL, "dict_bounds-12");
+
+	destroy_dict(dict);
+
+	fprintf(fout, "\nAll tests for dict_bounds passed!\n");
+	fclose(fout);
+}
+
+void test_typed(void) {
+	FILE *fout = fopen("outputs/output_dict_typed.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	long_dict_t *dict = long_dict_create();
+
+	ASSERT(fout, dict != NULL, "dict_typed-01");
+
+	long values[] = {2, 3, 4, 1, 0, 5, 6, 8, 7};
+
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+		long_dict_insert(dict, values[i], 10 * values[i]);
+	}
+
+	ASSERT(fout, dict->size == 9, "dict_typed-02");
+	ASSERT(fout, dict->root->key == 3l, "dict_typed-03");
+	ASSERT(fout, dict->root->right->right->key == 7l, "dict_typed-04");
+	ASSERT(fout, dict->root->right->right->left->key == 6l, "dict_typed-05");
+	ASSERT(fout, long_dict_search(dict, 6)->value == 60l, "dict_typed-06");
+	ASSERT(fout, long_dict_search(dict, 10) == NULL, "dict_typed-07");
+	ASSERT(fout, long_dict_minimum(dict->root)->key == 0l, "dict_typed-08");
+	ASSERT(fout, long_dict_maximum(dict->root)->key == 8l, "dict_typed-09");
+	ASSERT(fout, long_dict_successor(long_dict_search(dict, 4))->key == 5l, "dict_typed-10");
+	ASSERT(fout, long_dict_predecessor(long_dict_search(dict, 6))->key == 5l, "dict_typed-11");
+
+	long_dict_insert(dict, 3, 31);
+	long_dict_insert(dict, 3, 32);
+	long_dict_insert(dict, 8, 81);
+	ASSERT(fout, dict->root->next->value == 31l, "dict_typed-12");
+	ASSERT(fout, dict->root->end->value == 32l, "dict_typed-13");
+	ASSERT(fout, dict->root->end->next == long_dict_successor(dict->root), "dict_typed-14");
+	ASSERT(fout, long_dict_maximum(dict->root)->end->next == NULL, "dict_typed-15");
+
+	long_dict_delete(dict, 3);
+	ASSERT(fout, dict->root->end->value == 31l, "dict_typed-16");
+
+	long_dict_delete(dict, 6);
+	long_dict_delete(dict, 4);
+	long_dict_delete(dict, 3);
+	long_dict_delete(dict, 3);
+	ASSERT(fout, long_dict_search(dict, 3) == NULL, "dict_typed-17");
+	ASSERT(fout, dict->root->key == 5l, "dict_typed-18");
+	ASSERT(fout, dict->size == 7, "dict_typed-19");
+
+	long expected[] = {0, 1, 2, 5, 7, 8, 8};
+	size_t idx = 0;
+
+	for (long_dict_node_t *iter = long_dict_minimum(dict->root); iter != NULL; iter = iter->next, ++idx) {
+		if ((idx == 7) || (iter->key != expected[idx])) {
+			break;
+		}
+	}
+
+	ASSERT(fout, idx == 7, "dict_typed-20");
+
+	long_dict_destroy(dict);
+
+	word_dict_t *words = word_dict_create();
+	word_key_t word = {"GAMMA"};
+
+	word_dict_insert(words, word, 0);
+	strcpy(word.str, "ALPHA");
+	word_dict_insert(words, word, 5);
+	strcpy(word.str, "GAMMA");
+	word_dict_insert(words, word, 10);
+
+	ASSERT(fout, words->size == 3, "dict_typed-21");
+	ASSERT(fout, word_dict_search(words, word)->end->value == 10, "dict_typed-22");
+	ASSERT(fout, strcmp(word_dict_minimum(words->root)->key.str, "ALPHA") == 0, "dict_typed-23");
+
+	word_dict_destroy(words);
+
+	fprintf(fout, "\nAll tests for dict_typed passed!\n");
+	fclose(fout);
+}
+
+void test_compact(void) {
+	FILE *fout = fopen("outputs/output_dict_compact.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	compact_dict_t *dict = create_compact_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+
+	ASSERT(fout, dict != NULL, "dict_compact-01");
+	ASSERT(fout, sizeof(compact_node_t) <= 40, "dict_compact-02");
+
+	/* Enough keys to grow the pool a few times */
+	for (long i = 0; i < 100; ++i) {
+		long key = (i * 37) % 100;
+		compact_dict_insert(dict, &key, &i);
+	}
+
+	long value = 50;
+	compact_dict_insert(dict, &value, &value);
+
+	ASSERT(fout, dict->size == 101, "dict_compact-03");
+	ASSERT(fout, compact_dict_node(dict, dict->root)->height <= 8, "dict_compact-04");
+
+	uint32_t iter = compact_dict_search(dict, &value);
+	ASSERT(fout, iter != COMPACT_NIL, "dict_compact-05");
+	ASSERT(fout, *((long*)compact_dict_node(dict, compact_dict_node(dict, iter)->end)->value) == 50l, "dict_compact-06");
+	ASSERT(fout, *((long*)compact_dict_node(dict, compact_dict_successor(dict, iter))->key) == 51l, "dict_compact-07");
+	ASSERT(fout, *((long*)compact_dict_node(dict, compact_dict_predecessor(dict, compact_dict_successor(dict, iter)))->key) == 50l, "dict_compact-08");
+	ASSERT(fout, *((long*)compact_dict_node(dict, compact_dict_minimum(dict))->key) == 0l, "dict_compact-09");
+	ASSERT(fout, *((long*)compact_dict_node(dict, compact_dict_maximum(dict))->key) == 99l, "dict_compact-10");
+	ASSERT(fout, compact_dict_predecessor(dict, compact_dict_minimum(dict)) == COMPACT_NIL, "dict_compact-11");
+	ASSERT(fout, compact_dict_successor(dict, compact_dict_maximum(dict)) == COMPACT_NIL, "dict_compact-12");
+
+	for (long i = 0; i < 100; i += 2) {
+		compact_dict_delete(dict, &i);
+	}
+
+	ASSERT(fout, dict->size == 51, "dict_compact-13");
+	ASSERT(fout, compact_dict_search(dict, &value) != COMPACT_NIL, "dict_compact-14");
+
+	compact_dict_delete(dict, &value);
+	ASSERT(fout, compact_dict_search(dict, &value) == COMPACT_NIL, "dict_compact-15");
+
+	long expected = 1;
+	iter = compact_dict_minimum(dict);
+
+	while ((iter != COMPACT_NIL) && (*((long*)compact_dict_node(dict, iter)->key) == expected)) {
+		expected += 2;
+		iter = compact_dict_node(dict, iter)->next;
+	}
+
+	ASSERT(fout, (iter == COMPACT_NIL) && (expected == 101), "dict_compact-16");
+
+	destroy_compact_dict(dict);
+
+	fprintf(fout, "\nAll tests for dict_compact passed!\n");
+	fclose(fout);
+}
+
+typedef struct long_values_s {
+	long values[16];
+	size_t size;
+} long_values_t;
+
+void collect_long(void *value, void *data) {
+	long_values_t *values = data;
+
+	if (values->size < 16) {
+		values->values[values->size] = *(long *)value;
+	}
+
+	++(values->size);
+}
+
+uint8_t same_range(range_t *range1, range_t *range2) {
+	uint8_t is_same = (range1 != NULL) && (range2 != NULL) && (range1->size == range2->size) && (range1->size != 0);
+	is_same = is_same && (memcmp(range1->index, range2->index, sizeof(int32_t) * range1->size) == 0);
+
+	if (range1 != NULL) {
+		free(range1->index);
+		free(range1);
+	}
+
+	if (range2 != NULL) {
+		free(range2->index);
+		free(range2);
+	}
+
+	return is_same;
+}
+
+void test_value_vectors(void) {
+	FILE *fout = fopen("outputs/output_dict_value_vectors.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	dict_t *dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+
+	ASSERT(fout, dict_set_value_vectors(dict) == 1, "dict_value_vectors-01");
+
+	/* Keys 0, ..., 9 and key i repeated i more times */
+	for (long i = 0; i < 10; ++i) {
+		for (long j = 0; j <= i; ++j) {
+			long value = 10 * i + j;
+			dict_insert(dict, &i, &value);
+		}
+	}
+
+	ASSERT(fout, dict_set_value_vectors(dict) == 0, "dict_value_vectors-02");
+	ASSERT(fout, dict->size == 55, "dict_value_vectors-03");
+	ASSERT(fout, dict->root->subtree_size == 55, "dict_value_vectors-04");
+	ASSERT(fout, dict->root->subtree_keys == 10, "dict_value_vectors-05");
+	ASSERT(fout, check_avl_node(dict->root) > 0, "dict_value_vectors-06");
+
+	long key = 6;
+	dict_node_t *node = dict_search(dict, dict->root, &key);
+	ASSERT(fout, (node != NULL) && (node->count == 7) && (node->end == node), "dict_value_vectors-07");
+	ASSERT(fout, node->next == dict_successor(node), "dict_value_vectors-08");
+
+	long_values_t values = {.size = 0};
+	dict_foreach_value(node, collect_long, &values);
+	ASSERT(fout, (values.size == 7) && (values.values[0] == 60l) && (values.values[6] == 66l), "dict_value_vectors-09");
+	ASSERT(fout, *((long*)dict_most_frequent(dict)->key) == 9l, "dict_value_vectors-10");
+	ASSERT(fout, dict_rank(dict, &key) == 21, "dict_value_vectors-11");
+
+	/* The last values go first */
+	dict_delete(dict, &key);
+	dict_delete(dict, &key);
+	values.size = 0;
+	dict_foreach_value(node, collect_long, &values);
+	ASSERT(fout, (values.size == 5) && (values.values[4] == 64l), "dict_value_vectors-12");
+	ASSERT(fout, dict->size == 53, "dict_value_vectors-13");
+	ASSERT(fout, dict->root->subtree_size == 53, "dict_value_vectors-14");
+
+	/* Just key 0 has no values left */
+	for (key = 0; key < 10; key += 2) {
+		dict_delete(dict, &key);
+	}
+
+	ASSERT(fout, check_avl_node(dict->root) > 0, "dict_value_vectors-15");
+	ASSERT(fout, dict->root->subtree_keys == 9, "dict_value_vectors-16");
+
+	key = 5;
+	dict_insert(dict, &key, &key);
+	node = dict_search(dict, dict->root, &key);
+	values.size = 0;
+	dict_foreach_value(node, collect_long, &values);
+	ASSERT(fout, (values.size == 7) && (values.values[6] == 5l), "dict_value_vectors-17");
+
+	destroy_dict(dict);
+
+	/* Bulk load keeps the duplicates in the vectors as well */
+	long keys[] = {1, 1, 1, 2, 3, 3};
+	long bulk_values[] = {10, 11, 12, 20, 30, 31};
+	const void *key_ptrs[6], *value_ptrs[6];
+
+	for (size_t i = 0; i < 6; ++i) {
+		key_ptrs[i] = keys + i;
+		value_ptrs[i] = bulk_values + i;
+	}
+
+	dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	dict_set_node_arena(dict, 4, 0);
+	dict_set_value_vectors(dict);
+	dict_bulk_load(dict, key_ptrs, value_ptrs, 6);
+
+	ASSERT(fout, dict->size == 6, "dict_value_vectors-18");
+	ASSERT(fout, dict->root->subtree_keys == 3, "dict_value_vectors-19");
+	ASSERT(fout, check_subtree_size(dict->root) == 6, "dict_value_vectors-20");
+
+	key = 1;
+	node = dict_search(dict, dict->root, &key);
+	values.size = 0;
+	dict_foreach_value(node, collect_long, &values);
+	ASSERT(fout, (values.size == 3) && (values.values[2] == 12l), "dict_value_vectors-21");
+
+	destroy_dict(dict);
+
+	/* The key queries give the same keys as with duplicate lists */
+	dict_t *lists = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	build_dict_from_file("inputs/key.txt", lists);
+
+	dict = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	dict_set_value_vectors(dict);
+	build_dict_from_file("inputs/key.txt", dict);
+
+	ASSERT(fout, same_range(inorder_key_query(lists), inorder_key_query(dict)) == 1, "dict_value_vectors-22");
+	ASSERT(fout, same_range(level_key_query(lists), level_key_query(dict)) == 1, "dict_value_vectors-23");
+	ASSERT(fout, same_range(range_key_query(lists, "CD", "GG"), range_key_query(dict, "CD", "GG")) == 1, "dict_value_vectors-24");
+
+	destroy_dict(lists);
+	destroy_dict(dict);
+
+	fprintf(fout, "\nAll tests for dict_value_vectors passed!\n");
+	fclose(fout);
+}
+
+dict_t* build_successor_dict(uint8_t value_vectors) {
+	dict_t *dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+
+	if (value_vectors != 0) {
+		dict_set_value_vectors(dict);
+	}
+
+	/* The root 4 has two children and its successor 5 has duplicates */
+	long keys[] = {4, 2, 6, 1, 3, 5, 7};
+
+	for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); ++i) {
+		dict_insert(dict, &keys[i], &keys[i]);
+	}
+
+	long key = 5;
+
+	for (long value = 50; value < 52; ++value) {
+		dict_insert(dict, &key, &value);
+	}
+
+	key = 4;
+	dict_delete(dict, &key);
+
+	return dict;
+}
+
+void test_delete_successor(void) {
+	FILE *fout = fopen("outputs/output_dict_delete_successor.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	long key = 5;
+	long_values_t values = {{0}, 0};
+
+	dict_t *dict = build_successor_dict(0);
+	dict_node_t *node = dict_search(dict, dict->root, &key);
+
+	ASSERT(fout, dict->size == 8, "dict_delete_successor-01");
+	ASSERT(fout, *((long*)dict->root->key) == 5l, "dict_delete_successor-02");
+	ASSERT(fout, (node != NULL) && (node->count == 3), "dict_delete_successor-03");
+
+	dict_foreach_value(node, collect_long, &values);
+	ASSERT(fout, (values.size == 3) && (values.values[0] == 5) && (values.values[1] == 50) && (values.values[2] == 51), "dict_delete_successor-04");
+	ASSERT(fout, check_dict_list(dict) == 1, "dict_delete_successor-05");
+	ASSERT(fout, check_subtree_size(dict->root) == 8, "dict_delete_successor-06");
+
+	key = 4;
+	ASSERT(fout, dict_search(dict, dict->root, &key) == NULL, "dict_delete_successor-07");
+
+	destroy_dict(dict);
+
+	/* Same delete with the duplicates in a value vector */
+	key = 5;
+	values.size = 0;
+
+	dict = build_successor_dict(1);
+	node = dict_search(dict, dict->root, &key);
+
+	ASSERT(fout, dict->size == 8, "dict_delete_successor-08");
+	ASSERT(fout, *((long*)dict->root->key) == 5l, "dict_delete_successor-09");
+	ASSERT(fout, (node != NULL) && (node->count == 3), "dict_delete_successor-10");
+
+	dict_foreach_value(node, collect_long, &values);
+	ASSERT(fout, (values.size == 3) && (values.values[0] == 5) && (values.values[1] == 50) && (values.values[2] == 51), "dict_delete_successor-11");
+	ASSERT(fout, check_subtree_size(dict->root) == 8, "dict_delete_successor-12");
+
+	destroy_dict(dict);
+
+	fprintf(fout, "\nAll tests for dict_delete_successor passed!\n");
+	fclose(fout);
+}
+
+typedef struct concurrent_args_s {
+	concurrent_dict_t *cdict;
+	long first;
+} concurrent_args_t;
+
+void* concurrent_worker(void *data) {
+	concurrent_args_t *args = data;
+
+	for (long key = args->first; key < args->first + 200; ++key) {
+		concurrent_dict_insert(args->cdict, &key, &key);
+
+		/* Readers and writers mixed on the same dictionary */
+		long other = (key * 7) % 800;
+		concurrent_dict_search(args->cdict, &other, NULL, NULL);
+	}
+
+	for (long key = args->first; key < args->first + 200; key += 2) {
+		concurrent_dict_delete(args->cdict, &key);
+	}
+
+	return NULL;
+}
+
+void count_node(dict_node_t *node, void *data) {
+	(void)node;
+	++(*(size_t *)data);
+}
+
+void test_concurrent(void) {
+	FILE *fout = fopen("outputs/output_dict_concurrent.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	concurrent_dict_t *cdict = create_concurrent_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	ASSERT(fout, cdict != NULL, "dict_concurrent-01");
+
+	pthread_t tids[4];
+	concurrent_args_t args[4];
+
+	for (long i = 0; i < 4; ++i) {
+		args[i].cdict = cdict;
+		args[i].first = 200 * i;
+		pthread_create(&tids[i], NULL, concurrent_worker, &args[i]);
+	}
+
+	for (long i = 0; i < 4; ++i) {
+		pthread_join(tids[i], NULL);
+	}
+
+	ASSERT(fout, concurrent_dict_size(cdict) == 400, "dict_concurrent-02");
+
+	dict_t *dict = concurrent_dict_read_begin(cdict);
+	uint8_t is_valid = (check_avl_node(dict->root) > 0) && (check_dict_list(dict) == 1);
+	concurrent_dict_read_end(cdict);
+	ASSERT(fout, is_valid, "dict_concurrent-03");
+
+	long key = 3;
+	ASSERT(fout, concurrent_dict_search(cdict, &key, NULL, NULL) == 1, "dict_concurrent-04");
+	key = 4;
+	ASSERT(fout, concurrent_dict_search(cdict, &key, NULL, NULL) == 0, "dict_concurrent-05");
+
+	long left = 100, right = 299;
+	size_t visited = 0;
+	ASSERT(fout, concurrent_dict_range(cdict, &left, &right, count_node, &visited) == 100, "dict_concurrent-06");
+	ASSERT(fout, visited == 100, "dict_concurrent-07");
+	visited = 0;
+	ASSERT(fout, (concurrent_dict_range(cdict, NULL, NULL, count_node, &visited) == 400) && (visited == 400), "dict_concurrent-08");
+
+	dict = concurrent_dict_write_begin(cdict);
+	dict_insert(dict, &key, &key);
+	dict_insert(dict, &key, &key);
+	concurrent_dict_write_end(cdict);
+	ASSERT(fout, concurrent_dict_size(cdict) == 402, "dict_concurrent-09");
+
+	destroy_concurrent_dict(cdict);
+
+	fprintf(fout, "\nAll tests for dict_concurrent passed!\n");
+	fclose(fout);
+}
+
+typedef struct persistent_check_s {
+	long last;
+	size_t keys;
+	size_t entries;
+	uint8_t is_sorted;
+} persistent_check_t;
+
+void check_persistent_node(persistent_node_t *node, void *data) {
+	persistent_check_t *check = data;
+	long key = *(long *)node->entries->key;
+
+	if ((check->keys != 0) && (check->last >= key)) {
+		check->is_sorted = 0;
+	}
+
+	check->last = key;
+	++(check->keys);
+	check->entries += node->count;
+}
+
+int64_t check_persistent_avl(persistent_node_t *node) {
+	if (node == NULL) {
+		return 0;
+	}
+
+	int64_t left = check_persistent_avl(node->left);
+	int64_t right = check_persistent_avl(node->right);
+
+	if ((left < 0) || (right < 0) || (left - right > 1) || (right - left > 1)) {
+		return -1;
+	}
+
+	if (node->height != 1 + ((left > right) ? left : right)) {
+		return -1;
+	}
+
+	return node->height;
+}
+
+void* persistent_reader(void *data) {
+	persistent_dict_t *dict = data;
+	size_t *failures = malloc(sizeof(*failures));
+	*failures = 0;
+
+	for (size_t i = 0; i < 200; ++i) {
+		persistent_version_t *snapshot = persistent_dict_snapshot(dict);
+		persistent_check_t check = {0, 0, 0, 1};
+
+		persistent_snapshot_foreach(snapshot, check_persistent_node, &check);
+
+		if ((check.is_sorted == 0) || (check.entries != snapshot->size) || (check_persistent_avl(snapshot->root) < 0)) {
+			++(*failures);
+		}
+
+		persistent_dict_release(dict, snapshot);
+	}
+
+	return failures;
+}
+
+void test_persistent(void) {
+	FILE *fout = fopen("outputs/output_dict_persistent.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	persistent_dict_t *dict = create_persistent_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	ASSERT(fout, dict != NULL, "dict_persistent-01");
+
+	for (long key = 0; key < 100; ++key) {
+		persistent_dict_insert(dict, &key, &key);
+	}
+
+	persistent_version_t *first = persistent_dict_snapshot(dict);
+	ASSERT(fout, first->size == 100, "dict_persistent-02");
+	ASSERT(fout, check_persistent_avl(first->root) == 7, "dict_persistent-03");
+
+	for (long key = 0; key < 100; key += 2) {
+		persistent_dict_delete(dict, &key);
+	}
+
+	long key = 5, value = 50;
+	persistent_dict_insert(dict, &key, &value);
+
+	persistent_version_t *second = persistent_dict_snapshot(dict);
+	persistent_check_t check = {0, 0, 0, 1};
+	persistent_snapshot_foreach(second, check_persistent_node, &check);
+	ASSERT(fout, (second->size == 51) && (check.entries == 51) && (check.keys == 50) && check.is_sorted, "dict_persistent-04");
+	ASSERT(fout, check_persistent_avl(second->root) > 0, "dict_persistent-05");
+
+	persistent_node_t *node = persistent_snapshot_search(dict, second, &key);
+	ASSERT(fout, (node != NULL) && (node->count == 2) && (*(long *)node->entries->value == 50l), "dict_persistent-06");
+
+	/* The first snapshot did not change */
+	check = (persistent_check_t){0, 0, 0, 1};
+	persistent_snapshot_foreach(first, check_persistent_node, &check);
+	ASSERT(fout, (check.entries == 100) && (check.keys == 100) && check.is_sorted, "dict_persistent-07");
+	node = persistent_snapshot_search(dict, first, &key);
+	ASSERT(fout, (node != NULL) && (node->count == 1) && (*(long *)node->entries->value == 5l), "dict_persistent-08");
+	key = 4;
+	ASSERT(fout, persistent_snapshot_search(dict, first, &key) != NULL, "dict_persistent-09");
+	ASSERT(fout, persistent_snapshot_search(dict, second, &key) == NULL, "dict_persistent-10");
+
+	persistent_dict_release(dict, first);
+
+	key = 5;
+	persistent_dict_delete(dict, &key);
+	node = persistent_snapshot_search(dict, second, &key);
+	ASSERT(fout, (node != NULL) && (node->count == 2), "dict_persistent-11");
+	persistent_dict_release(dict, second);
+
+	/* Readers walk snapshots while the writer keeps changing the tree */
+	pthread_t tids[3];
+
+	for (size_t i = 0; i < 3; ++i) {
+		pthread_create(&tids[i], NULL, persistent_reader, dict);
+	}
+
+	for (long i = 0; i < 2000; ++i) {
+		long other = (i * 37) % 300;
+
+		if (i % 3 == 0) {
+			persistent_dict_delete(dict, &other);
+		} else {
+			persistent_dict_insert(dict, &other, &i);
+		}
+	}
+
+	size_t failures = 0;
+
+	for (size_t i = 0; i < 3; ++i) {
+		size_t *reader_failures = NULL;
+		pthread_join(tids[i], (void **)&reader_failures);
+		failures += *reader_failures;
+		free(reader_failures);
+	}
+
+	ASSERT(fout, failures == 0, "dict_persistent-12");
+
+	destroy_persistent_dict(dict);
+
+	fprintf(fout, "\nAll tests for dict_persistent passed!\n");
+	fclose(fout);
+}
+
+void collect_key(dict_node_t *node, void *data) {
+	long_values_t *values = data;
+
+	if (values->size < 16) {
+		values->values[values->size] = *(long *)node->key;
+	}
+
+	++(values->size);
+}
+
+typedef struct sharded_args_s {
+	sharded_dict_t *sdict;
+	long first;
+} sharded_args_t;
+
+void* sharded_worker(void *data) {
+	sharded_args_t *args = data;
+
+	/* Every thread writes keys of all the shards */
+	for (long key = args->first; key < 400; key += 4) {
+		sharded_dict_insert(args->sdict, &key, &key);
+	}
+
+	return NULL;
+}
+
+void test_sharded(void) {
+	FILE *fout = fopen("outputs/output_dict_sharded.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	long splits[] = {100, 200, 300};
+	const void *split_keys[] = {splits, splits + 1, splits + 2};
+
+	sharded_dict_t *sdict = create_sharded_dict(create_long, destroy_long, create_long, destroy_long, compare_long, split_keys + 1, 0);
+	ASSERT(fout, (sdict != NULL) && (sdict->shards_len == 1), "dict_sharded-01");
+	destroy_sharded_dict(sdict);
+
+	const void *bad_keys[] = {splits + 1, splits};
+	ASSERT(fout, create_sharded_dict(create_long, destroy_long, create_long, destroy_long, compare_long, bad_keys, 2) == NULL, "dict_sharded-02");
+
+	sdict = create_sharded_dict(create_long, destroy_long, create_long, destroy_long, compare_long, split_keys, 3);
+	ASSERT(fout, (sdict != NULL) && (sdict->shards_len == 4), "dict_sharded-03");
+
+	long key = 99;
+	ASSERT(fout, sharded_dict_shard(sdict, &key) == 0, "dict_sharded-04");
+	key = 100;
+	ASSERT(fout, sharded_dict_shard(sdict, &key) == 1, "dict_sharded-05");
+	key = 1000;
+	ASSERT(fout, sharded_dict_shard(sdict, &key) == 3, "dict_sharded-06");
+
+	long_values_t values = {.size = 0};
+	ASSERT(fout, sharded_dict_minimum(sdict, collect_key, &values) == 0, "dict_sharded-07");
+
+	pthread_t tids[4];
+	sharded_args_t args[4];
+
+	for (long i = 0; i < 4; ++i) {
+		args[i].sdict = sdict;
+		args[i].first = i;
+		pthread_create(&tids[i], NULL, sharded_worker, &args[i]);
+	}
+
+	for (long i = 0; i < 4; ++i) {
+		pthread_join(tids[i], NULL);
+	}
+
+	ASSERT(fout, sharded_dict_size(sdict) == 400, "dict_sharded-08");
+	ASSERT(fout, concurrent_dict_size(sdict->shards[2]) == 100, "dict_sharded-09");
+
+	/* Only the keys above 250 in the last two shards */
+	for (key = 0; key < 250; ++key) {
+		sharded_dict_delete(sdict, &key);
+	}
+
+	ASSERT(fout, sharded_dict_minimum(sdict, collect_key, &values) == 1, "dict_sharded-10");
+	ASSERT(fout, values.values[0] == 250l, "dict_sharded-11");
+	ASSERT(fout, sharded_dict_maximum(sdict, collect_key, &values) == 1, "dict_sharded-12");
+	ASSERT(fout, values.values[1] == 399l, "dict_sharded-13");
+
+	/* The range crosses the boundary of the last two shards */
+	long left = 295, right = 305;
+	values.size = 0;
+	ASSERT(fout, sharded_dict_range(sdict, &left, &right, collect_key, &values) == 11, "dict_sharded-14");
+	ASSERT(fout, (values.values[0] == 295l) && (values.values[5] == 300l) && (values.values[10] == 305l), "dict_sharded-15");
+
+	size_t visited = 0;
+	ASSERT(fout, sharded_dict_range(sdict, NULL, NULL, count_node, &visited) == 150, "dict_sharded-16");
+	ASSERT(fout, sharded_dict_range(sdict, &right, &left, count_node, &visited) == 0, "dict_sharded-17");
+
+	key = 300;
+	ASSERT(fout, sharded_dict_search(sdict, &key, NULL, NULL) == 1, "dict_sharded-18");
+	key = 200;
+	ASSERT(fout, sharded_dict_search(sdict, &key, NULL, NULL) == 0, "dict_sharded-19");
+
+	destroy_sharded_dict(sdict);
+
+	fprintf(fout, "\nAll tests for dict_sharded passed!\n");
+	fclose(fout);
+}
+
+void collect_index(void *value, void *data) {
+	range_t *range = data;
+
+	if (range->size < range->capacity) {
+		range->index[range->size] = *(int32_t *)value;
+	}
+
+	++(range->size);
+}
+
+uint8_t check_same_entries(dict_t *dict1, dict_t *dict2) {
+	if (dict1->size != dict2->size) {
+		return 0;
+	}
+
+	dict_node_t *iter1 = dict_minimum(dict1->root);
+	dict_node_t *iter2 = dict_minimum(dict2->root);
+	range_t range1 = {malloc(sizeof(int32_t) * dict1->size), 0, dict1->size};
+	range_t range2 = {malloc(sizeof(int32_t) * dict2->size), 0, dict2->size};
+
+	while ((iter1 != NULL) && (iter2 != NULL)) {
+		if (compare_str(iter1->key, iter2->key) != 0) {
+			break;
+		}
+
+		dict_foreach_value(iter1, collect_index, &range1);
+		dict_foreach_value(iter2, collect_index, &range2);
+
+		iter1 = iter1->end->next;
+		iter2 = iter2->end->next;
+	}
+
+	uint8_t is_same = (iter1 == NULL) && (iter2 == NULL) && (range1.size == range2.size);
+	is_same = is_same && (memcmp(range1.index, range2.index, sizeof(int32_t) * range1.size) == 0);
+
+	free(range1.index);
+	free(range2.index);
+
+	return is_same;
+}
+
+void test_parallel_build(void) {
+	FILE *fout = fopen("outputs/output_dict_parallel_build.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	/* Enough short lines of words for several chunks */
+	FILE *fwords = fopen("outputs/parallel_words.txt", "w");
+	uint32_t state = 7;
+
+	for (size_t line = 0; line < 2000; ++line) {
+		for (size_t word = 0; word < 8; ++word) {
+			state = state * 1103515245u + 12345u;
+
+			size_t word_len = 1 + (state >> 16) % 7;
+
+			for (size_t letter = 0; letter < word_len; ++letter) {
+				fputc('a' + (state >> (letter + 3)) % 4, fwords);
+			}
+
+			fputs(((state >> 12) % 5 == 0) ? ", " : " ", fwords);
+		}
+
+		fputs((line % 3 == 0) ? ".\n" : "\n", fwords);
+	}
+
+	fclose(fwords);
+
+	dict_t *sequential = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	build_dict_from_file("outputs/parallel_words.txt", sequential);
+
+	dict_t *parallel = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	build_dict_from_file_parallel("outputs/parallel_words.txt", parallel, 1);
+	ASSERT(fout, parallel->size == 16000, "dict_parallel_build-01");
+	ASSERT(fout, check_same_entries(sequential, parallel) == 1, "dict_parallel_build-02");
+	destroy_dict(parallel);
+
+	parallel = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	build_dict_from_file_parallel("outputs/parallel_words.txt", parallel, 3);
+	ASSERT(fout, check_same_entries(sequential, parallel) == 1, "dict_parallel_build-03");
+	ASSERT(fout, check_avl_node(parallel->root) > 0, "dict_parallel_build-04");
+	destroy_dict(parallel);
+
+	parallel = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	dict_set_inline_keys(parallel, ELEMENT_DICT_LENGTH + 1, inline_str_element);
+	dict_set_value_vectors(parallel);
+	build_dict_from_file_parallel("outputs/parallel_words.txt", parallel, 8);
+	ASSERT(fout, check_same_entries(sequential, parallel) == 1, "dict_parallel_build-05");
+	destroy_dict(parallel);
+
+	/* The new entries go after the ones already loaded */
+	build_dict_from_file("inputs/key.txt", sequential);
+
+	parallel = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	build_dict_from_file_parallel("outputs/parallel_words.txt", parallel, 4);
+	build_dict_from_file_parallel("inputs/key.txt", parallel, 0);
+	ASSERT(fout, check_same_entries(sequential, parallel) == 1, "dict_parallel_build-06");
+	ASSERT(fout, check_avl_node(parallel->root) > 0, "dict_parallel_build-07");
+	destroy_dict(parallel);
+
+	/* The private arenas refuse this node size, nothing is loaded */
+	parallel = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	dict_set_inline_keys(parallel, SIZE_MAX - sizeof(dict_node_t) - 4, inline_str_element);
+	build_dict_from_file_parallel("outputs/parallel_words.txt", parallel, 2);
+	ASSERT(fout, (parallel->root == NULL) && (parallel->size == 0), "dict_parallel_build-08");
+	destroy_dict(parallel);
+
+	destroy_dict(sequential);
+
+	fprintf(fout, "\nAll tests for dict_parallel_build passed!\n");
+	fclose(fout);
+}
+
+dict_t* create_long_dict(long first, long last, long step) {
+	dict_t *dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+
+	for (long key = first; key <= last; key += step) {
+		dict_insert(dict, &key, &key);
+	}
+
+	return dict;
+}
+
+void test_set_ops(void) {
+	FILE *fout = fopen("outputs/output_dict_set_ops.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	/* Keys 0, 2, ..., 98 and keys 0, 3, ..., 99 */
+	dict_t *dict = create_long_dict(0, 98, 2);
+	dict_t *other = create_long_dict(0, 99, 3);
+
+	long key = 6, value = 600;
+	dict_insert(other, &key, &value);
+
+	dict_union(dict, other);
+	ASSERT(fout, dict->size == 85, "dict_set_ops-01");
+	ASSERT(fout, dict->root->subtree_keys == 67, "dict_set_ops-02");
+	ASSERT(fout, (check_avl_node(dict->root) > 0) && (check_dict_list(dict) == 1), "dict_set_ops-03");
+	ASSERT(fout, check_subtree_size(dict->root) == 85, "dict_set_ops-04");
+
+	/* The entries of "dict" come first */
+	dict_node_t *node = dict_search(dict, dict->root, &key);
+	long_values_t values = {.size = 0};
+	dict_foreach_value(node, collect_long, &values);
+	ASSERT(fout, (values.size == 3) && (values.values[0] == 6l) && (values.values[2] == 600l), "dict_set_ops-05");
+
+	dict_intersection(dict, create_long_dict(0, 99, 6));
+	ASSERT(fout, dict->root->subtree_keys == 17, "dict_set_ops-06");
+	ASSERT(fout, (check_avl_node(dict->root) > 0) && (check_dict_list(dict) == 1), "dict_set_ops-07");
+	ASSERT(fout, dict->size == 35, "dict_set_ops-08");
+
+	dict_difference(dict, create_long_dict(0, 99, 4));
+	ASSERT(fout, dict->root->subtree_keys == 8, "dict_set_ops-09");
+	ASSERT(fout, (check_avl_node(dict->root) > 0) && (check_dict_list(dict) == 1), "dict_set_ops-10");
+	ASSERT(fout, (*(long *)dict_minimum(dict->root)->key == 6l) && (*(long *)dict_maximum(dict->root)->key == 90l), "dict_set_ops-11");
+
+	/* Keys 6, 18, ..., 90 with two entries each and key 6 with three */
+	key = 42;
+	other = dict_split_at(dict, &key);
+	ASSERT(fout, (dict->root->subtree_keys == 3) && (other->root->subtree_keys == 5), "dict_set_ops-12");
+	ASSERT(fout, (dict->size == 7) && (other->size == 10), "dict_set_ops-13");
+	ASSERT(fout, *(long *)dict_minimum(other->root)->key == 42l, "dict_set_ops-14");
+	ASSERT(fout, (dict_maximum(dict->root)->end->next == NULL) && (dict_minimum(other->root)->prev == NULL), "dict_set_ops-15");
+	ASSERT(fout, dict_join(other, dict) == 0, "dict_set_ops-16");
+	ASSERT(fout, dict_join(dict, other) == 1, "dict_set_ops-17");
+	ASSERT(fout, (dict->size == 17) && (check_avl_node(dict->root) > 0) && (check_dict_list(dict) == 1), "dict_set_ops-18");
+
+	destroy_dict(dict);
+
+	/* Different node layouts, the entries are copied */
+	other = create_long_dict(500, 1499, 1);
+
+	dict_t *arena_dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	dict_set_node_arena(arena_dict, 16, 0);
+
+	for (key = 0; key < 1000; ++key) {
+		dict_insert(arena_dict, &key, &key);
+	}
+
+	dict_union(arena_dict, other);
+	ASSERT(fout, (arena_dict->size == 2000) && (arena_dict->root->subtree_keys == 1500), "dict_set_ops-19");
+	ASSERT(fout, (check_avl_node(arena_dict->root) > 0) && (check_dict_list(arena_dict) == 1), "dict_set_ops-20");
+
+	key = 750;
+	other = dict_split_at(arena_dict, &key);
+	ASSERT(fout, (other->arena == arena_dict->arena) && (other->arena->refs == 2), "dict_set_ops-21");
+	ASSERT(fout, (arena_dict->size == 1000) && (other->size == 1000), "dict_set_ops-22");
+
+	dict_difference(other, arena_dict);
+	ASSERT(fout, (other->size == 1000) && (other->arena->refs == 1), "dict_set_ops-23");
+
+	destroy_dict(other);
+
+	fprintf(fout, "\nAll tests for dict_set_ops passed!\n");
+	fclose(fout);
+}
+
+void test_batch_ops(void) {
+	FILE *fout = fopen("outputs/output_dict_batch_ops.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	/* Keys 0, 2, ..., 98 */
+	dict_t *dict = create_long_dict(0, 98, 2);
+
+	long batch[] = {7, 3, 10, 7, 101, 3, 7, -1};
+	long batch_values[] = {70, 30, 100, 71, 1010, 31, 72, -10};
+	const void *keys[8], *values[8];
+
+	for (size_t i = 0; i < 8; ++i) {
+		keys[i] = batch + i;
+		values[i] = batch_values + i;
+	}
+
+	dict_insert_batch(dict, keys, values, 8);
+	ASSERT(fout, (dict->size == 58) && (dict->root->subtree_keys == 54), "dict_batch_ops-01");
+	ASSERT(fout, (check_avl_node(dict->root) > 0) && (check_dict_list(dict) == 1), "dict_batch_ops-02");
+	ASSERT(fout, check_subtree_size(dict->root) == 58, "dict_batch_ops-03");
+
+	/* The entries of a key keep the batch order */
+	long key = 7;
+	dict_node_t *node = dict_search(dict, dict->root, &key);
+	long_values_t found = {.size = 0};
+	dict_foreach_value(node, collect_long, &found);
+	ASSERT(fout, (found.size == 3) && (found.values[0] == 70l) && (found.values[1] == 71l) && (found.values[2] == 72l), "dict_batch_ops-04");
+
+	key = 10;
+	node = dict_search(dict, dict->root, &key);
+	found.size = 0;
+	dict_foreach_value(node, collect_long, &found);
+	ASSERT(fout, (found.size == 2) && (found.values[0] == 10l) && (found.values[1] == 100l), "dict_batch_ops-05");
+	ASSERT(fout, (*(long *)dict_minimum(dict->root)->key == -1l) && (*(long *)dict_maximum(dict->root)->key == 101l), "dict_batch_ops-06");
+
+	/* Every key removes its last entry, missing keys are skipped */
+	long delete_batch[] = {7, 10, 55, 7, 0, 101, 98, 3};
+	const void *delete_keys[8];
+
+	for (size_t i = 0; i < 8; ++i) {
+		delete_keys[i] = delete_batch + i;
+	}
+
+	dict_delete_batch(dict, delete_keys, 8);
+	ASSERT(fout, (dict->size == 51) && (dict->root->subtree_keys == 51), "dict_batch_ops-07");
+	ASSERT(fout, (check_avl_node(dict->root) > 0) && (check_dict_list(dict) == 1), "dict_batch_ops-08");
+	ASSERT(fout, check_subtree_size(dict->root) == 51, "dict_batch_ops-09");
+
+	key = 7;
+	node = dict_search(dict, dict->root, &key);
+	found.size = 0;
+	dict_foreach_value(node, collect_long, &found);
+	ASSERT(fout, (found.size == 1) && (found.values[0] == 70l), "dict_batch_ops-10");
+
+	key = 10;
+	node = dict_search(dict, dict->root, &key);
+	found.size = 0;
+	dict_foreach_value(node, collect_long, &found);
+	ASSERT(fout, (found.size == 1) && (found.values[0] == 10l), "dict_batch_ops-11");
+
+	key = 0;
+	ASSERT(fout, dict_search(dict, dict->root, &key) == NULL, "dict_batch_ops-12");
+	ASSERT(fout, *(long *)dict_maximum(dict->root)->key == 96l, "dict_batch_ops-13");
+
+	destroy_dict(dict);
+
+	/* Large batches on a dictionary with value vectors */
+	dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	dict_set_value_vectors(dict);
+
+	long *big_batch = malloc(sizeof(*big_batch) * 3000);
+	const void **big_keys = malloc(sizeof(*big_keys) * 3000);
+
+	for (size_t i = 0; i < 3000; ++i) {
+		big_batch[i] = (long)((i * 7919) % 1000);
+		big_keys[i] = big_batch + i;
+	}
+
+	dict_insert_batch(dict, big_keys, big_keys, 3000);
+	ASSERT(fout, (dict->size == 3000) && (dict->root->subtree_keys == 1000), "dict_batch_ops-14");
+	ASSERT(fout, (check_avl_node(dict->root) > 0) && (check_subtree_size(dict->root) == 3000), "dict_batch_ops-15");
+
+	dict_delete_batch(dict, big_keys, 2000);
+	ASSERT(fout, (dict->size == 1000) && (check_subtree_size(dict->root) == 1000), "dict_batch_ops-16");
+	ASSERT(fout, (check_avl_node(dict->root) > 0) && (dict->root->subtree_keys == 1000), "dict_batch_ops-17");
+
+	dict_delete_batch(dict, big_keys + 2000, 1000);
+	ASSERT(fout, (dict->size == 0) && (dict->root == NULL), "dict_batch_ops-18");
+
+	free(big_batch);
+	free(big_keys);
+	destroy_dict(dict);
+
+	fprintf(fout, "\nAll tests for dict_batch_ops passed!\n");
+	fclose(fout);
+}
+
+void test_tokenizer(void) {
+	FILE *fout = fopen("outputs/output_dict_tokenizer.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	/* A word longer than a line buffer and no new line at the end */
+	FILE *fwords = fopen("outputs/tokenizer_words.txt", "w");
+
+	fputs("AB,CD.\r\n", fwords);
+
+	for (size_t letter = 0; letter < 3 * BUFFER_LEN; ++letter) {
+		fputc('Q', fwords);
+	}
+
+	fputs(" XY?? \n\nZZ", fwords);
+	fclose(fwords);
+
+	dict_t *dict = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+
+	build_dict_from_file("outputs/tokenizer_words.txt", dict);
+	ASSERT(fout, dict->size == 5, "dict_tokenizer-01");
+	ASSERT(fout, (check_avl_node(dict->root) > 0) && (check_subtree_size(dict->root) == 5), "dict_tokenizer-02");
+
+	const char *words[] = {"AB", "CD", "QQQQQ", "XY", "ZZ"};
+	int32_t indexes[] = {0, 2, 4, 4 + 3 * BUFFER_LEN, 6 + 3 * BUFFER_LEN};
+	uint8_t found_all = 1;
+
+	for (size_t i = 0; i < 5; ++i) {
+		dict_node_t *node = dict_search(dict, dict->root, words[i]);
+
+		if ((node == NULL) || (*(int32_t *)node->value != indexes[i])) {
+			found_all = 0;
+		}
+	}
+
+	ASSERT(fout, found_all == 1, "dict_tokenizer-03");
+
+	/* An empty file adds nothing */
+	fclose(fopen("outputs/tokenizer_words.txt", "w"));
+
+	build_dict_from_file("outputs/tokenizer_words.txt", dict);
+	ASSERT(fout, dict->size == 5, "dict_tokenizer-04");
+
+	destroy_dict(dict);
+
+	fprintf(fout, "\nAll tests for dict_tokenizer passed!\n");
+	fclose(fout);
+}
+
+uint8_t check_word_scan(const char *text, size_t len, size_t slices_len) {
+	word_slice_t *slices = malloc(sizeof(*slices) * slices_len);
+	size_t pos = 0, iter = 0;
+	uint8_t same = 1;
+
+	while ((same == 1) && (pos < len)) {
+		size_t found = word_scan(text, len, &pos, slices, slices_len);
+
+		for (size_t slice = 0; slice < found; ++slice) {
+			/* Walk the text one character at a time next to the scanner */
+			while ((iter < len) && word_is_separator(text[iter])) {
+				++iter;
+			}
+
+			size_t start = iter;
+
+			while ((iter < len) && !word_is_separator(text[iter])) {
+				++iter;
+			}
+
+			if ((slices[slice].start != start) || (slices[slice].len != iter - start)) {
+				same = 0;
+			}
+		}
+
+		if ((found == 0) && (pos < len)) {
+			same = 0;
+		}
+	}
+
+	/* No word is left after the scan */
+	while ((iter < len) && word_is_separator(text[iter])) {
+		++iter;
+	}
+
+	free(slices);
+
+	return (same == 1) && (iter == len);
+}
+
+void test_word_scanner(void) {
+	FILE *fout = fopen("outputs/output_dict_word_scanner.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	/* Short and long words around the block edges, with every separator */
+	const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdef,.? \n\r";
+	size_t text_len = 20000;
+	char *text = malloc(text_len);
+	uint32_t state = 11;
+
+	for (size_t i = 0; i < text_len; ++i) {
+		state = state * 1103515245u + 12345u;
+
+		size_t range = ((i / 1000) % 2 == 0) ? sizeof(alphabet) - 1 : 32;
+		text[i] = alphabet[(state >> 16) % range];
+	}
+
+	text[5000] = '\0';
+
+	uint8_t default_level = word_scan_level();
+
+	ASSERT(fout, word_scan_set_level(WORD_SCAN_SCALAR) == 1, "dict_word_scanner-01");
+	ASSERT(fout, word_scan_level() == WORD_SCAN_SCALAR, "dict_word_scanner-02");
+
+	uint8_t same = 1;
+
+	for (uint8_t level = WORD_SCAN_SCALAR; level <= WORD_SCAN_AVX2; ++level) {
+		if (word_scan_set_level(level) == 0) {
+			continue;
+		}
+
+		for (size_t offset = 0; offset < 70; offset += 3) {
+			same &= check_word_scan(text + offset, text_len - offset, 1);
+			same &= check_word_scan(text + offset, text_len - offset - 1, 7);
+			same &= check_word_scan(text + offset, 64 + offset, 256);
+		}
+	}
+
+	ASSERT(fout, same == 1, "dict_word_scanner-03");
+
+	word_scan_set_level(default_level);
+
+	/* A word that reaches the end is given as well */
+	const char *words = ".. ABC,DE";
+	word_slice_t slices[4];
+	size_t pos = 0;
+
+	ASSERT(fout, word_scan(words, strlen(words), &pos, slices, 1) == 1, "dict_word_scanner-04");
+	ASSERT(fout, (slices[0].start == 3) && (slices[0].len == 3) && (pos == 6), "dict_word_scanner-05");
+	ASSERT(fout, word_scan(words, strlen(words), &pos, slices, 4) == 1, "dict_word_scanner-06");
+	ASSERT(fout, (slices[0].start == 7) && (slices[0].len == 2) && (pos == strlen(words)), "dict_word_scanner-07");
+
+	free(text);
+
+	fprintf(fout, "\nAll tests for dict_word_scanner passed!\n");
+	fclose(fout);
+}
+
+void shift_text(char *text, size_t len, const int32_t *index, size_t size, size_t *idx, uint8_t is_decrypt) {
+	for (size_t i = 0; i < len; ++i) {
+		if ((text[i] == ' ') || (text[i] == '\n') || (text[i] == '\r')) {
+			continue;
+		}
+
+		if (is_decrypt) {
+			text[i] = ((toupper(text[i]) - 'A') - (index[*idx] % 26) + 26) % 26 + 'A';
+		} else {
+			text[i] = ((toupper(text[i]) - 'A') + index[*idx] % 26) % 26 + 'A';
+		}
+
+		if (++(*idx) == size) {
+			*idx = 0;
+		}
+	}
+}
+
+void test_cipher_kernels(void) {
+	FILE *fout = fopen("outputs/output_dict_cipher_kernels.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	/* Mostly letters and spaces, with a few other characters */
+	const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz     \n\r,.?09";
+	size_t text_len = 5000;
+	char *text = malloc(text_len);
+	char *expected = malloc(text_len);
+	char *result = malloc(text_len);
+	uint32_t state = 5;
+
+	for (size_t i = 0; i < text_len; ++i) {
+		state = state * 1103515245u + 12345u;
+
+		size_t range = (i < 3000) ? 58 : sizeof(alphabet) - 1;
+		text[i] = alphabet[(state >> 16) % range];
+	}
+
+	int32_t index[] = {3, 25, 0, 14, 7, 52, 11};
+	size_t sizes[] = {1, 7};
+
+	ASSERT(fout, create_cipher_key(index, 0) == NULL, "dict_cipher_kernels-01");
+
+	uint8_t default_level = cipher_kernel_level();
+	uint8_t same = 1;
+
+	for (uint8_t level = CIPHER_KERNEL_SCALAR; level <= CIPHER_KERNEL_AVX2; ++level) {
+		if (cipher_kernel_set_level(level) == 0) {
+			continue;
+		}
+
+		for (size_t s = 0; s < 2; ++s) {
+			for (uint8_t is_decrypt = 0; is_decrypt < 2; ++is_decrypt) {
+				size_t idx = 0;
+
+				memcpy(expected, text, text_len);
+				shift_text(expected, text_len, index, sizes[s], &idx, is_decrypt);
+
+				/* Blocks of every length, the key goes on between them */
+				cipher_key_t *prepared = create_cipher_key(index, sizes[s]);
+				cipher_stream_t stream = {prepared, 0};
+				size_t done = 0, block_len = 1;
+
+				memcpy(result, text, text_len);
+
+				while (done < text_len) {
+					size_t len = (block_len < text_len - done) ? block_len : text_len - done;
+
+					if (is_decrypt) {
+						cipher_decrypt_block(&stream, result + done, len);
+					} else {
+						cipher_encrypt_block(&stream, result + done, len);
+					}
+
+					done += len;
+					block_len = block_len * 3 % 97 + 1;
+				}
+
+				same &= (memcmp(expected, result, text_len) == 0);
+				same &= (stream.idx == idx);
+
+				destroy_cipher_key(prepared);
+			}
+		}
+	}
+
+	ASSERT(fout, same == 1, "dict_cipher_kernels-02");
+
+	/* The tables of a prepared key */
+	cipher_key_t *prepared = create_cipher_key(index, 7);
+	ASSERT(fout, (prepared->shifts[5] == 0) && (prepared->shifts[7] == 3) && (prepared->shifts[13] == 11), "dict_cipher_kernels-03");
+	ASSERT(fout, (prepared->encrypt_table[3]['Z' - 'A'] == 'C') && (prepared->decrypt_table[3]['C' - 'A'] == 'Z'), "dict_cipher_kernels-04");
+	ASSERT(fout, (prepared->letters['q'] == 'Q' - 'A') && (prepared->letters[' '] == CIPHER_KEPT) && (prepared->letters[','] == CIPHER_OTHER), "dict_cipher_kernels-05");
+	destroy_cipher_key(prepared);
+
+	cipher_kernel_set_level(default_level);
+
+	/* The letters come back after an encrypt and a decrypt */
+	range_t key = {index, 7, 7};
+	FILE *fplain = fopen("outputs/cipher_kernels_plain.txt", "w");
+
+	fwrite(text, 1, 3000, fplain);
+	fclose(fplain);
+
+	encrypt("outputs/cipher_kernels_plain.txt", "outputs/cipher_kernels_secret.txt", &key);
+	decrypt("outputs/cipher_kernels_secret.txt", "outputs/cipher_kernels_back.txt", &key);
+
+	FILE *fback = fopen("outputs/cipher_kernels_back.txt", "r");
+	size_t back_len = fread(result, 1, text_len, fback);
+	fclose(fback);
+
+	for (size_t i = 0; i < 3000; ++i) {
+		expected[i] = (char)toupper(text[i]);
+	}
+
+	ASSERT(fout, (back_len == 3000) && (memcmp(expected, result, 3000) == 0), "dict_cipher_kernels-06");
+
+	free(text);
+	free(expected);
+	free(result);
+
+	fprintf(fout, "\nAll tests for dict_cipher_kernels passed!\n");
+	fclose(fout);
+}
+
+uint8_t same_file(const char *filename, const char *text, size_t len) {
+	FILE *fin = fopen(filename, "r");
+
+	if (fin == NULL) {
+		return 0;
+	}
+
+	char *content = malloc(len + 1);
+	size_t content_len = fread(content, 1, len + 1, fin);
+	uint8_t same = (content_len == len) && (memcmp(content, text, len) == 0);
+
+	free(content);
+	fclose(fin);
+
+	return same;
+}
+
+void test_cipher_streams(void) {
+	FILE *fout = fopen("outputs/output_dict_cipher_streams.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	/* Lines longer than the old line buffer */
+	size_t text_len = 3 * BUFFER_LEN + 100;
+	char *text = malloc(text_len);
+	char *secret = malloc(text_len);
+	uint32_t state = 9;
+
+	for (size_t i = 0; i < text_len; ++i) {
+		state = state * 1103515245u + 12345u;
+		text[i] = ((state >> 16) % 7 == 0) ? ' ' : (char)('a' + (state >> 8) % 26);
+	}
+
+	text[BUFFER_LEN / 2] = '\n';
+	text[text_len - 1] = '\n';
+
+	int32_t index[] = {4, 17, 9, 0, 22};
+	range_t key = {index, 5, 5};
+
+	FILE *fplain = fopen("outputs/cipher_streams_plain.txt", "w");
+	fwrite(text, 1, text_len, fplain);
+	fclose(fplain);
+
+	/* The reference is the file to file encrypt */
+	encrypt("outputs/cipher_streams_plain.txt", "outputs/cipher_streams_secret.txt", &key);
+
+	FILE *fsecret = fopen("outputs/cipher_streams_secret.txt", "r");
+	size_t secret_len = fread(secret, 1, text_len, fsecret);
+	fclose(fsecret);
+	ASSERT(fout, secret_len == text_len, "dict_cipher_streams-01");
+
+	FILE *fin = fopen("outputs/cipher_streams_plain.txt", "r");
+	FILE *fstream = fopen("outputs/cipher_streams_stream.txt", "w");
+	ASSERT(fout, encrypt_stream(fin, fstream, &key) == 1, "dict_cipher_streams-02");
+	fclose(fin);
+	fclose(fstream);
+	ASSERT(fout, same_file("outputs/cipher_streams_stream.txt", secret, text_len) == 1, "dict_cipher_streams-03");
+
+	/* A pipe as input, the message fits in the pipe buffer */
+	int pipe_fds[2];
+	ASSERT(fout, pipe(pipe_fds) == 0, "dict_cipher_streams-04");
+	ASSERT(fout, write(pipe_fds[1], text, text_len) == (ssize_t)text_len, "dict_cipher_streams-05");
+	close(pipe_fds[1]);
+
+	int fd_out = open("outputs/cipher_streams_fd.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	ASSERT(fout, encrypt_fd(pipe_fds[0], fd_out, &key) == 1, "dict_cipher_streams-06");
+	close(pipe_fds[0]);
+	close(fd_out);
+	ASSERT(fout, same_file("outputs/cipher_streams_fd.txt", secret, text_len) == 1, "dict_cipher_streams-07");
+
+	ASSERT(fout, encrypt_in_place("outputs/cipher_streams_plain.txt", &key) == 1, "dict_cipher_streams-08");
+	ASSERT(fout, same_file("outputs/cipher_streams_plain.txt", secret, text_len) == 1, "dict_cipher_streams-09");
+
+	/* Every way back gives the upper case message */
+	for (size_t i = 0; i < text_len; ++i) {
+		text[i] = (char)toupper(text[i]);
+	}
+
+	ASSERT(fout, decrypt_in_place("outputs/cipher_streams_plain.txt", &key) == 1, "dict_cipher_streams-10");
+	ASSERT(fout, same_file("outputs/cipher_streams_plain.txt", text, text_len) == 1, "dict_cipher_streams-11");
+
+	fin = fopen("outputs/cipher_streams_stream.txt", "r");
+	fstream = fopen("outputs/cipher_streams_back.txt", "w");
+	ASSERT(fout, decrypt_stream(fin, fstream, &key) == 1, "dict_cipher_streams-12");
+	fclose(fin);
+	fclose(fstream);
+	ASSERT(fout, same_file("outputs/cipher_streams_back.txt", text, text_len) == 1, "dict_cipher_streams-13");
+
+	int fd_in = open("outputs/cipher_streams_fd.txt", O_RDONLY);
+	fd_out = open("outputs/cipher_streams_back.txt", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	ASSERT(fout, decrypt_fd(fd_in, fd_out, &key) == 1, "dict_cipher_streams-14");
+	close(fd_in);
+	close(fd_out);
+	ASSERT(fout, same_file("outputs/cipher_streams_back.txt", text, text_len) == 1, "dict_cipher_streams-15");
+
+	/* Missing files and keys */
+	ASSERT(fout, encrypt_in_place("outputs/missing_file.txt", &key) == 0, "dict_cipher_streams-16");
+	ASSERT(fout, encrypt_fd(-1, 1, &key) == 0, "dict_cipher_streams-17");
+	ASSERT(fout, decrypt_stream(NULL, stdout, &key) == 0, "dict_cipher_streams-18");
+
+	free(text);
+	free(secret);
+
+	fprintf(fout, "\nAll tests for dict_cipher_streams passed!\n");
+	fclose(fout);
+}
+
+void test_cipher_parallel(void) {
+	FILE *fout = fopen("outputs/output_dict_cipher_parallel.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	/* Enough characters for several chunks, with runs of spaces */
+	const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghij     \n\r,.";
+	size_t text_len = 50000;
+	char *text = malloc(text_len);
+	char *secret = malloc(text_len);
+	char *plain = malloc(text_len);
+	uint32_t state = 13;
+
+	for (size_t i = 0; i < text_len; ++i) {
+		state = state * 1103515245u + 12345u;
+		text[i] = ((i / 4000) % 3 == 1) ? ' ' : alphabet[(state >> 16) % (sizeof(alphabet) - 1)];
+	}
+
+	int32_t index[] = {4, 17, 9, 0, 22, 13, 6};
+	range_t key = {index, 7, 7};
+
+	FILE *fplain = fopen("outputs/cipher_parallel_plain.txt", "w");
+	fwrite(text, 1, text_len, fplain);
+	fclose(fplain);
+
+	/* The sequential functions give the reference */
+	encrypt("outputs/cipher_parallel_plain.txt", "outputs/cipher_parallel_secret.txt", &key);
+	decrypt("outputs/cipher_parallel_secret.txt", "outputs/cipher_parallel_back.txt", &key);
+
+	FILE *fsecret = fopen("outputs/cipher_parallel_secret.txt", "r");
+	ASSERT(fout, fread(secret, 1, text_len, fsecret) == text_len, "dict_cipher_parallel-01");
+	fclose(fsecret);
+
+	FILE *fback = fopen("outputs/cipher_parallel_back.txt", "r");
+	ASSERT(fout, fread(plain, 1, text_len, fback) == text_len, "dict_cipher_parallel-02");
+	fclose(fback);
+
+	size_t threads[] = {1, 3, 8, 0};
+	uint8_t same = 1;
+
+	for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); ++i) {
+		same &= encrypt_parallel("outputs/cipher_parallel_plain.txt", "outputs/cipher_parallel_out.txt", &key, threads[i]);
+		same &= same_file("outputs/cipher_parallel_out.txt", secret, text_len);
+		same &= decrypt_parallel("outputs/cipher_parallel_out.txt", "outputs/cipher_parallel_out.txt", &key, threads[i]);
+		same &= same_file("outputs/cipher_parallel_out.txt", plain, text_len);
+	}
+
+	ASSERT(fout, same == 1, "dict_cipher_parallel-03");
+
+	ASSERT(fout, encrypt_parallel("outputs/cipher_parallel_plain.txt", NULL, &key, 4) == 1, "dict_cipher_parallel-04");
+	ASSERT(fout, same_file("outputs/cipher_parallel_plain.txt", secret, text_len) == 1, "dict_cipher_parallel-05");
+
+	/* An empty message and a missing one */
+	fclose(fopen("outputs/cipher_parallel_plain.txt", "w"));
+	ASSERT(fout, decrypt_parallel("outputs/cipher_parallel_plain.txt", "outputs/cipher_parallel_out.txt", &key, 4) == 1, "dict_cipher_parallel-06");
+	ASSERT(fout, same_file("outputs/cipher_parallel_out.txt", plain, 0) == 1, "dict_cipher_parallel-07");
+	ASSERT(fout, encrypt_parallel("outputs/missing_file.txt", "outputs/cipher_parallel_out.txt", &key, 4) == 0, "dict_cipher_parallel-08");
+
+	free(text);
+	free(secret);
+	free(plain);
+
+	fprintf(fout, "\nAll tests for dict_cipher_parallel passed!\n");
+	fclose(fout);
+}
+
+size_t save_index_info(void *dest, size_t dest_len, const void *index) {
+	if (sizeof(int32_t) <= dest_len) {
+		memcpy(dest, index, sizeof(int32_t));
+	}
+
+	return sizeof(int32_t);
+}
+
+size_t save_long(void *dest, size_t dest_len, const void *value) {
+	if (sizeof(long) <= dest_len) {
+		memcpy(dest, value, sizeof(long));
+	}
+
+	return sizeof(long);
+}
+
+void test_save_load(void) {
+	FILE *fout = fopen("outputs/output_dict_save_load.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	dict_t *saved = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	build_dict_from_file("inputs/key.txt", saved);
+	ASSERT(fout, dict_save(saved, "outputs/dict_snapshot.bin", inline_str_element, save_index_info) == 1, "dict_save_load-01");
+
+	dict_t *loaded = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	ASSERT(fout, dict_load(loaded, "outputs/dict_snapshot.bin") == 1, "dict_save_load-02");
+	ASSERT(fout, check_same_entries(saved, loaded) == 1, "dict_save_load-03");
+	ASSERT(fout, (check_avl_node(loaded->root) > 0) && (check_subtree_size(loaded->root) == loaded->size), "dict_save_load-04");
+
+	/* A dictionary that is not empty is left as it is */
+	ASSERT(fout, dict_load(loaded, "outputs/dict_snapshot.bin") == 0, "dict_save_load-05");
+	destroy_dict(loaded);
+
+	/* A value vector dictionary with runs of duplicates */
+	dict_t *vectors = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	dict_set_value_vectors(vectors);
+
+	for (long i = 0; i < 300; ++i) {
+		long key = (i * 7) % 50;
+		dict_insert(vectors, &key, &i);
+	}
+
+	ASSERT(fout, dict_save(vectors, "outputs/dict_snapshot_vectors.bin", save_long, save_long) == 1, "dict_save_load-06");
+
+	loaded = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	dict_set_value_vectors(loaded);
+	ASSERT(fout, dict_load(loaded, "outputs/dict_snapshot_vectors.bin") == 1, "dict_save_load-07");
+	ASSERT(fout, (loaded->size == 300) && (loaded->root->subtree_keys == 50), "dict_save_load-08");
+	ASSERT(fout, (check_avl_node(loaded->root) > 0) && (check_subtree_size(loaded->root) == 300), "dict_save_load-09");
+
+	long key = 7;
+	long_values_t found = {.size = 0};
+	dict_foreach_value(dict_search(loaded, loaded->root, &key), collect_long, &found);
+	ASSERT(fout, (found.size == 6) && (found.values[0] == 1l) && (found.values[1] == 51l) && (found.values[5] == 251l), "dict_save_load-10");
+	destroy_dict(loaded);
+	destroy_dict(vectors);
+
+	/* An empty dictionary */
+	dict_t *empty = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	ASSERT(fout, dict_save(empty, "outputs/dict_snapshot_empty.bin", save_long, save_long) == 1, "dict_save_load-11");
+	ASSERT(fout, (dict_load(empty, "outputs/dict_snapshot_empty.bin") == 1) && (empty->root == NULL), "dict_save_load-12");
+	destroy_dict(empty);
+
+	/* One changed byte, a newer version, a cut file and a missing file */
+	FILE *fsnapshot = fopen("outputs/dict_snapshot.bin", "r+b");
+	fseek(fsnapshot, -3, SEEK_END);
+	int last = fgetc(fsnapshot);
+	fseek(fsnapshot, -3, SEEK_END);
+	fputc(last ^ 0x20, fsnapshot);
+	fclose(fsnapshot);
+
+	loaded = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	ASSERT(fout, (dict_load(loaded, "outputs/dict_snapshot.bin") == 0) && (loaded->root == NULL), "dict_save_load-13");
+
+	dict_save(saved, "outputs/dict_snapshot.bin", inline_str_element, save_index_info);
+	fsnapshot = fopen("outputs/dict_snapshot.bin", "r+b");
+	uint32_t version = DICT_SNAPSHOT_VERSION + 1;
+	fseek(fsnapshot, 8, SEEK_SET);
+	fwrite(&version, sizeof(version), 1, fsnapshot);
+	fclose(fsnapshot);
+	ASSERT(fout, dict_load(loaded, "outputs/dict_snapshot.bin") == 0, "dict_save_load-14");
+
+	dict_save(saved, "outputs/dict_snapshot.bin", inline_str_element, save_index_info);
+	ASSERT(fout, truncate("outputs/dict_snapshot.bin", 100) == 0, "dict_save_load-15");
+	ASSERT(fout, dict_load(loaded, "outputs/dict_snapshot.bin") == 0, "dict_save_load-16");
+	ASSERT(fout, dict_load(loaded, "outputs/missing_file.bin") == 0, "dict_save_load-17");
+	destroy_dict(loaded);
+	destroy_dict(saved);
+
+	fprintf(fout, "\nAll tests for dict_save_load passed!\n");
+	fclose(fout);
+}
+
+uint8_t check_frozen(frozen_dict_t *frozen, dict_t *dict) {
+	if ((frozen->size != dict->size) || (frozen->len != ((dict->root != NULL) ? dict->root->subtree_keys : 0))) {
+		return 0;
+	}
+
+	/* Both directions visit the keys of the dictionary in order */
+	dict_node_t *head = (dict->root != NULL) ? dict_minimum(dict->root) : NULL;
+	size_t slot = frozen_dict_minimum(frozen);
+
+	for (; (head != NULL) && (slot != FROZEN_NIL); head = head->end->next, slot = frozen_dict_successor(frozen, slot)) {
+		long_values_t found = {.size = 0};
+		dict_foreach_value(head, collect_long, &found);
+
+		if ((compare_long(frozen_dict_key(frozen, slot), head->key) != 0) || (frozen_dict_count(frozen, slot) != head->count)) {
+			return 0;
+		}
+
+		for (size_t i = 0; (i < found.size) && (i < 16); ++i) {
+			if (*(const long *)frozen_dict_value(frozen, slot, i) != found.values[i]) {
+				return 0;
+			}
+		}
+	}
+
+	if ((head != NULL) || (slot != FROZEN_NIL)) {
+		return 0;
+	}
+
+	head = (dict->root != NULL) ? dict_maximum(dict->root) : NULL;
+	slot = frozen_dict_maximum(frozen);
+
+	for (; (head != NULL) && (slot != FROZEN_NIL); head = dict_predecessor(head), slot = frozen_dict_predecessor(frozen, slot)) {
+		if (compare_long(frozen_dict_key(frozen, slot), head->key) != 0) {
+			return 0;
+		}
+	}
+
+	if ((head != NULL) || (slot != FROZEN_NIL)) {
+		return 0;
+	}
+
+	/* Every key, every gap and both ends */
+	for (long key = -1; key <= 2 * (long)frozen->len + 1; ++key) {
+		dict_node_t *lower = dict_lower_bound(dict, &key);
+		dict_node_t *upper = dict_upper_bound(dict, &key);
+		size_t frozen_lower = frozen_dict_lower_bound(frozen, &key);
+		size_t frozen_upper = frozen_dict_upper_bound(frozen, &key);
+
+		if ((lower == NULL) != (frozen_lower == FROZEN_NIL) || (upper == NULL) != (frozen_upper == FROZEN_NIL)) {
+			return 0;
+		}
+
+		if ((lower != NULL) && (compare_long(lower->key, frozen_dict_key(frozen, frozen_lower)) != 0)) {
+			return 0;
+		}
+
+		if ((upper != NULL) && (compare_long(upper->key, frozen_dict_key(frozen, frozen_upper)) != 0)) {
+			return 0;
+		}
+
+		if ((dict_search(dict, dict->root, &key) != NULL) != (frozen_dict_search(frozen, &key) != FROZEN_NIL)) {
+			return 0;
+		}
+
+		long right = key + 5;
+
+		if (dict_count_range(dict, &key, &right) != frozen_dict_count_range(frozen, &key, &right)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+void test_frozen(void) {
+	FILE *fout = fopen("outputs/output_dict_frozen.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	/* Every shape of the last level, keys 0, 2, ... and a few duplicates */
+	uint8_t same = 1;
+
+	for (long len = 0; len <= 70; ++len) {
+		dict_t *dict = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+
+		for (long i = 0; i < len; ++i) {
+			long key = 2 * ((i * 37) % len);
+			long value = 10 * key;
+
+			dict_insert(dict, &key, &value);
+
+			if (i % 3 == 0) {
+				++value;
+				dict_insert(dict, &key, &value);
+			}
+		}
+
+		frozen_dict_t *frozen = dict_freeze(dict, sizeof(long), save_long, sizeof(long), save_long);
+
+		same &= (frozen != NULL) && (check_frozen(frozen, dict) == 1);
+
+		destroy_frozen_dict(frozen);
+		destroy_dict(dict);
+	}
+
+	ASSERT(fout, same == 1, "dict_frozen-01");
+
+	/* Value vectors, and a copy that does not follow the dictionary */
+	dict_t *dict = create_long_dict(0, 998, 2);
+	dict_t *vectors = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	dict_set_value_vectors(vectors);
+
+	for (long i = 0; i < 2000; ++i) {
+		long key = 2 * ((i * 7) % 500);
+		dict_insert(vectors, &key, &i);
+	}
+
+	frozen_dict_t *frozen = dict_freeze(vectors, sizeof(long), save_long, sizeof(long), save_long);
+	ASSERT(fout, (frozen != NULL) && (check_frozen(frozen, vectors) == 1), "dict_frozen-02");
+
+	long key = 14;
+	dict_delete(vectors, &key);
+	size_t slot = frozen_dict_search(frozen, &key);
+	ASSERT(fout, (frozen_dict_count(frozen, slot) == 4) && (*(const long *)frozen_dict_value(frozen, slot, 3) == 1501l), "dict_frozen-03");
+	ASSERT(fout, frozen_dict_value(frozen, slot, 4) == NULL, "dict_frozen-04");
+
+	/* The mapped image answers like the one in memory */
+	ASSERT(fout, frozen_dict_save(frozen, "outputs/dict_frozen.bin") == 1, "dict_frozen-05");
+	destroy_frozen_dict(frozen);
+	destroy_dict(vectors);
+
+	frozen = frozen_dict_map("outputs/dict_frozen.bin", compare_long);
+	ASSERT(fout, (frozen != NULL) && (frozen->is_mapped == 1), "dict_frozen-06");
+	ASSERT(fout, frozen_dict_count(frozen, frozen_dict_search(frozen, &key)) == 4, "dict_frozen-07");
+	destroy_frozen_dict(frozen);
+
+	frozen = dict_freeze(dict, sizeof(long), save_long, 0, NULL);
+	ASSERT(fout, (frozen != NULL) && (frozen_dict_value(frozen, frozen_dict_minimum(frozen), 0) == NULL), "dict_frozen-08");
+	frozen_dict_save(frozen, "outputs/dict_frozen.bin");
+	destroy_frozen_dict(frozen);
+
+	frozen = frozen_dict_map("outputs/dict_frozen.bin", compare_long);
+	ASSERT(fout, (frozen != NULL) && (frozen->len == 500) && (frozen->size == 500), "dict_frozen-09");
+	long left = 100, right = 199;
+	ASSERT(fout, frozen_dict_count_range(frozen, &left, &right) == 50, "dict_frozen-10");
+	destroy_frozen_dict(frozen);
+	destroy_dict(dict);
+
+	/* String keys in their inline form */
+	dict = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
+	build_dict_from_file("inputs/key.txt", dict);
+	frozen = dict_freeze(dict, ELEMENT_DICT_LENGTH + 1, inline_str_element, sizeof(int32_t), save_index_info);
+	ASSERT(fout, (frozen != NULL) && (frozen->len == dict->root->subtree_keys), "dict_frozen-11");
+
+	same = 1;
+
+	for (dict_node_t *head = dict_minimum(dict->root); head != NULL; head = head->end->next) {
+		slot = frozen_dict_search(frozen, head->key);
+		same &= (slot != FROZEN_NIL) && (frozen_dict_count(frozen, slot) == head->count);
+		same &= (*(const int32_t *)frozen_dict_value(frozen, slot, 0) == *(int32_t *)head->value);
+	}
+
+	ASSERT(fout, same == 1, "dict_frozen-12");
+	ASSERT(fout, dict_freeze(dict, 3, inline_str_element, sizeof(int32_t), save_index_info) == NULL, "dict_frozen-13");
+	destroy_frozen_dict(frozen);
+	destroy_dict(dict);
+
+	/* A cut image and a missing one */
+	ASSERT(fout, truncate("outputs/dict_frozen.bin", 200) == 0, "dict_frozen-14");
+	ASSERT(fout, frozen_dict_map("outputs/dict_frozen.bin", compare_long) == NULL, "dict_frozen-15");
+	ASSERT(fout, frozen_dict_map("outputs/missing_file.bin", compare_long) == NULL, "dict_frozen-16");
+
+	fprintf(fout, "\nAll tests for dict_frozen passed!\n");
+	fclose(fout);
+}
+
+int64_t check_btree_node(btree_dict_t *dict, btree_node_t *node, const void *low, const void *high, size_t *entries) {
+	if ((node != dict->root) && (node->len < BTREE_MIN_KEYS)) return -1;
+
+	/* The keys are in order and inside the bounds of the parent */
+	for (uint32_t i = 0; i < node->len; ++i) {
+		if ((i > 0) && (dict->cmp(node->keys[i - 1], node->keys[i]) >= 0)) return -1;
+		if ((low != NULL) && (dict->cmp(node->keys[i], low) < 0)) return -1;
+		if ((high != NULL) && (dict->cmp(node->keys[i], high) >= 0)) return -1;
+	}
+
+	if (node->is_leaf != 0) {
+		for (uint32_t i = 0; i < node->len; ++i) {
+			*entries += ((btree_leaf_t *)node)->entries[i].count;
+		}
+
+		/* The first key of a leaf is the separator on its left */
+		return ((low == NULL) || (node->keys[0] == low)) ? 1 : -1;
+	}
+
+	int64_t height = -1;
+
+	for (uint32_t i = 0; i <= node->len; ++i) {
+		const void *child_low = (i > 0) ? node->keys[i - 1] : low;
+		const void *child_high = (i < node->len) ? node->keys[i] : high;
+		int64_t child_height = check_btree_node(dict, ((btree_inner_t *)node)->children[i], child_low, child_high, entries);
+
+		if ((child_height < 0) || ((height >= 0) && (child_height != height))) return -1;
+
+		height = child_height;
+	}
+
+	return height + 1;
+}
+
+uint8_t check_btree(btree_dict_t *dict) {
+	size_t entries = 0;
+
+	if (dict->root == NULL) {
+		return (dict->size == 0) && (dict->height == 0);
+	}
+
+	int64_t height = check_btree_node(dict, dict->root, NULL, NULL, &entries);
+
+	return (height == (int64_t)dict->height) && (entries == dict->size);
+}
+
+void test_btree(void) {
+	FILE *fout = fopen("outputs/output_dict_btree.out", "w");
+
+	if (fout == NULL) {
+		printf("Error opening file!\n");
+		return;
+	}
+
+	btree_dict_t *dict = create_btree_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+	dict_t *avl = create_dict(create_long, destroy_long, create_long, destroy_long, compare_long);
+
+	ASSERT(fout, dict != NULL, "dict_btree-01");
+	ASSERT(fout, (btree_dict_minimum(dict).leaf == NULL) && (btree_dict_search(dict, &(long){0}).leaf == NULL), "dict_btree-02");
+
+	/* Enough keys for a few levels, with runs of duplicates */
+	for (long i = 0; i < 3000; ++i) {
+		long key = (i * 37) % 1000;
+		btree_dict_insert(dict, &key, &i);
+		dict_insert(avl, &key, &i);
+	}
+
+	ASSERT(fout, (dict->size == 3000) && (dict->height >= 3), "dict_btree-03");
+	ASSERT(fout, check_btree(dict) == 1, "dict_btree-04");
+
+	long key = 74;
+	btree_pos_t pos = btree_dict_search(dict, &key);
+	long_values_t found = {.size = 0};
+	btree_dict_foreach_value(pos, collect_long, &found);
+	ASSERT(fout, (btree_dict_count(pos) == 3) && (found.values[0] == 2l) && (found.values[1] == 1002l) && (found.values[2] == 2002l), "dict_btree-05");
+	ASSERT(fout, *(const long *)btree_dict_key(btree_dict_successor(pos)) == 75l, "dict_btree-06");
+	ASSERT(fout, *(const long *)btree_dict_key(btree_dict_predecessor(pos)) == 73l, "dict_btree-07");
+	ASSERT(fout, (*(const long *)btree_dict_key(btree_dict_minimum(dict)) == 0l) && (*(const long *)btree_dict_key(btree_dict_maximum(dict)) == 999l), "dict_btree-08");
+	ASSERT(fout, (btree_dict_predecessor(btree_dict_minimum(dict)).leaf == NULL) && (btree_dict_successor(btree_dict_maximum(dict)).leaf == NULL), "dict_btree-09");
+
+	/* Deletes take the last value first, like the AVL dictionary */
+	uint8_t same = 1;
+	uint32_t state = 11;
+
+	for (size_t i = 0; i < 2500; ++i) {
+		state = state * 1103515245u + 12345u;
+		key = (long)((state >> 8) % 1100);
+		btree_dict_delete(dict, &key);
+		dict_delete(avl, &key);
+	}
+
+	ASSERT(fout, (dict->size == avl->size) && (check_btree(dict) == 1), "dict_btree-10");
+
+	dict_node_t *head = (avl->root != NULL) ? dict_minimum(avl->root) : NULL;
+	pos = btree_dict_minimum(dict);
+
+	for (; (head != NULL) && (pos.leaf != NULL); head = head->end->next, pos = btree_dict_successor(pos)) {
+		long_values_t avl_values = {.size = 0};
+		dict_foreach_value(head, collect_long, &avl_values);
+		found.size = 0;
+		btree_dict_foreach_value(pos, collect_long, &found);
+
+		same &= (compare_long(btree_dict_key(pos), head->key) == 0) && (found.size == avl_values.size);
+		same &= (memcmp(found.values, avl_values.values, sizeof(long) * ((found.size < 16) ? found.size : 16)) == 0);
+	}
+
+	ASSERT(fout, (same == 1) && (head == NULL) && (pos.leaf == NULL), "dict_btree-11");
+
+	key = 500;
+	pos = btree_dict_lower_bound(dict, &key);
+	dict_node_t *lower = dict_lower_bound(avl, &key);
+	ASSERT(fout, (lower != NULL) && (compare_long(btree_dict_key(pos), lower->key) == 0), "dict_btree-12");
+
+	/* Every key goes, the tree shrinks back to nothing */
+	for (long i = 0; i < 1000; ++i) {
+		for (size_t count = btree_dict_count(btree_dict_search(dict, &i)); count > 0; --count) {
+			btree_dict_delete(dict, &i);
+		}
+	}
+
+	ASSERT(fout, (dict->root == NULL) && (check_btree(dict) == 1), "dict_btree-13");
+
+	btree_dict_insert(dict, &key, &key);
+	ASSERT(fout, (dict->size == 1) && (*(const long *)btree_dict_key(btree_dict_maximum(dict)) == 500l), "dict_btree-14");
+
+	destroy_btree_dict(dict);
+	destroy_dict(avl);
+
+	fprintf(fout, "\nAll tests for dict_btree passed!\n");
+	fclose(fout);
+}
+
 void test_free(dict_t **dict1, dict_t **dict2) {
 	if ((*dict1) != NULL && (*dict1)->root != NULL) {
 		destroy_dict_node((*dict1), (*dict1)->root->left->left);
@@ -677,6 +2944,29 @@ int main(void) {
 	test_list_insert(&dict2);
 	test_list_delete(&dict2);
 	test_free(&dict1, &dict2);
+	test_arena();
+	test_inline_keys();
+	test_bulk_load();
+	test_order_stats();
+	test_bounds();
+	test_typed();
+	test_compact();
+	test_value_vectors();
+	test_delete_successor();
+	test_concurrent();
+	test_persistent();
+	test_sharded();
+	test_parallel_build();
+	test_set_ops();
+	test_batch_ops();
+	test_tokenizer();
+	test_word_scanner();
+	test_cipher_kernels();
+	test_cipher_streams();
+	test_cipher_parallel();
+	test_save_load();
+	test_frozen();
+	test_btree();
 
 	dict_t *dict = NULL;
 	dict = create_dict(create_str_element, destroy_str_element, create_index_info, destroy_index_info, compare_str);
@@ -0,0 +1,781 @@
+#include "include/btree_dict.h"
+
+#define INNER(node) ((btree_inner_t *)(node))
+#define LEAF(node) ((btree_leaf_t *)(node))
+#define NO_POS ((btree_pos_t){NULL, 0})
+
+/**
+ * @brief Function to create a B+ tree dictionary object.
+ * 
+ * @param create_key Function to create a key object
+ * @param destroy_key Function to destroy a key object
+ * @param create_value Function to create a value object
+ * @param destroy_value Function to destroy a value object
+ * @param cmp Function two compare two keys
+ * @return btree_dict_t* pointer to an allocated B+ tree dictionary object or NULL
+ */
+btree_dict_t* create_btree_dict(create_func create_key, destroy_func destroy_key, create_func create_value, destroy_func destroy_value, compare_func cmp) {
+	/* Allocate the dictionary object */
+	btree_dict_t *new_dict = malloc(sizeof(*new_dict));
+
+	/* Check if dictionary was allocated successfully */
+	if (new_dict != NULL) {
+
+		/* Set default values for dictionary object */
+		new_dict->root = NULL;
+		new_dict->create_key = create_key;
+		new_dict->destroy_key = destroy_key;
+		new_dict->create_value = create_value;
+		new_dict->destroy_value = destroy_value;
+		new_dict->cmp = cmp;
+		new_dict->size = 0;
+		new_dict->height = 0;
+	}
+
+	return new_dict;
+}
+
+/**
+ * @brief Function to free all the values of a key
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @param entry pointer to the values of the key
+ */
+static void btree_entry_destroy_values(btree_dict_t *dict, btree_entry_t *entry) {
+	dict->destroy_value(entry->value);
+
+	for (size_t iter = 0; iter + 1 < entry->count; ++iter) {
+		dict->destroy_value(entry->dup_values[iter]);
+	}
+
+	free(entry->dup_values);
+}
+
+/**
+ * @brief Subroutine function of destroy_btree_dict, it frees a node
+ * with its sub-tree, the keys and the values of the leaves
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @param node pointer to the node to free
+ */
+static void btree_destroy_node(btree_dict_t *dict, btree_node_t *node) {
+	if (node->is_leaf != 0) {
+		for (uint32_t iter = 0; iter < node->len; ++iter) {
+			dict->destroy_key(node->keys[iter]);
+			btree_entry_destroy_values(dict, &LEAF(node)->entries[iter]);
+		}
+	} else {
+
+		/* The keys of an inner node are borrowed from the leaves */
+		for (uint32_t iter = 0; iter <= node->len; ++iter) {
+			btree_destroy_node(dict, INNER(node)->children[iter]);
+		}
+	}
+
+	free(node);
+}
+
+/**
+ * @brief Function to free all memory loaded for the B+ tree dictionary object
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ */
+void destroy_btree_dict(btree_dict_t *dict) {
+	/* Check if input data is valid */
+	if (dict == NULL) {
+		return;
+	}
+
+	if (dict->root != NULL) {
+		btree_destroy_node(dict, dict->root);
+	}
+
+	free(dict);
+}
+
+/**
+ * @brief Function to get the key found at a position
+ * 
+ * @param pos position of a key
+ * @return const void* pointer to the key location or NULL
+ */
+const void* btree_dict_key(btree_pos_t pos) {
+	return (pos.leaf != NULL) ? pos.leaf->base.keys[pos.idx] : NULL;
+}
+
+/**
+ * @brief Function to get the number of entries of the key found at a position
+ * 
+ * @param pos position of a key
+ * @return size_t number of entries with the key, 0 for no key
+ */
+size_t btree_dict_count(btree_pos_t pos) {
+	return (pos.leaf != NULL) ? pos.leaf->entries[pos.idx].count : 0;
+}
+
+/**
+ * @brief Function to visit the values of the key found at a position,
+ * in insertion order
+ * 
+ * @param pos position of a key
+ * @param visit Function to call for every value
+ * @param data pointer passed to every call of "visit"
+ */
+void btree_dict_foreach_value(btree_pos_t pos, value_visit_func visit, void *data) {
+	/* Check if input data is valid */
+	if ((pos.leaf == NULL) || (visit == NULL)) {
+		return;
+	}
+
+	btree_entry_t *entry = &pos.leaf->entries[pos.idx];
+
+	visit(entry->value, data);
+
+	for (size_t iter = 0; iter + 1 < entry->count; ++iter) {
+		visit(entry->dup_values[iter], data);
+	}
+}
+
+/**
+ * @brief Function to find the first key of a node that is not smaller
+ * than the input key, with a binary search over the packed keys
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @param node pointer to the node
+ * @param key pointer to a key location
+ * @return uint32_t index of the key found or the number of keys of the node
+ */
+static uint32_t btree_node_lower(btree_dict_t *dict, btree_node_t *node, const void *key) {
+	uint32_t low = 0, high = node->len;
+
+	while (low < high) {
+		uint32_t mid = (low + high) / 2;
+
+		if (dict->cmp(node->keys[mid], key) < 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/**
+ * @brief Function to find the child of an inner node that holds a key
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @param node pointer to the inner node
+ * @param key pointer to a key location
+ * @return uint32_t index of the child, the number of keys not greater than the input key
+ */
+static uint32_t btree_node_child(btree_dict_t *dict, btree_node_t *node, const void *key) {
+	uint32_t low = 0, high = node->len;
+
+	while (low < high) {
+		uint32_t mid = (low + high) / 2;
+
+		if (dict->cmp(node->keys[mid], key) <= 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/**
+ * @brief Function to find the leaf that holds a key, or would hold it
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @param key pointer to a key location
+ * @param path where to write the inner nodes on the way down, NULL if not needed
+ * @param dirs where to write the child taken in every inner node, NULL if not needed
+ * @return btree_leaf_t* pointer to the leaf or NULL for an empty dictionary
+ */
+static btree_leaf_t* btree_find_leaf(btree_dict_t *dict, const void *key, btree_node_t **path, uint32_t *dirs) {
+	btree_node_t *iter = dict->root;
+	size_t depth = 0;
+
+	while ((iter != NULL) && (iter->is_leaf == 0)) {
+		uint32_t child = btree_node_child(dict, iter, key);
+
+		if (path != NULL) {
+			path[depth] = iter;
+			dirs[depth] = child;
+		}
+
+		++depth;
+		iter = INNER(iter)->children[child];
+	}
+
+	return LEAF(iter);
+}
+
+/**
+ * @brief Function to search for a desired key
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @param key pointer to a key location
+ * @return btree_pos_t position of the key or a position with a NULL leaf
+ */
+btree_pos_t btree_dict_search(btree_dict_t *dict, const void *key) {
+	/* Check if the input data is valid */
+	if ((dict == NULL) || (key == NULL)) {
+		return NO_POS;
+	}
+
+	btree_leaf_t *leaf = btree_find_leaf(dict, key, NULL, NULL);
+
+	if (leaf == NULL) {
+		return NO_POS;
+	}
+
+	uint32_t idx = btree_node_lower(dict, &leaf->base, key);
+
+	if ((idx == leaf->base.len) || (dict->cmp(leaf->base.keys[idx], key) != 0)) {
+		return NO_POS;
+	}
+
+	return (btree_pos_t){leaf, idx};
+}
+
+/**
+ * @brief Function to find the first key that is not smaller than the input key
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @param key pointer to a key location
+ * @return btree_pos_t position of the key found or a position with a NULL leaf
+ */
+btree_pos_t btree_dict_lower_bound(btree_dict_t *dict, const void *key) {
+	/* Check if the input data is valid */
+	if ((dict == NULL) || (key == NULL)) {
+		return NO_POS;
+	}
+
+	btree_leaf_t *leaf = btree_find_leaf(dict, key, NULL, NULL);
+
+	if (leaf == NULL) {
+		return NO_POS;
+	}
+
+	uint32_t idx = btree_node_lower(dict, &leaf->base, key);
+
+	/* All the keys of the leaf are smaller, the next leaf starts with the answer */
+	if (idx == leaf->base.len) {
+		return (leaf->next != NULL) ? (btree_pos_t){leaf->next, 0} : NO_POS;
+	}
+
+	return (btree_pos_t){leaf, idx};
+}
+
+/**
+ * @brief Function to find the minimum key
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @return btree_pos_t position of the minimum key or a position with a NULL leaf
+ */
+btree_pos_t btree_dict_minimum(btree_dict_t *dict) {
+	if ((dict == NULL) || (dict->root == NULL)) {
+		return NO_POS;
+	}
+
+	btree_node_t *iter = dict->root;
+
+	while (iter->is_leaf == 0) {
+		iter = INNER(iter)->children[0];
+	}
+
+	return (btree_pos_t){LEAF(iter), 0};
+}
+
+/**
+ * @brief Function to find the maximum key
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @return btree_pos_t position of the maximum key or a position with a NULL leaf
+ */
+btree_pos_t btree_dict_maximum(btree_dict_t *dict) {
+	if ((dict == NULL) || (dict->root == NULL)) {
+		return NO_POS;
+	}
+
+	btree_node_t *iter = dict->root;
+
+	while (iter->is_leaf == 0) {
+		iter = INNER(iter)->children[iter->len];
+	}
+
+	return (btree_pos_t){LEAF(iter), iter->len - 1};
+}
+
+/**
+ * @brief Function to find the key that follows a key, the leaf links
+ * give it without going up the tree
+ * 
+ * @param pos position of a key
+ * @return btree_pos_t position of the successor key or a position with a NULL leaf
+ */
+btree_pos_t btree_dict_successor(btree_pos_t pos) {
+	if (pos.leaf == NULL) {
+		return NO_POS;
+	}
+
+	if (pos.idx + 1 < pos.leaf->base.len) {
+		return (btree_pos_t){pos.leaf, pos.idx + 1};
+	}
+
+	return (pos.leaf->next != NULL) ? (btree_pos_t){pos.leaf->next, 0} : NO_POS;
+}
+
+/**
+ * @brief Function to find the key before a key
+ * 
+ * @param pos position of a key
+ * @return btree_pos_t position of the predecessor key or a position with a NULL leaf
+ */
+btree_pos_t btree_dict_predecessor(btree_pos_t pos) {
+	if (pos.leaf == NULL) {
+		return NO_POS;
+	}
+
+	if (pos.idx > 0) {
+		return (btree_pos_t){pos.leaf, pos.idx - 1};
+	}
+
+	return (pos.leaf->prev != NULL) ? (btree_pos_t){pos.leaf->prev, pos.leaf->prev->base.len - 1} : NO_POS;
+}
+
+/**
+ * @brief Function to add a value at the end of the values of a key
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @param entry pointer to the values of the key
+ * @param value pointer to the value location
+ * @return uint8_t 1 if the value was added, 0 otherwise
+ */
+static uint8_t btree_entry_push_value(btree_dict_t *dict, btree_entry_t *entry, const void *value) {
+	/* The first value stays in the entry, the vector holds the others */
+	if (entry->count - 1 == entry->dup_capacity) {
+		size_t new_capacity = (entry->dup_capacity == 0) ? 1 : 2 * entry->dup_capacity;
+
+		void **new_values = realloc(entry->dup_values, sizeof(*new_values) * new_capacity);
+
+		if (new_values == NULL) {
+			return 0;
+		}
+
+		entry->dup_values = new_values;
+		entry->dup_capacity = new_capacity;
+	}
+
+	entry->dup_values[entry->count - 1] = dict->create_value(value);
+	++(entry->count);
+
+	return 1;
+}
+
+/**
+ * @brief Function to count the inner nodes a leaf split needs, one for
+ * every full node at the bottom of the path and one more for a new root
+ * 
+ * @param path inner nodes from the root to the parent of the split node
+ * @param depth number of nodes in the path
+ * @return size_t number of inner nodes to allocate
+ */
+static size_t btree_split_nodes(btree_node_t **path, size_t depth) {
+	size_t full = 0;
+
+	while ((full < depth) && (path[depth - 1 - full]->len == BTREE_NODE_KEYS)) {
+		++full;
+	}
+
+	return (full == depth) ? full + 1 : full;
+}
+
+/**
+ * @brief Function to add a separator key and its right child in the
+ * inner nodes of a path, splitting the full nodes from the bottom up.
+ * The nodes are allocated before, so the tree is never left half fixed.
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @param path inner nodes from the root to the parent of the split node
+ * @param dirs child taken in every inner node of the path
+ * @param depth number of nodes in the path
+ * @param sep pointer to the separator key, the first key of the right node
+ * @param right pointer to the new right node
+ * @param spares inner nodes counted by btree_split_nodes, in the order they are used
+ */
+static void btree_insert_separator(btree_dict_t *dict, btree_node_t **path, uint32_t *dirs, size_t depth, void *sep, btree_node_t *right, btree_inner_t **spares) {
+	while (depth > 0) {
+		--depth;
+
+		btree_node_t *node = path[depth];
+		uint32_t pos = dirs[depth];
+
+		/* There is room, shift the keys and the children after the position */
+		if (node->len < BTREE_NODE_KEYS) {
+			memmove(node->keys + pos + 1, node->keys + pos, sizeof(*node->keys) * (node->len - pos));
+			memmove(INNER(node)->children + pos + 2, INNER(node)->children + pos + 1, sizeof(*INNER(node)->children) * (node->len - pos));
+
+			node->keys[pos] = sep;
+			INNER(node)->children[pos + 1] = right;
+			++(node->len);
+
+			return;
+		}
+
+		btree_inner_t *new_inner = *(spares++);
+
+		/* Lay the keys and the children out with the new ones, then cut them in two */
+		void *keys[BTREE_NODE_KEYS + 1];
+		btree_node_t *children[BTREE_NODE_KEYS + 2];
+
+		memcpy(keys, node->keys, sizeof(*keys) * pos);
+		memcpy(keys + pos + 1, node->keys + pos, sizeof(*keys) * (BTREE_NODE_KEYS - pos));
+		keys[pos] = sep;
+
+		memcpy(children, INNER(node)->children, sizeof(*children) * (pos + 1));
+		memcpy(children + pos + 2, INNER(node)->children + pos + 1, sizeof(*children) * (BTREE_NODE_KEYS - pos));
+		children[pos + 1] = right;
+
+		/* The middle key goes up, it is in none of the halves */
+		uint32_t left_len = (BTREE_NODE_KEYS + 1) / 2;
+		uint32_t right_len = BTREE_NODE_KEYS - left_len;
+
+		memcpy(node->keys, keys, sizeof(*keys) * left_len);
+		memcpy(INNER(node)->children, children, sizeof(*children) * (left_len + 1));
+		node->len = left_len;
+
+		new_inner->base.is_leaf = 0;
+		new_inner->base.len = right_len;
+		memcpy(new_inner->base.keys, keys + left_len + 1, sizeof(*keys) * right_len);
+		memcpy(new_inner->children, children + left_len + 1, sizeof(*children) * (right_len + 1));
+
+		sep = keys[left_len];
+		right = &new_inner->base;
+	}
+
+	/* The root was split, the tree grows by one level */
+	btree_inner_t *new_root = *spares;
+
+	new_root->base.is_leaf = 0;
+	new_root->base.len = 1;
+	new_root->base.keys[0] = sep;
+	new_root->children[0] = dict->root;
+	new_root->children[1] = right;
+
+	dict->root = &new_root->base;
+	++(dict->height);
+}
+
+/**
+ * @brief Function to insert a new entry into the B+ tree dictionary object,
+ * a key that is already there gets the value after its other values
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @param key pointer to a key data
+ * @param value pointer to a value data
+ */
+void btree_dict_insert(btree_dict_t *dict, const void *key, const void *value) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (key == NULL)) {
+		return;
+	}
+
+	/* The first entry makes a root leaf */
+	if (dict->root == NULL) {
+		btree_leaf_t *new_leaf = calloc(1, sizeof(*new_leaf));
+
+		if (new_leaf == NULL) {
+			return;
+		}
+
+		new_leaf->base.is_leaf = 1;
+		dict->root = &new_leaf->base;
+		dict->height = 1;
+	}
+
+	btree_node_t *path[BTREE_MAX_HEIGHT];
+	uint32_t dirs[BTREE_MAX_HEIGHT];
+
+	btree_leaf_t *leaf = btree_find_leaf(dict, key, path, dirs);
+	uint32_t pos = btree_node_lower(dict, &leaf->base, key);
+
+	/* Same key, add to its values */
+	if ((pos < leaf->base.len) && (dict->cmp(leaf->base.keys[pos], key) == 0)) {
+		if (btree_entry_push_value(dict, &leaf->entries[pos], value) != 0) {
+			++(dict->size);
+		}
+
+		return;
+	}
+
+	btree_entry_t new_entry = {dict->create_value(value), NULL, 1, 0};
+	void *new_key = dict->create_key(key);
+
+	++(dict->size);
+
+	/* There is room, shift the keys after the position */
+	if (leaf->base.len < BTREE_NODE_KEYS) {
+		memmove(leaf->base.keys + pos + 1, leaf->base.keys + pos, sizeof(*leaf->base.keys) * (leaf->base.len - pos));
+		memmove(leaf->entries + pos + 1, leaf->entries + pos, sizeof(*leaf->entries) * (leaf->base.len - pos));
+
+		leaf->base.keys[pos] = new_key;
+		leaf->entries[pos] = new_entry;
+		++(leaf->base.len);
+
+		return;
+	}
+
+	/* Every node of the split is allocated before the tree changes */
+	btree_inner_t *spares[BTREE_MAX_HEIGHT + 1];
+	size_t spares_len = btree_split_nodes(path, dict->height - 1);
+	size_t allocated = 0;
+
+	btree_leaf_t *new_leaf = malloc(sizeof(*new_leaf));
+
+	while ((new_leaf != NULL) && (allocated < spares_len) && ((spares[allocated] = malloc(sizeof(**spares))) != NULL)) {
+		++allocated;
+	}
+
+	if ((new_leaf == NULL) || (allocated < spares_len)) {
+		for (size_t iter = 0; iter < allocated; ++iter) {
+			free(spares[iter]);
+		}
+
+		free(new_leaf);
+		dict->destroy_key(new_key);
+		dict->destroy_value(new_entry.value);
+		--(dict->size);
+		return;
+	}
+
+	/* Lay the entries out with the new one, then cut them in two */
+	void *keys[BTREE_NODE_KEYS + 1];
+	btree_entry_t entries[BTREE_NODE_KEYS + 1];
+
+	memcpy(keys, leaf->base.keys, sizeof(*keys) * pos);
+	memcpy(keys + pos + 1, leaf->base.keys + pos, sizeof(*keys) * (BTREE_NODE_KEYS - pos));
+	keys[pos] = new_key;
+
+	memcpy(entries, leaf->entries, sizeof(*entries) * pos);
+	memcpy(entries + pos + 1, leaf->entries + pos, sizeof(*entries) * (BTREE_NODE_KEYS - pos));
+	entries[pos] = new_entry;
+
+	uint32_t left_len = (BTREE_NODE_KEYS + 1) / 2;
+	uint32_t right_len = BTREE_NODE_KEYS + 1 - left_len;
+
+	memcpy(leaf->base.keys, keys, sizeof(*keys) * left_len);
+	memcpy(leaf->entries, entries, sizeof(*entries) * left_len);
+	leaf->base.len = left_len;
+
+	new_leaf->base.is_leaf = 1;
+	new_leaf->base.len = right_len;
+	memcpy(new_leaf->base.keys, keys + left_len, sizeof(*keys) * right_len);
+	memcpy(new_leaf->entries, entries + left_len, sizeof(*entries) * right_len);
+
+	/* Link the new leaf after the old one */
+	new_leaf->prev = leaf;
+	new_leaf->next = leaf->next;
+
+	if (leaf->next != NULL) {
+		leaf->next->prev = new_leaf;
+	}
+
+	leaf->next = new_leaf;
+
+	btree_insert_separator(dict, path, dirs, dict->height - 1, new_leaf->base.keys[0], &new_leaf->base, spares);
+}
+
+/**
+ * @brief Function to move the last key of the left sibling to the front
+ * of a node, through the separator of the parent for an inner node
+ * 
+ * @param parent pointer to the parent node
+ * @param idx index of the node in the parent
+ */
+static void btree_borrow_left(btree_node_t *parent, uint32_t idx) {
+	btree_node_t *node = INNER(parent)->children[idx];
+	btree_node_t *left = INNER(parent)->children[idx - 1];
+
+	memmove(node->keys + 1, node->keys, sizeof(*node->keys) * node->len);
+
+	if (node->is_leaf != 0) {
+		memmove(LEAF(node)->entries + 1, LEAF(node)->entries, sizeof(*LEAF(node)->entries) * node->len);
+
+		node->keys[0] = left->keys[left->len - 1];
+		LEAF(node)->entries[0] = LEAF(left)->entries[left->len - 1];
+		parent->keys[idx - 1] = node->keys[0];
+	} else {
+		memmove(INNER(node)->children + 1, INNER(node)->children, sizeof(*INNER(node)->children) * (node->len + 1));
+
+		node->keys[0] = parent->keys[idx - 1];
+		INNER(node)->children[0] = INNER(left)->children[left->len];
+		parent->keys[idx - 1] = left->keys[left->len - 1];
+	}
+
+	++(node->len);
+	--(left->len);
+}
+
+/**
+ * @brief Function to move the first key of the right sibling to the end
+ * of a node, through the separator of the parent for an inner node
+ * 
+ * @param parent pointer to the parent node
+ * @param idx index of the node in the parent
+ */
+static void btree_borrow_right(btree_node_t *parent, uint32_t idx) {
+	btree_node_t *node = INNER(parent)->children[idx];
+	btree_node_t *right = INNER(parent)->children[idx + 1];
+
+	if (node->is_leaf != 0) {
+		node->keys[node->len] = right->keys[0];
+		LEAF(node)->entries[node->len] = LEAF(right)->entries[0];
+
+		memmove(LEAF(right)->entries, LEAF(right)->entries + 1, sizeof(*LEAF(right)->entries) * (right->len - 1));
+		memmove(right->keys, right->keys + 1, sizeof(*right->keys) * (right->len - 1));
+
+		parent->keys[idx] = right->keys[0];
+	} else {
+		node->keys[node->len] = parent->keys[idx];
+		INNER(node)->children[node->len + 1] = INNER(right)->children[0];
+		parent->keys[idx] = right->keys[0];
+
+		memmove(INNER(right)->children, INNER(right)->children + 1, sizeof(*INNER(right)->children) * right->len);
+		memmove(right->keys, right->keys + 1, sizeof(*right->keys) * (right->len - 1));
+	}
+
+	++(node->len);
+	--(right->len);
+}
+
+/**
+ * @brief Function to merge the child of a parent that follows a separator
+ * into the child before it, and to remove the separator from the parent
+ * 
+ * @param parent pointer to the parent node
+ * @param sep index of the separator in the parent
+ */
+static void btree_merge(btree_node_t *parent, uint32_t sep) {
+	btree_node_t *left = INNER(parent)->children[sep];
+	btree_node_t *right = INNER(parent)->children[sep + 1];
+
+	if (left->is_leaf != 0) {
+		memcpy(left->keys + left->len, right->keys, sizeof(*right->keys) * right->len);
+		memcpy(LEAF(left)->entries + left->len, LEAF(right)->entries, sizeof(*LEAF(right)->entries) * right->len);
+
+		LEAF(left)->next = LEAF(right)->next;
+
+		if (LEAF(right)->next != NULL) {
+			LEAF(right)->next->prev = LEAF(left);
+		}
+	} else {
+
+		/* The separator comes down between the two halves */
+		left->keys[left->len] = parent->keys[sep];
+		++(left->len);
+
+		memcpy(left->keys + left->len, right->keys, sizeof(*right->keys) * right->len);
+		memcpy(INNER(left)->children + left->len, INNER(right)->children, sizeof(*INNER(right)->children) * (right->len + 1));
+	}
+
+	left->len += right->len;
+	free(right);
+
+	memmove(parent->keys + sep, parent->keys + sep + 1, sizeof(*parent->keys) * (parent->len - sep - 1));
+	memmove(INNER(parent)->children + sep + 1, INNER(parent)->children + sep + 2, sizeof(*INNER(parent)->children) * (parent->len - sep - 1));
+	--(parent->len);
+}
+
+/**
+ * @brief Function to delete one entry from the B+ tree dictionary, the
+ * last value of the key goes first. Nodes left with too few keys borrow
+ * one from a sibling or merge with it, from the leaf up to the root.
+ * 
+ * @param dict pointer to an allocated B+ tree dictionary object
+ * @param key pointer to a key data location to delete from dictionary
+ */
+void btree_dict_delete(btree_dict_t *dict, const void *key) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (key == NULL) || (dict->root == NULL)) {
+		return;
+	}
+
+	btree_node_t *path[BTREE_MAX_HEIGHT];
+	uint32_t dirs[BTREE_MAX_HEIGHT];
+
+	btree_leaf_t *leaf = btree_find_leaf(dict, key, path, dirs);
+	uint32_t pos = btree_node_lower(dict, &leaf->base, key);
+
+	if ((pos == leaf->base.len) || (dict->cmp(leaf->base.keys[pos], key) != 0)) {
+		return;
+	}
+
+	--(dict->size);
+
+	btree_entry_t *entry = &leaf->entries[pos];
+
+	/* Remove the last value of the key */
+	if (entry->count > 1) {
+		--(entry->count);
+		dict->destroy_value(entry->dup_values[entry->count - 1]);
+
+		return;
+	}
+
+	/* The inner nodes share the key objects of the leaves */
+	void *delete_key = leaf->base.keys[pos];
+
+	btree_entry_destroy_values(dict, entry);
+
+	memmove(leaf->base.keys + pos, leaf->base.keys + pos + 1, sizeof(*leaf->base.keys) * (leaf->base.len - pos - 1));
+	memmove(leaf->entries + pos, leaf->entries + pos + 1, sizeof(*leaf->entries) * (leaf->base.len - pos - 1));
+	--(leaf->base.len);
+
+	/* A separator is the smallest key on its right, so it is at most in one node of the path */
+	for (size_t depth = 0; (depth + 1 < dict->height) && (leaf->base.len > 0); ++depth) {
+		if ((dirs[depth] > 0) && (path[depth]->keys[dirs[depth] - 1] == delete_key)) {
+			path[depth]->keys[dirs[depth] - 1] = leaf->base.keys[0];
+			break;
+		}
+	}
+
+	dict->destroy_key(delete_key);
+
+	btree_node_t *node = &leaf->base;
+	size_t depth = dict->height - 1;
+
+	while ((depth > 0) && (node->len < BTREE_MIN_KEYS)) {
+		btree_node_t *parent = path[depth - 1];
+		uint32_t idx = dirs[depth - 1];
+
+		if ((idx > 0) && (INNER(parent)->children[idx - 1]->len > BTREE_MIN_KEYS)) {
+			btree_borrow_left(parent, idx);
+			break;
+		}
+
+		if ((idx < parent->len) && (INNER(parent)->children[idx + 1]->len > BTREE_MIN_KEYS)) {
+			btree_borrow_right(parent, idx);
+			break;
+		}
+
+		/* Both siblings are at the minimum, merge with one of them */
+		btree_merge(parent, (idx > 0) ? idx - 1 : idx);
+
+		node = parent;
+		--depth;
+	}
+
+	/* An empty root goes away */
+	if (dict->root->len == 0) {
+		btree_node_t *old_root = dict->root;
+
+		dict->root = (old_root->is_leaf != 0) ? NULL : INNER(old_root)->children[0];
+		--(dict->height);
+
+		free(old_root);
+	}
+}
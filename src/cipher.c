@@ -1,11 +1,128 @@
 #include "include/cipher.h"
+#include "include/cipher_kernels.h"
+#include "include/word_scanner.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #define INIT_LEN 1
 #define LETTER_LEN 26
-#define WORD_SEPARATOR ",.? \n\r"
+#define PARALLEL_MIN_CHUNK 4096
+#define STREAM_BUFFER_LEN (1024 * 1024)
+#define SCAN_SLICES_LEN 256
+#define CIPHER_BLOCK_LEN (64 * 1024)
+
+/**
+ * @brief Definition of the tokenizer state of build_dict_from_file. A word
+ * is copied in a small buffer to end it with a string terminator, so a
+ * word cut by the end of a block is completed by the next block.
+ * 
+ */
+typedef struct word_tokenizer_s {
+	dict_t *dict;							/* Dictionary to insert the words in */
+	char *word;								/* Growable buffer for the current word */
+	size_t word_len;						/* Number of characters in the buffer */
+	size_t word_capacity;					/* Number of characters the buffer can hold */
+	int32_t start_of_new_elem;				/* Number of letters before the current word */
+} word_tokenizer_t;
+
+/**
+ * @brief Function to add characters at the end of the word buffer
+ * 
+ * @param tokenizer pointer to a word_tokenizer_t object
+ * @param text pointer to the first character to add
+ * @param len number of characters to add
+ * @return uint8_t 1 if the characters were added, 0 otherwise
+ */
+static uint8_t word_tokenizer_append(word_tokenizer_t *tokenizer, const char *text, size_t len) {
+	/* Keep room for the string terminator */
+	if (tokenizer->word_len + len + 1 > tokenizer->word_capacity) {
+		size_t new_capacity = (tokenizer->word_capacity == 0) ? BUFFER_LEN : tokenizer->word_capacity;
+
+		while (tokenizer->word_len + len + 1 > new_capacity) {
+			new_capacity *= 2;
+		}
+
+		char *new_word = realloc(tokenizer->word, new_capacity);
+
+		if (new_word == NULL) {
+			return 0;
+		}
+
+		tokenizer->word = new_word;
+		tokenizer->word_capacity = new_capacity;
+	}
+
+	memcpy(tokenizer->word + tokenizer->word_len, text, len);
+	tokenizer->word_len += len;
+	tokenizer->word[tokenizer->word_len] = '\0';
+
+	return 1;
+}
+
+/**
+ * @brief Function to insert the word from the buffer in the dictionary
+ * 
+ * @param tokenizer pointer to a word_tokenizer_t object
+ */
+static void word_tokenizer_flush(word_tokenizer_t *tokenizer) {
+	if (tokenizer->word_len == 0) {
+		return;
+	}
+
+	dict_insert(tokenizer->dict, tokenizer->word, &tokenizer->start_of_new_elem);
+
+	tokenizer->start_of_new_elem += (int32_t)tokenizer->word_len;
+	tokenizer->word_len = 0;
+}
 
 /**
- * @brief Function to build a dictionary from an input file
+ * @brief Function to insert the words of a block of text in the dictionary,
+ * the last word of the block stays in the buffer until a separator is found
+ * 
+ * @param tokenizer pointer to a word_tokenizer_t object
+ * @param text pointer to the block
+ * @param len number of characters in the block
+ * @return uint8_t 1 if the block was loaded, 0 otherwise
+ */
+static uint8_t word_tokenizer_feed(word_tokenizer_t *tokenizer, const char *text, size_t len) {
+	word_slice_t slices[SCAN_SLICES_LEN];
+	size_t pos = 0;
+
+	/* The word from the previous block ends before this one */
+	if ((len != 0) && word_is_separator(text[0])) {
+		word_tokenizer_flush(tokenizer);
+	}
+
+	while (pos < len) {
+		size_t slices_len = word_scan(text, len, &pos, slices, SCAN_SLICES_LEN);
+
+		for (size_t iter = 0; iter < slices_len; ++iter) {
+			if (word_tokenizer_append(tokenizer, text + slices[iter].start, slices[iter].len) == 0) {
+				return 0;
+			}
+
+			/* The word goes on in the next block */
+			if (slices[iter].start + slices[iter].len == len) {
+				return 1;
+			}
+
+			word_tokenizer_flush(tokenizer);
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Function to build a dictionary from an input file. The file is
+ * mapped in memory and tokenized from the mapping, without a copy of every
+ * line. Files that can not be mapped are read in large blocks. A word can
+ * be as long as the file.
  * 
  * @param filename name of the file to open
  * @param dict a pointer to an allocated dictionary object
@@ -16,6 +133,193 @@ void build_dict_from_file(const char * const filename, dict_t *dict) {
 		return;
 	}
 
+	int fd = open(filename, O_RDONLY);
+
+	if (fd < 0) {
+		printf("Error on openning the file for reading\n");
+		return;
+	}
+
+	word_tokenizer_t tokenizer = {dict, NULL, 0, 0, 0};
+	struct stat file_stat;
+
+	char *text = MAP_FAILED;
+	size_t text_len = 0;
+
+	if ((fstat(fd, &file_stat) == 0) && S_ISREG(file_stat.st_mode) && (file_stat.st_size > 0)) {
+		text_len = (size_t)file_stat.st_size;
+
+		text = mmap(NULL, text_len, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+
+	if (text != MAP_FAILED) {
+		madvise(text, text_len, MADV_SEQUENTIAL);
+
+		word_tokenizer_feed(&tokenizer, text, text_len);
+
+		munmap(text, text_len);
+	} else {
+		char *block = malloc(STREAM_BUFFER_LEN);
+		ssize_t block_len = 0;
+
+		while ((block != NULL) && ((block_len = read(fd, block, STREAM_BUFFER_LEN)) > 0)) {
+			if (word_tokenizer_feed(&tokenizer, block, (size_t)block_len) == 0) {
+				break;
+			}
+		}
+
+		free(block);
+	}
+
+	/* The last word of the file */
+	word_tokenizer_flush(&tokenizer);
+
+	free(tokenizer.word);
+
+	close(fd);
+}
+
+/**
+ * @brief Definition of the part of the input file loaded by one thread
+ * 
+ */
+typedef struct build_chunk_s {
+	dict_t *dict;							/* Private dictionary of the thread */
+	char *start;							/* First character of the chunk */
+	char *end;								/* First character after the chunk */
+	int32_t offset;							/* Number of letters before the chunk */
+	int32_t letters;						/* Number of letters in the chunk */
+	dict_node_t *cursor;					/* Next entry to merge from the private dictionary */
+	uint8_t is_spawned;						/* 1 if a thread runs the pass, 0 if the caller did */
+} build_chunk_t;
+
+/**
+ * @brief Definition of the merge of the private dictionaries
+ * 
+ */
+typedef struct build_merge_s {
+	build_chunk_t *chunks;					/* Array of chunks */
+	size_t chunks_len;						/* Number of chunks */
+	compare_func cmp;						/* Function two compare two keys */
+} build_merge_t;
+
+/**
+ * @brief First pass of a loader thread, it ends every word of the chunk
+ * with a string terminator and counts the letters. A chunk starts with a
+ * separator or with the text, the first character is ended by the thread
+ * of the chunk, so the last word of the previous chunk is ended as well.
+ * 
+ * @param data pointer to the build_chunk_t object of the thread
+ * @return void* NULL
+ */
+static void* build_chunk_count(void *data) {
+	build_chunk_t *chunk = data;
+
+	word_slice_t slices[SCAN_SLICES_LEN];
+	size_t chunk_len = (size_t)(chunk->end - chunk->start);
+	size_t pos = 0;
+
+	chunk->letters = 0;
+
+	if ((chunk_len != 0) && word_is_separator(*chunk->start)) {
+		*chunk->start = '\0';
+	}
+
+	while (pos < chunk_len) {
+		size_t slices_len = word_scan(chunk->start, chunk_len, &pos, slices, SCAN_SLICES_LEN);
+
+		for (size_t iter = 0; iter < slices_len; ++iter) {
+			size_t word_end = slices[iter].start + slices[iter].len;
+
+			if (word_end < chunk_len) {
+				chunk->start[word_end] = '\0';
+			}
+
+			chunk->letters += (int32_t)slices[iter].len;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Second pass of a loader thread, it inserts the words of the chunk
+ * in the private dictionary, starting from the offset of the chunk
+ * 
+ * @param data pointer to the build_chunk_t object of the thread
+ * @return void* NULL
+ */
+static void* build_chunk_insert(void *data) {
+	build_chunk_t *chunk = data;
+
+	word_slice_t slices[SCAN_SLICES_LEN];
+	size_t chunk_len = (size_t)(chunk->end - chunk->start);
+	size_t pos = 0;
+
+	int32_t start_of_new_elem = chunk->offset;
+
+	while (pos < chunk_len) {
+		size_t slices_len = word_scan(chunk->start, chunk_len, &pos, slices, SCAN_SLICES_LEN);
+
+		for (size_t iter = 0; iter < slices_len; ++iter) {
+			dict_insert(chunk->dict, chunk->start + slices[iter].start, &start_of_new_elem);
+
+			start_of_new_elem += (int32_t)slices[iter].len;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Function to give the next pair of the K-way merge, the smallest
+ * key of all the private dictionaries. Equal keys come from the first
+ * chunk first, so the duplicates keep the order from the file.
+ * 
+ * @param stream pointer to a build_merge_t object
+ * @param key where to write the pointer to the key
+ * @param value where to write the pointer to the value
+ * @return uint8_t 1 if a pair was given, 0 at the end of the merge
+ */
+static uint8_t build_merge_next(void *stream, const void **key, const void **value) {
+	build_merge_t *merge = stream;
+	build_chunk_t *best = NULL;
+
+	for (size_t iter = 0; iter < merge->chunks_len; ++iter) {
+		build_chunk_t *chunk = merge->chunks + iter;
+
+		if ((chunk->cursor != NULL) && ((best == NULL) || (merge->cmp(chunk->cursor->key, best->cursor->key) < 0))) {
+			best = chunk;
+		}
+	}
+
+	if (best == NULL) {
+		return 0;
+	}
+
+	*key = best->cursor->key;
+	*value = best->cursor->value;
+	best->cursor = best->cursor->next;
+
+	return 1;
+}
+
+/**
+ * @brief Function to build a dictionary from an input file with several
+ * threads. The file is split at word separators, every thread loads its
+ * chunk in a private dictionary and the private dictionaries are merged.
+ * The result has the same entries as build_dict_from_file, in the same order.
+ * 
+ * @param filename name of the file to open
+ * @param dict a pointer to an allocated dictionary object
+ * @param threads number of threads, 0 for one per online processor
+ */
+void build_dict_from_file_parallel(const char * const filename, dict_t *dict, size_t threads) {
+	/* Check if input data is valid */
+	if((filename == NULL) || (dict == NULL)) {
+		return;
+	}
+
 	FILE *fin = NULL;
 
 	if ((fin = fopen(filename, "r")) == NULL) {
@@ -23,72 +327,374 @@ void build_dict_from_file(const char * const filename, dict_t *dict) {
 		return;
 	}
 
-	char *line_buff = malloc(BUFFER_LEN);
+	/* Read the whole file at once */
+	fseek(fin, 0, SEEK_END);
+	long file_len = ftell(fin);
+	fseek(fin, 0, SEEK_SET);
+
+	char *text = (file_len < 0) ? NULL : malloc((size_t)file_len + 1);
+
+	if ((text == NULL) || (fread(text, 1, (size_t)file_len, fin) != (size_t)file_len)) {
+		printf("Error on reading the file\n");
+		free(text);
+		fclose(fin);
+		return;
+	}
+
+	fclose(fin);
+
+	size_t text_len = (size_t)file_len;
+	text[text_len] = '\0';
+
+	if (threads == 0) {
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (online > 0) ? (size_t)online : 1;
+	}
+
+	/* Small files are not worth many threads */
+	if (threads > text_len / PARALLEL_MIN_CHUNK + 1) {
+		threads = text_len / PARALLEL_MIN_CHUNK + 1;
+	}
+
+	build_chunk_t *chunks = calloc(threads, sizeof(*chunks));
+	pthread_t *tids = malloc(sizeof(*tids) * threads);
+
+	if ((chunks == NULL) || (tids == NULL)) {
+		free(chunks);
+		free(tids);
+		free(text);
+		return;
+	}
+
+	/* Every chunk ends at a separator or at the end of the text */
+	size_t chunk_start = 0;
+
+	for (size_t iter = 0; iter < threads; ++iter) {
+		size_t chunk_end = (iter == threads - 1) ? text_len : text_len / threads * (iter + 1);
+
+		if (chunk_end < chunk_start) {
+			chunk_end = chunk_start;
+		}
+
+		while ((chunk_end < text_len) && !word_is_separator(text[chunk_end])) {
+			++chunk_end;
+		}
+
+		chunks[iter].start = text + chunk_start;
+		chunks[iter].end = text + chunk_end;
+		chunks[iter].dict = create_dict(dict->create_key, dict->destroy_key, dict->create_value, dict->destroy_value, dict->cmp);
+
+		/* The private dictionaries keep the node layout of the result */
+		if (chunks[iter].dict != NULL) {
+			dict_set_node_arena(chunks[iter].dict, 0, 0);
+
+			if ((dict->inline_key != NULL) && (dict_set_inline_keys(chunks[iter].dict, dict->inline_key_len, dict->inline_key) == 0)) {
+				destroy_dict(chunks[iter].dict);
+				chunks[iter].dict = NULL;
+			}
+		}
+
+		if (chunks[iter].dict == NULL) {
+			printf("Error on creating a private dictionary\n");
+
+			for (size_t prev = 0; prev < iter; ++prev) {
+				destroy_dict(chunks[prev].dict);
+			}
+
+			free(chunks);
+			free(tids);
+			free(text);
+			return;
+		}
+
+		chunk_start = chunk_end;
+	}
+
+	/* A chunk without a thread is done by the caller */
+	for (size_t iter = 0; iter < threads; ++iter) {
+		chunks[iter].is_spawned = (pthread_create(&tids[iter], NULL, build_chunk_count, &chunks[iter]) == 0);
+
+		if (chunks[iter].is_spawned == 0) {
+			build_chunk_count(&chunks[iter]);
+		}
+	}
+
+	for (size_t iter = 0; iter < threads; ++iter) {
+		if (chunks[iter].is_spawned != 0) {
+			pthread_join(tids[iter], NULL);
+		}
+	}
+
+	/* Prefix sum over the letters of the chunks */
 	int32_t start_of_new_elem = 0;
 
-	/* Read all the lines from the file */
-	while (fgets(line_buff, BUFFER_LEN, fin) != NULL) {
-		char *word = NULL, *save_ptr = NULL;
+	for (size_t iter = 0; iter < threads; ++iter) {
+		chunks[iter].offset = start_of_new_elem;
+		start_of_new_elem += chunks[iter].letters;
+	}
 
-		word = __strtok_r(line_buff, WORD_SEPARATOR, &save_ptr);
+	for (size_t iter = 0; iter < threads; ++iter) {
+		chunks[iter].is_spawned = (pthread_create(&tids[iter], NULL, build_chunk_insert, &chunks[iter]) == 0);
 
-		/* Extract all words from line and insert in dictionary */
-		while (word != NULL) {
-			dict_insert(dict, word, &start_of_new_elem);
+		if (chunks[iter].is_spawned == 0) {
+			build_chunk_insert(&chunks[iter]);
+		}
+	}
 
-			start_of_new_elem += (int32_t)strlen(word);
+	for (size_t iter = 0; iter < threads; ++iter) {
+		if (chunks[iter].is_spawned != 0) {
+			pthread_join(tids[iter], NULL);
+		}
+	}
+
+	for (size_t iter = 0; iter < threads; ++iter) {
+		chunks[iter].cursor = (chunks[iter].dict->root != NULL) ? dict_minimum(chunks[iter].dict->root) : NULL;
+	}
+
+	build_merge_t merge = {chunks, threads, dict->cmp};
 
-			word = __strtok_r(NULL, WORD_SEPARATOR, &save_ptr);
+	if (dict->root == NULL) {
+		dict_bulk_load_stream(dict, build_merge_next, &merge);
+	} else {
+		const void *key = NULL, *value = NULL;
+
+		/* The new entries go after the ones already in the dictionary */
+		while (build_merge_next(&merge, &key, &value) != 0) {
+			dict_insert(dict, key, value);
 		}
 	}
 
-	free(line_buff);
+	for (size_t iter = 0; iter < threads; ++iter) {
+		destroy_dict(chunks[iter].dict);
+	}
 
-	fclose(fin);
+	free(chunks);
+	free(tids);
+	free(text);
 }
 
 /**
- * @brief Function to encrypt a text message
+ * @brief Function to encrypt or decrypt a stream in large blocks,
+ * the key goes on from one block to the next
  * 
- * @param infile input file to read message
- * @param outfile output file to write message
+ * @param fin input stream to read message
+ * @param fout output stream to write message
  * @param key pointer to a range_t object representing ecryption key
+ * @param is_decrypt 1 to decrypt, 0 to encrypt
+ * @return uint8_t 1 if the whole message was written, 0 otherwise
  */
-void encrypt(const char * const infile, const char * const outfile, range_t *key) {
-	FILE *fin  = fopen(infile,  "r");
-	FILE *fout = fopen(outfile, "w");
+static uint8_t cipher_file(FILE *fin, FILE *fout, range_t *key, uint8_t is_decrypt) {
+	/* Check if input data is valid */
+	if ((fin == NULL) || (fout == NULL) || (key == NULL)) {
+		return 0;
+	}
 
-	if (fin == NULL) {
-		return;
+	cipher_key_t *prepared = create_cipher_key(key->index, key->size);
+	cipher_stream_t stream = {prepared, 0};
+	char *buff = malloc(STREAM_BUFFER_LEN);
+
+	if ((prepared == NULL) || (buff == NULL)) {
+		destroy_cipher_key(prepared);
+		free(buff);
+		return 0;
+	}
+
+	uint8_t is_done = 1;
+	size_t buff_size = 0;
+
+	while ((buff_size = fread(buff, 1, STREAM_BUFFER_LEN, fin)) != 0) {
+		if (is_decrypt != 0) {
+			cipher_decrypt_block(&stream, buff, buff_size);
+		} else {
+			cipher_encrypt_block(&stream, buff, buff_size);
+		}
+
+		if (fwrite(buff, 1, buff_size, fout) != buff_size) {
+			is_done = 0;
+			break;
+		}
 	}
 
-	char *buff = malloc(BUFFER_LEN + 1);
-	char c;
+	if (ferror(fin) || (fflush(fout) != 0)) {
+		is_done = 0;
+	}
 
-	size_t idx = 0;
+	free(buff);
+	destroy_cipher_key(prepared);
 
-	while (fgets(buff, BUFFER_LEN, fin) != NULL) {
-		size_t buff_size = strlen(buff);
+	return is_done;
+}
 
-		for (size_t iter = 0; iter < buff_size; ++iter) {
-			if ((buff[iter] != ' ') && (buff[iter] != '\n') && (buff[iter] != '\r')) {
-				c = ((toupper(buff[iter]) - 'A') + key->index[idx] % 26) % 26 + 'A';
-				++idx;
-			} else {
-			 	c = buff[iter];
+/**
+ * @brief Function to write a whole block to a file descriptor
+ * 
+ * @param fd file descriptor to write to
+ * @param buff pointer to the block
+ * @param len number of characters in the block
+ * @return uint8_t 1 if the block was written, 0 otherwise
+ */
+static uint8_t write_all(int fd, const char *buff, size_t len) {
+	while (len != 0) {
+		ssize_t written = write(fd, buff, len);
+
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
 			}
 
-			fprintf(fout, "%c", c);
+			return 0;
+		}
+
+		buff += written;
+		len -= (size_t)written;
+	}
+
+	return 1;
+}
 
-			if (idx == key->size) {
-				idx = 0;
+/**
+ * @brief Function to encrypt or decrypt from a file descriptor to
+ * another one in large blocks, pipes and sockets work as well
+ * 
+ * @param fd_in file descriptor to read message
+ * @param fd_out file descriptor to write message
+ * @param key pointer to a range_t object representing ecryption key
+ * @param is_decrypt 1 to decrypt, 0 to encrypt
+ * @return uint8_t 1 if the whole message was written, 0 otherwise
+ */
+static uint8_t cipher_fd(int fd_in, int fd_out, range_t *key, uint8_t is_decrypt) {
+	/* Check if input data is valid */
+	if ((fd_in < 0) || (fd_out < 0) || (key == NULL)) {
+		return 0;
+	}
+
+	cipher_key_t *prepared = create_cipher_key(key->index, key->size);
+	cipher_stream_t stream = {prepared, 0};
+	char *buff = malloc(STREAM_BUFFER_LEN);
+
+	if ((prepared == NULL) || (buff == NULL)) {
+		destroy_cipher_key(prepared);
+		free(buff);
+		return 0;
+	}
+
+	uint8_t is_done = 1;
+
+	while (is_done != 0) {
+		ssize_t buff_size = read(fd_in, buff, STREAM_BUFFER_LEN);
+
+		if (buff_size < 0) {
+			if (errno == EINTR) {
+				continue;
 			}
+
+			is_done = 0;
+			break;
 		}
+
+		if (buff_size == 0) {
+			break;
+		}
+
+		if (is_decrypt != 0) {
+			cipher_decrypt_block(&stream, buff, (size_t)buff_size);
+		} else {
+			cipher_encrypt_block(&stream, buff, (size_t)buff_size);
+		}
+
+		is_done = write_all(fd_out, buff, (size_t)buff_size);
 	}
 
 	free(buff);
+	destroy_cipher_key(prepared);
+
+	return is_done;
+}
+
+/**
+ * @brief Function to encrypt or decrypt a file in place. The file is
+ * mapped in memory and shifted in the mapping, the pages are written
+ * back by the kernel without a copy through a buffer.
+ * 
+ * @param filename name of the file to change
+ * @param key pointer to a range_t object representing ecryption key
+ * @param is_decrypt 1 to decrypt, 0 to encrypt
+ * @return uint8_t 1 if the file was changed, 0 otherwise
+ */
+static uint8_t cipher_in_place(const char * const filename, range_t *key, uint8_t is_decrypt) {
+	/* Check if input data is valid */
+	if ((filename == NULL) || (key == NULL)) {
+		return 0;
+	}
+
+	cipher_key_t *prepared = create_cipher_key(key->index, key->size);
+	cipher_stream_t stream = {prepared, 0};
+
+	if (prepared == NULL) {
+		return 0;
+	}
+
+	int fd = open(filename, O_RDWR);
+	struct stat file_stat;
+
+	if ((fd < 0) || (fstat(fd, &file_stat) != 0) || !S_ISREG(file_stat.st_mode)) {
+		if (fd >= 0) {
+			close(fd);
+		}
+
+		destroy_cipher_key(prepared);
+		return 0;
+	}
+
+	uint8_t is_done = 1;
+	size_t text_len = (size_t)file_stat.st_size;
+
+	if (text_len != 0) {
+		char *text = mmap(NULL, text_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+		if (text != MAP_FAILED) {
+			madvise(text, text_len, MADV_SEQUENTIAL);
+
+			if (is_decrypt != 0) {
+				cipher_decrypt_block(&stream, text, text_len);
+			} else {
+				cipher_encrypt_block(&stream, text, text_len);
+			}
+
+			munmap(text, text_len);
+		} else {
+			is_done = 0;
+		}
+	}
+
+	close(fd);
+	destroy_cipher_key(prepared);
+
+	return is_done;
+}
+
+/**
+ * @brief Function to encrypt a text message
+ * 
+ * @param infile input file to read message
+ * @param outfile output file to write message
+ * @param key pointer to a range_t object representing ecryption key
+ */
+void encrypt(const char * const infile, const char * const outfile, range_t *key) {
+	FILE *fin  = fopen(infile,  "r");
+
+	if (fin == NULL) {
+		return;
+	}
+
+	FILE *fout = fopen(outfile, "w");
+
+	if (fout != NULL) {
+		cipher_file(fin, fout, key, 0);
+		fclose(fout);
+	}
+
 	fclose(fin);
-	fclose(fout);
 }
 
 /**
@@ -99,203 +705,443 @@ void encrypt(const char * const infile, const char * const outfile, range_t *key
  * @param key pointer to a range_t object representing ecryption key
  */
 void decrypt(const char * const infile, const char * const outfile, range_t *key) {
- 	
 	FILE *fin  = fopen(infile,  "r");
-	FILE *fout = fopen(outfile, "w");
 
 	if (fin == NULL) {
 		return;
 	}
 
-	char *buff = malloc(BUFFER_LEN + 1);
-	char c;
+	FILE *fout = fopen(outfile, "w");
 
-	size_t idx = 0;
+	if (fout != NULL) {
+		cipher_file(fin, fout, key, 1);
+		fclose(fout);
+	}
 
-	while (fgets(buff, BUFFER_LEN, fin) != NULL) {
-		size_t buff_size = strlen(buff);
+	fclose(fin);
+}
 
-		for (size_t iter = 0; iter < buff_size; ++iter) {
-			if ((buff[iter] != ' ') && (buff[iter] != '\n') && (buff[iter] != '\r')) {
-				c = ((toupper(buff[iter]) - 'A') - (key->index[idx] % 26) + 26) % 26 + 'A';
-				++idx;
-			} else {
-			 	c = buff[iter];
-			}
+/**
+ * @brief Function to encrypt a text message from a stream to another one
+ * 
+ * @param fin input stream to read message, like stdin
+ * @param fout output stream to write message, like stdout
+ * @param key pointer to a range_t object representing ecryption key
+ * @return uint8_t 1 if the whole message was written, 0 otherwise
+ */
+uint8_t encrypt_stream(FILE *fin, FILE *fout, range_t *key) {
+	return cipher_file(fin, fout, key, 0);
+}
 
-			fprintf(fout, "%c", c);
+/**
+ * @brief Function to decrypt a text message from a stream to another one
+ * 
+ * @param fin input stream to read message, like stdin
+ * @param fout output stream to write message, like stdout
+ * @param key pointer to a range_t object representing ecryption key
+ * @return uint8_t 1 if the whole message was written, 0 otherwise
+ */
+uint8_t decrypt_stream(FILE *fin, FILE *fout, range_t *key) {
+	return cipher_file(fin, fout, key, 1);
+}
 
-			if (idx == key->size) {
-				idx = 0;
-			}
-		}
-	}
+/**
+ * @brief Function to encrypt a text message from a file descriptor to another one
+ * 
+ * @param fd_in file descriptor to read message, like STDIN_FILENO
+ * @param fd_out file descriptor to write message, like STDOUT_FILENO
+ * @param key pointer to a range_t object representing ecryption key
+ * @return uint8_t 1 if the whole message was written, 0 otherwise
+ */
+uint8_t encrypt_fd(int fd_in, int fd_out, range_t *key) {
+	return cipher_fd(fd_in, fd_out, key, 0);
+}
 
-	free(buff);
-	fclose(fin);
-	fclose(fout);
+/**
+ * @brief Function to decrypt a text message from a file descriptor to another one
+ * 
+ * @param fd_in file descriptor to read message, like STDIN_FILENO
+ * @param fd_out file descriptor to write message, like STDOUT_FILENO
+ * @param key pointer to a range_t object representing ecryption key
+ * @return uint8_t 1 if the whole message was written, 0 otherwise
+ */
+uint8_t decrypt_fd(int fd_in, int fd_out, range_t *key) {
+	return cipher_fd(fd_in, fd_out, key, 1);
 }
 
 /**
- * @brief Function to print an encrypted key
+ * @brief Function to encrypt a text message in its own file
  * 
- * @param filename name of the file to write key
- * @param key range_t object key to print
+ * @param filename name of the file to encrypt
+ * @param key pointer to a range_t object representing ecryption key
+ * @return uint8_t 1 if the file was encrypted, 0 otherwise
  */
-void print_key(const char * const filename, range_t *key) {
-	FILE *fin = fopen(filename, "w");
+uint8_t encrypt_in_place(const char * const filename, range_t *key) {
+	return cipher_in_place(filename, key, 0);
+}
 
-	if (key == NULL) {
-		fprintf(fin, "No key provided!\n");
-		fclose(fin);
+/**
+ * @brief Function to decrypt a text message in its own file
+ * 
+ * @param filename name of the file to decrypt
+ * @param key pointer to a range_t object representing ecryption key
+ * @return uint8_t 1 if the file was decrypted, 0 otherwise
+ */
+uint8_t decrypt_in_place(const char * const filename, range_t *key) {
+	return cipher_in_place(filename, key, 1);
+}
 
-		return;
-	}
+/**
+ * @brief Definition of the part of the message shifted by one thread
+ * 
+ */
+typedef struct cipher_chunk_s {
+	const char *in;							/* First character of the chunk in the input */
+	char *out;								/* First character of the chunk in the output */
+	size_t len;								/* Number of characters in the chunk */
+	size_t letters;							/* Number of characters that move the key */
+	cipher_stream_t stream;					/* Key stream that starts at the chunk */
+	uint8_t is_decrypt;						/* 1 to decrypt, 0 to encrypt */
+	uint8_t is_spawned;						/* 1 if a thread runs the pass, 0 if the caller did */
+} cipher_chunk_t;
 
-	fprintf(fin, "Decryption key of length %lu is:\n", key->size);
+/**
+ * @brief First pass of a cipher thread, it counts the characters of
+ * the chunk that move the key
+ * 
+ * @param data pointer to the cipher_chunk_t object of the thread
+ * @return void* NULL
+ */
+static void* cipher_chunk_count(void *data) {
+	cipher_chunk_t *chunk = data;
 
-	for (size_t iter = 0; iter < key->size; ++iter) {
-		fprintf(fin, "%d ", key->index[iter] % 26);
+	chunk->letters = cipher_count_block(chunk->in, chunk->len);
 
-		if ((iter + 1) % 10 == 0) {
-			fprintf(fin, "\n");
+	return NULL;
+}
+
+/**
+ * @brief Second pass of a cipher thread, it copies the chunk in the
+ * output and shifts it, one cache sized block at a time
+ * 
+ * @param data pointer to the cipher_chunk_t object of the thread
+ * @return void* NULL
+ */
+static void* cipher_chunk_shift(void *data) {
+	cipher_chunk_t *chunk = data;
+
+	for (size_t done = 0; done < chunk->len; done += CIPHER_BLOCK_LEN) {
+		size_t block_len = (chunk->len - done < CIPHER_BLOCK_LEN) ? chunk->len - done : CIPHER_BLOCK_LEN;
+
+		if (chunk->out != chunk->in) {
+			memcpy(chunk->out + done, chunk->in + done, block_len);
+		}
+
+		if (chunk->is_decrypt != 0) {
+			cipher_decrypt_block(&chunk->stream, chunk->out + done, block_len);
+		} else {
+			cipher_encrypt_block(&chunk->stream, chunk->out + done, block_len);
 		}
 	}
 
-	fclose(fin);
+	return NULL;
 }
 
 /**
- * @brief Function to find the inorder key range
+ * @brief Function to shift a mapped message with several threads. The
+ * threads count the characters that move the key in their chunk, a prefix
+ * sum gives the key position at the start of every chunk and the threads
+ * shift their chunk at the same time.
  * 
- * @param dict pointer to an allocated dictionary object
- * @return range_t* the inorder key range
+ * @param in pointer to the message
+ * @param out pointer to the output, it can be the message itself
+ * @param len number of characters in the message
+ * @param stream pointer to the key stream of the message
+ * @param threads number of threads, 0 for one per online processor
+ * @param is_decrypt 1 to decrypt, 0 to encrypt
+ * @return uint8_t 1 if the message was shifted, 0 otherwise
  */
-range_t* inorder_key_query(dict_t *dict) {
-	if ((dict == NULL) || (dict->root == NULL)) {
-		return NULL;
+static uint8_t cipher_chunks(const char *in, char *out, size_t len, cipher_stream_t *stream, size_t threads, uint8_t is_decrypt) {
+	if (threads == 0) {
+		long online = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (online > 0) ? (size_t)online : 1;
 	}
 
-	range_t *new_range = malloc(sizeof(*new_range));
+	/* Small files are not worth many threads */
+	if (threads > len / PARALLEL_MIN_CHUNK + 1) {
+		threads = len / PARALLEL_MIN_CHUNK + 1;
+	}
 
-	if (new_range != NULL) {
-		new_range->capacity = INIT_LEN;
-		new_range->size = 0;
+	cipher_chunk_t *chunks = calloc(threads, sizeof(*chunks));
+	pthread_t *tids = malloc(sizeof(*tids) * threads);
 
-		new_range->index = malloc(sizeof(*new_range->index) * new_range->capacity);
+	if ((chunks == NULL) || (tids == NULL)) {
+		free(chunks);
+		free(tids);
+		return 0;
+	}
 
-		if (new_range->index != NULL) {
-			dict_node_t *min_node = dict_minimum(dict->root);
+	/* The key does not care about words, any cut works */
+	for (size_t iter = 0; iter < threads; ++iter) {
+		size_t chunk_start = len / threads * iter;
+		size_t chunk_end = (iter == threads - 1) ? len : len / threads * (iter + 1);
 
-			while (min_node != NULL) {
-				if (new_range->size == new_range->capacity) {
-					new_range->capacity *= 2;
-					
-					new_range->index = realloc(new_range->index, sizeof(*new_range->index) * new_range->capacity);
-					
-					if (new_range->index == NULL) {
-						printf("Error at realloc\n");
-						exit(EXIT_FAILURE);
-					}
-				}
-
-				new_range->index[new_range->size] = (*(int32_t *)min_node->value) % LETTER_LEN;
-
-				++(new_range->size);
-
-				min_node = min_node->next;
-			}
+		chunks[iter].in = in + chunk_start;
+		chunks[iter].out = out + chunk_start;
+		chunks[iter].len = chunk_end - chunk_start;
+		chunks[iter].is_decrypt = is_decrypt;
+	}
+
+	/* A chunk without a thread is done by the caller */
+	for (size_t iter = 0; iter < threads; ++iter) {
+		chunks[iter].is_spawned = (pthread_create(&tids[iter], NULL, cipher_chunk_count, &chunks[iter]) == 0);
+
+		if (chunks[iter].is_spawned == 0) {
+			cipher_chunk_count(&chunks[iter]);
 		}
 	}
 
-	return new_range;
+	for (size_t iter = 0; iter < threads; ++iter) {
+		if (chunks[iter].is_spawned != 0) {
+			pthread_join(tids[iter], NULL);
+		}
+	}
+
+	/* Prefix sum over the characters that move the key */
+	size_t key_idx = stream->idx;
+
+	for (size_t iter = 0; iter < threads; ++iter) {
+		chunks[iter].stream = *stream;
+		chunks[iter].stream.idx = key_idx;
+
+		key_idx = (key_idx + chunks[iter].letters % stream->key->size) % stream->key->size;
+	}
+
+	for (size_t iter = 0; iter < threads; ++iter) {
+		chunks[iter].is_spawned = (pthread_create(&tids[iter], NULL, cipher_chunk_shift, &chunks[iter]) == 0);
+
+		if (chunks[iter].is_spawned == 0) {
+			cipher_chunk_shift(&chunks[iter]);
+		}
+	}
+
+	for (size_t iter = 0; iter < threads; ++iter) {
+		if (chunks[iter].is_spawned != 0) {
+			pthread_join(tids[iter], NULL);
+		}
+	}
+
+	stream->idx = key_idx;
+
+	free(chunks);
+	free(tids);
+
+	return 1;
 }
 
 /**
- * @brief Function to find how many nodes with the same key 
- * exists in the dictionary.
+ * @brief Function to encrypt or decrypt a file with several threads,
+ * both files are mapped in memory
  * 
- * @param dict pointer to an allocated dictionary object
- * @param start_node node to start counting the same nodes
- * @return int32_t the frequency of the start node
+ * @param infile input file to read message
+ * @param outfile output file to write message, NULL or the input file to change it in place
+ * @param key pointer to a range_t object representing ecryption key
+ * @param threads number of threads, 0 for one per online processor
+ * @param is_decrypt 1 to decrypt, 0 to encrypt
+ * @return uint8_t 1 if the whole message was written, 0 otherwise
  */
-static int32_t dict_node_freq(dict_t *dict, dict_node_t *start_node) {
-	if (start_node == NULL) {
+static uint8_t cipher_parallel(const char * const infile, const char * const outfile, range_t *key, size_t threads, uint8_t is_decrypt) {
+	/* Check if input data is valid */
+	if ((infile == NULL) || (key == NULL)) {
+		return 0;
+	}
+
+	struct stat in_stat, out_stat;
+
+	if ((stat(infile, &in_stat) != 0) || !S_ISREG(in_stat.st_mode)) {
 		return 0;
 	}
 
-	dict_node_t *iter = start_node;
+	uint8_t is_in_place = (outfile == NULL);
+
+	/* Opening the input as the output would truncate it */
+	if ((is_in_place == 0) && (stat(outfile, &out_stat) == 0) &&
+		(out_stat.st_dev == in_stat.st_dev) && (out_stat.st_ino == in_stat.st_ino)) {
+		is_in_place = 1;
+	}
 
-	int32_t node_freq = 0;
+	cipher_key_t *prepared = create_cipher_key(key->index, key->size);
+	cipher_stream_t stream = {prepared, 0};
 
-	while ((iter != NULL) && (dict->cmp(iter->key, start_node->key) == 0)) {
-		++node_freq;
-		iter = iter->next;
+	if (prepared == NULL) {
+		return 0;
 	}
 
-	return node_freq;
+	int fd_in = open(infile, (is_in_place != 0) ? O_RDWR : O_RDONLY);
+	int fd_out = (is_in_place != 0) ? fd_in : open(outfile, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	uint8_t is_done = 0;
+	size_t text_len = (size_t)in_stat.st_size;
+
+	if ((fd_in >= 0) && (fd_out >= 0)) {
+		if (text_len == 0) {
+			is_done = 1;
+		} else if ((fd_out == fd_in) || (ftruncate(fd_out, (off_t)text_len) == 0)) {
+			char *out = mmap(NULL, text_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd_out, 0);
+			char *in = (fd_out == fd_in) ? out : mmap(NULL, text_len, PROT_READ, MAP_PRIVATE, fd_in, 0);
+
+			if ((out != MAP_FAILED) && (in != MAP_FAILED)) {
+				is_done = cipher_chunks(in, out, text_len, &stream, threads, is_decrypt);
+			}
+
+			if ((in != MAP_FAILED) && (in != out)) {
+				munmap(in, text_len);
+			}
+
+			if (out != MAP_FAILED) {
+				munmap(out, text_len);
+			}
+		}
+	}
+
+	if ((fd_out >= 0) && (fd_out != fd_in)) {
+		close(fd_out);
+	}
+
+	if (fd_in >= 0) {
+		close(fd_in);
+	}
+
+	destroy_cipher_key(prepared);
+
+	return is_done;
 }
 
 /**
- * @brief Function to find the dictionary node with the maximum frequency
+ * @brief Function to encrypt a text message with several threads, the
+ * output is the same as the one from encrypt
  * 
- * @param dict pointer to an allocated dictionary object
- * @return dict_node_t* the maximum frequency node or NULL
+ * @param infile input file to read message
+ * @param outfile output file to write message, NULL to encrypt the input file in place
+ * @param key pointer to a range_t object representing ecryption key
+ * @param threads number of threads, 0 for one per online processor
+ * @return uint8_t 1 if the whole message was written, 0 otherwise
  */
-static dict_node_t* get_dict_max_freq_node(dict_t *dict) {
-	if ((dict == NULL) || (dict->root == NULL)) {
-		return NULL;
-	}
+uint8_t encrypt_parallel(const char * const infile, const char * const outfile, range_t *key, size_t threads) {
+	return cipher_parallel(infile, outfile, key, threads, 0);
+}
 
-	dict_node_t *min_node = dict_minimum(dict->root);
+/**
+ * @brief Function to decrypt a text message with several threads, the
+ * output is the same as the one from decrypt
+ * 
+ * @param infile input file to read message
+ * @param outfile output file to write message, NULL to decrypt the input file in place
+ * @param key pointer to a range_t object representing ecryption key
+ * @param threads number of threads, 0 for one per online processor
+ * @return uint8_t 1 if the whole message was written, 0 otherwise
+ */
+uint8_t decrypt_parallel(const char * const infile, const char * const outfile, range_t *key, size_t threads) {
+	return cipher_parallel(infile, outfile, key, threads, 1);
+}
 
-	dict_node_t *max_freq_node = NULL;
+/**
+ * @brief Function to print an encrypted key
+ * 
+ * @param filename name of the file to write key
+ * @param key range_t object key to print
+ */
+void print_key(const char * const filename, range_t *key) {
+	FILE *fin = fopen(filename, "w");
+
+	if (key == NULL) {
+		fprintf(fin, "No key provided!\n");
+		fclose(fin);
+
+		return;
+	}
 
-	int32_t max_freq = -1;
+	fprintf(fin, "Decryption key of length %lu is:\n", key->size);
 
-	while (min_node != NULL) {
-		int32_t node_freq = dict_node_freq(dict, min_node);
+	for (size_t iter = 0; iter < key->size; ++iter) {
+		fprintf(fin, "%d ", key->index[iter] % 26);
 
-		if (node_freq >= max_freq) {
-			max_freq_node = min_node;
-			max_freq = node_freq;
+		if ((iter + 1) % 10 == 0) {
+			fprintf(fin, "\n");
 		}
+	}
 
-		min_node = min_node->end->next;
+	fclose(fin);
+}
+
+/**
+ * @brief Function to add a value at the end of a key range
+ * 
+ * @param value pointer to the value location
+ * @param range pointer to an allocated range_t object
+ */
+static void range_push_value(void *value, void *data) {
+	range_t *range = data;
+
+	if (range->size == range->capacity) {
+		range->capacity *= 2;
+
+		range->index = realloc(range->index, sizeof(*range->index) * range->capacity);
+
+		if (range->index == NULL) {
+			printf("Error at realloc\n");
+			exit(EXIT_FAILURE);
+		}
 	}
 
-	return max_freq_node;
+	range->index[range->size] = (*(int32_t *)value) % LETTER_LEN;
+
+	++(range->size);
+}
+
+/**
+ * @brief Function to add all the duplicates of a key
+ * at the end of a key range
+ * 
+ * @param node pointer to the head of the key list
+ * @param range pointer to an allocated range_t object
+ */
+static void range_push_key(dict_node_t *node, void *range) {
+	dict_foreach_value(node, range_push_value, range);
 }
 
 /**
- * @brief Function to get the level of a key node
+ * @brief Function to find the inorder key range
  * 
  * @param dict pointer to an allocated dictionary object
- * @param key pointer to key location to find its level
- * @return int32_t level of the key node object
+ * @return range_t* the inorder key range
  */
-int32_t get_dict_node_level(dict_t *dict, const void *key) {
+range_t* inorder_key_query(dict_t *dict) {
 	if ((dict == NULL) || (dict->root == NULL)) {
-		return 0;
+		return NULL;
 	}
 
-	int32_t node_level = 1;
+	range_t *new_range = malloc(sizeof(*new_range));
+
+	if (new_range != NULL) {
+		new_range->capacity = INIT_LEN;
+		new_range->size = 0;
+
+		new_range->index = malloc(sizeof(*new_range->index) * new_range->capacity);
 
-	dict_node_t *iter = dict->root;
+		if (new_range->index != NULL) {
+			dict_node_t *min_node = dict_minimum(dict->root);
 
-	while (iter != NULL) {
-		if (dict->cmp(iter->key, key) > 0) {
-			++node_level;
-			iter = iter->left;
-		} else if (dict->cmp(iter->key, key) < 0) {
-			++node_level;
-			iter = iter->right;
-		} else {
-			return node_level;
+			/* Add every key with all its duplicates */
+			while (min_node != NULL) {
+				range_push_key(min_node, new_range);
+
+				min_node = min_node->end->next;
+			}
 		}
 	}
 
-	return 0;
+	return new_range;
 }
 
 /**
@@ -318,32 +1164,10 @@ range_t* level_key_query(dict_t *dict) {
 		new_range->index = malloc(sizeof(*new_range->index) * new_range->capacity);
 
 		if (new_range->index != NULL) {
-			int32_t level_of_max_node = get_dict_node_level(dict, get_dict_max_freq_node(dict)->key);
+			size_t level_of_max_node = dict_node_level(dict_most_frequent(dict));
 
-			dict_node_t *min_node = dict_minimum(dict->root);
-
-			while (min_node != NULL) {
-				if (get_dict_node_level(dict, min_node->key) != level_of_max_node) {
-					min_node = min_node->end->next;
-				} else {
-					if (new_range->size == new_range->capacity) {
-						new_range->capacity *= 2;
-				
-						new_range->index = realloc(new_range->index, sizeof(*new_range->index) * new_range->capacity);
-					
-						if (new_range->index == NULL) {
-							printf("Error at realloc\n");
-							exit(EXIT_FAILURE);
-						}
-					}
-
-					new_range->index[new_range->size] = (*(int32_t *)min_node->value) % LETTER_LEN;
-
-					++(new_range->size);
-					
-					min_node = min_node->next;
-				}
-			}
+			/* Visit just the keys on the level, in order */
+			dict_level_traverse(dict, level_of_max_node, range_push_key, new_range);
 		}
 	}
 
@@ -370,29 +1194,13 @@ range_t* range_key_query(dict_t *dict, const char *left, const char *right) {
 		new_range->index = malloc(sizeof(*new_range->index) * new_range->capacity);
 
 		if (new_range->index != NULL) {
-			dict_node_t *min_node = dict_minimum(dict->root);
+			/* Descend to the first key of the range */
+			dict_node_t *min_node = dict_lower_bound(dict, left);
 
-			while ((min_node != NULL) && (dict->cmp(min_node->key, left) < 0)) {
-				min_node = min_node->end->next;
-			}
-			
 			while ((min_node != NULL) && (dict->cmp(min_node->key, right) <= 0)) {
-				if (new_range->size == new_range->capacity) {
-					new_range->capacity *= 2;
-
-					new_range->index = realloc(new_range->index, sizeof(*new_range->index) * new_range->capacity);
-					
-					if (new_range->index == NULL) {
-						printf("Error ar realloc\n");
-						exit(EXIT_FAILURE);
-					}
-				}
+				range_push_key(min_node, new_range);
 
-				new_range->index[new_range->size] = (*(int32_t *)min_node->value) % LETTER_LEN;
-
-				++(new_range->size);
-
-				min_node = min_node->next;
+				min_node = min_node->end->next;
 			}
 		}
 	}
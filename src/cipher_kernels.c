@@ -0,0 +1,442 @@
+#include "include/cipher_kernels.h"
+
+#include <ctype.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CIPHER_KERNEL_X86 1
+#endif
+
+#define LETTER_LEN CIPHER_LETTER_LEN
+#define CIPHER_STREAM_PAD 32
+
+/**
+ * @brief Definition of a kernel that encrypts or decrypts a block of text in place
+ * 
+ */
+typedef void (*cipher_kernel_func)(cipher_stream_t *stream, char *text, size_t len, uint8_t is_decrypt);
+
+/**
+ * @brief Function to prepare a key for the kernels
+ * 
+ * @param index array of key positions, every position is a non negative letter offset
+ * @param size number of key positions
+ * @return cipher_key_t* pointer to an allocated prepared key or NULL
+ */
+cipher_key_t* create_cipher_key(const int32_t *index, size_t size) {
+	/* Check if input data is valid */
+	if ((index == NULL) || (size == 0)) {
+		return NULL;
+	}
+
+	cipher_key_t *new_key = malloc(sizeof(*new_key));
+
+	if (new_key == NULL) {
+		return NULL;
+	}
+
+	new_key->shifts = malloc(size + CIPHER_STREAM_PAD);
+
+	if (new_key->shifts == NULL) {
+		free(new_key);
+		return NULL;
+	}
+
+	for (size_t iter = 0; iter < size + CIPHER_STREAM_PAD; ++iter) {
+		new_key->shifts[iter] = (uint8_t)(index[iter % size] % LETTER_LEN);
+	}
+
+	new_key->size = size;
+
+	for (size_t c = 0; c < 256; ++c) {
+		new_key->letters[c] = CIPHER_OTHER;
+	}
+
+	for (uint8_t letter = 0; letter < LETTER_LEN; ++letter) {
+		new_key->letters['A' + letter] = letter;
+		new_key->letters['a' + letter] = letter;
+	}
+
+	new_key->letters[' '] = new_key->letters['\n'] = new_key->letters['\r'] = CIPHER_KEPT;
+
+	for (uint8_t shift = 0; shift < LETTER_LEN; ++shift) {
+		for (uint8_t letter = 0; letter < LETTER_LEN; ++letter) {
+			new_key->encrypt_table[shift][letter] = (uint8_t)('A' + (letter + shift) % LETTER_LEN);
+			new_key->decrypt_table[shift][letter] = (uint8_t)('A' + (letter + LETTER_LEN - shift) % LETTER_LEN);
+		}
+	}
+
+	return new_key;
+}
+
+/**
+ * @brief Function to free a prepared key
+ * 
+ * @param key pointer to an allocated prepared key
+ */
+void destroy_cipher_key(cipher_key_t *key) {
+	/* Check if input data is valid */
+	if (key == NULL) {
+		return;
+	}
+
+	free(key->shifts);
+	free(key);
+}
+
+/**
+ * @brief Function to check if a character is written unchanged,
+ * the key does not move on these characters
+ * 
+ * @param c the character to check
+ * @return uint8_t 1 if the character is kept, 0 otherwise
+ */
+static inline uint8_t cipher_is_kept(char c) {
+	return (c == ' ') || (c == '\n') || (c == '\r');
+}
+
+/**
+ * @brief Function to encrypt or decrypt a block one character at a time.
+ * A letter is one lookup in the substitution table of its shift, the
+ * other characters that are not kept are shifted with the formula of
+ * the letters as well.
+ * 
+ * @param stream pointer to a key stream
+ * @param text pointer to the block
+ * @param len number of characters in the block
+ * @param is_decrypt 1 to decrypt, 0 to encrypt
+ */
+static void cipher_kernel_scalar(cipher_stream_t *stream, char *text, size_t len, uint8_t is_decrypt) {
+	const cipher_key_t *key = stream->key;
+	const uint8_t (*table)[LETTER_LEN] = (is_decrypt != 0) ? key->decrypt_table : key->encrypt_table;
+	size_t idx = stream->idx;
+
+	for (size_t iter = 0; iter < len; ++iter) {
+		uint8_t letter = key->letters[(uint8_t)text[iter]];
+
+		if (letter == CIPHER_KEPT) {
+			continue;
+		}
+
+		int32_t shift = key->shifts[idx];
+
+		if (letter < LETTER_LEN) {
+			text[iter] = (char)table[shift][letter];
+		} else if (is_decrypt != 0) {
+			text[iter] = (char)(((toupper(text[iter]) - 'A') - shift + LETTER_LEN) % LETTER_LEN + 'A');
+		} else {
+			text[iter] = (char)(((toupper(text[iter]) - 'A') + shift) % LETTER_LEN + 'A');
+		}
+
+		/* No branch on the wrap of the key */
+		++idx;
+		idx -= (idx == key->size) ? key->size : 0;
+	}
+
+	stream->idx = idx;
+}
+
+#ifdef CIPHER_KERNEL_X86
+
+/**
+ * @brief Function to encrypt or decrypt a block with SSSE3, 16 characters
+ * at once. The key shifts are spread over the letters with a shuffle built
+ * from the prefix count of the letters. A chunk with a character that is
+ * neither a letter nor kept goes through the scalar kernel.
+ * 
+ * @param stream pointer to a key stream
+ * @param text pointer to the block
+ * @param len number of characters in the block
+ * @param is_decrypt 1 to decrypt, 0 to encrypt
+ */
+__attribute__((target("ssse3")))
+static void cipher_kernel_ssse3(cipher_stream_t *stream, char *text, size_t len, uint8_t is_decrypt) {
+	const __m128i letters_len = _mm_set1_epi8(LETTER_LEN);
+	const __m128i last_letter = _mm_set1_epi8(LETTER_LEN - 1);
+	const __m128i ones = _mm_set1_epi8(1);
+	const __m128i no_lane = _mm_set1_epi8((char)0x80);
+
+	size_t iter = 0;
+
+	for (; iter + 16 <= len; iter += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i *)(text + iter));
+
+		/* Position in the alphabet of both cases */
+		__m128i letter = _mm_sub_epi8(_mm_or_si128(chunk, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+		__m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, last_letter), letter);
+		__m128i is_kept = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))));
+
+		if (_mm_movemask_epi8(_mm_or_si128(is_letter, is_kept)) != 0xFFFF) {
+			cipher_kernel_scalar(stream, text + iter, 16, is_decrypt);
+			continue;
+		}
+
+		/* Letters before every lane, the lane of a letter picks the next shift */
+		__m128i count = _mm_and_si128(is_letter, ones);
+		__m128i prefix = _mm_add_epi8(count, _mm_slli_si128(count, 1));
+		prefix = _mm_add_epi8(prefix, _mm_slli_si128(prefix, 2));
+		prefix = _mm_add_epi8(prefix, _mm_slli_si128(prefix, 4));
+		prefix = _mm_add_epi8(prefix, _mm_slli_si128(prefix, 8));
+
+		__m128i lanes = _mm_or_si128(_mm_and_si128(is_letter, _mm_sub_epi8(prefix, count)), _mm_andnot_si128(is_letter, no_lane));
+		__m128i shifts = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(stream->key->shifts + stream->idx)), lanes);
+
+		__m128i shifted;
+
+		if (is_decrypt != 0) {
+			shifted = _mm_sub_epi8(letter, shifts);
+			shifted = _mm_add_epi8(shifted, _mm_and_si128(_mm_cmpgt_epi8(_mm_setzero_si128(), shifted), letters_len));
+		} else {
+			shifted = _mm_add_epi8(letter, shifts);
+			shifted = _mm_sub_epi8(shifted, _mm_and_si128(_mm_cmpgt_epi8(shifted, last_letter), letters_len));
+		}
+
+		shifted = _mm_add_epi8(shifted, _mm_set1_epi8('A'));
+
+		__m128i result = _mm_or_si128(_mm_and_si128(is_letter, shifted), _mm_andnot_si128(is_letter, chunk));
+		_mm_storeu_si128((__m128i *)(text + iter), result);
+
+		stream->idx += (size_t)__builtin_popcount((uint32_t)_mm_movemask_epi8(is_letter));
+
+		if (stream->idx >= stream->key->size) {
+			stream->idx %= stream->key->size;
+		}
+	}
+
+	cipher_kernel_scalar(stream, text + iter, len - iter, is_decrypt);
+}
+
+/**
+ * @brief Function to encrypt or decrypt a block with AVX2, 32 characters
+ * at once. The shuffle works inside each half of 16 lanes, so the second
+ * half loads the key stream after the letters of the first half.
+ * 
+ * @param stream pointer to a key stream
+ * @param text pointer to the block
+ * @param len number of characters in the block
+ * @param is_decrypt 1 to decrypt, 0 to encrypt
+ */
+__attribute__((target("avx2")))
+static void cipher_kernel_avx2(cipher_stream_t *stream, char *text, size_t len, uint8_t is_decrypt) {
+	const __m256i letters_len = _mm256_set1_epi8(LETTER_LEN);
+	const __m256i last_letter = _mm256_set1_epi8(LETTER_LEN - 1);
+	const __m256i ones = _mm256_set1_epi8(1);
+	const __m256i no_lane = _mm256_set1_epi8((char)0x80);
+
+	size_t iter = 0;
+
+	for (; iter + 32 <= len; iter += 32) {
+		__m256i chunk = _mm256_loadu_si256((const __m256i *)(text + iter));
+
+		/* Position in the alphabet of both cases */
+		__m256i letter = _mm256_sub_epi8(_mm256_or_si256(chunk, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+		__m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, last_letter), letter);
+		__m256i is_kept = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+			_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'))));
+
+		if ((uint32_t)_mm256_movemask_epi8(_mm256_or_si256(is_letter, is_kept)) != UINT32_MAX) {
+			cipher_kernel_scalar(stream, text + iter, 32, is_decrypt);
+			continue;
+		}
+
+		/* Letters before every lane, counted inside each half */
+		__m256i count = _mm256_and_si256(is_letter, ones);
+		__m256i prefix = _mm256_add_epi8(count, _mm256_slli_si256(count, 1));
+		prefix = _mm256_add_epi8(prefix, _mm256_slli_si256(prefix, 2));
+		prefix = _mm256_add_epi8(prefix, _mm256_slli_si256(prefix, 4));
+		prefix = _mm256_add_epi8(prefix, _mm256_slli_si256(prefix, 8));
+
+		uint32_t letter_mask = (uint32_t)_mm256_movemask_epi8(is_letter);
+		size_t low_letters = (size_t)__builtin_popcount(letter_mask & 0xFFFF);
+
+		__m256i stream_chunk = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(stream->key->shifts + stream->idx))),
+			_mm_loadu_si128((const __m128i *)(stream->key->shifts + stream->idx + low_letters)), 1);
+
+		__m256i lanes = _mm256_or_si256(_mm256_and_si256(is_letter, _mm256_sub_epi8(prefix, count)), _mm256_andnot_si256(is_letter, no_lane));
+		__m256i shifts = _mm256_shuffle_epi8(stream_chunk, lanes);
+
+		__m256i shifted;
+
+		if (is_decrypt != 0) {
+			shifted = _mm256_sub_epi8(letter, shifts);
+			shifted = _mm256_add_epi8(shifted, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_setzero_si256(), shifted), letters_len));
+		} else {
+			shifted = _mm256_add_epi8(letter, shifts);
+			shifted = _mm256_sub_epi8(shifted, _mm256_and_si256(_mm256_cmpgt_epi8(shifted, last_letter), letters_len));
+		}
+
+		shifted = _mm256_add_epi8(shifted, _mm256_set1_epi8('A'));
+
+		__m256i result = _mm256_blendv_epi8(chunk, shifted, is_letter);
+		_mm256_storeu_si256((__m256i *)(text + iter), result);
+
+		stream->idx += (size_t)__builtin_popcount(letter_mask);
+
+		if (stream->idx >= stream->key->size) {
+			stream->idx %= stream->key->size;
+		}
+	}
+
+	cipher_kernel_scalar(stream, text + iter, len - iter, is_decrypt);
+}
+
+#endif /* CIPHER_KERNEL_X86 */
+
+static cipher_kernel_func cipher_kernel = cipher_kernel_scalar;
+static uint8_t cipher_kernel_in_use = CIPHER_KERNEL_SCALAR;
+static pthread_once_t cipher_kernel_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Function to switch the kernels to a level
+ * 
+ * @param level CIPHER_KERNEL_SCALAR, CIPHER_KERNEL_SSSE3 or CIPHER_KERNEL_AVX2
+ * @return uint8_t 1 if the level is used from now on, 0 if the processor can not run it
+ */
+static uint8_t cipher_kernel_use(uint8_t level) {
+	switch (level) {
+		case CIPHER_KERNEL_SCALAR:
+			cipher_kernel = cipher_kernel_scalar;
+			break;
+#ifdef CIPHER_KERNEL_X86
+		case CIPHER_KERNEL_SSSE3:
+			__builtin_cpu_init();
+
+			if (__builtin_cpu_supports("ssse3") == 0) {
+				return 0;
+			}
+
+			cipher_kernel = cipher_kernel_ssse3;
+			break;
+		case CIPHER_KERNEL_AVX2:
+			__builtin_cpu_init();
+
+			if (__builtin_cpu_supports("avx2") == 0) {
+				return 0;
+			}
+
+			cipher_kernel = cipher_kernel_avx2;
+			break;
+#endif
+		default:
+			return 0;
+	}
+
+	cipher_kernel_in_use = level;
+
+	return 1;
+}
+
+/**
+ * @brief Function to pick the widest level the processor can run,
+ * it runs once before the first block
+ * 
+ */
+static void cipher_kernel_init(void) {
+	for (uint8_t level = CIPHER_KERNEL_AVX2; level > CIPHER_KERNEL_SCALAR; --level) {
+		if (cipher_kernel_use(level) != 0) {
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Function to give the kernel level in use
+ * 
+ * @return uint8_t CIPHER_KERNEL_SCALAR, CIPHER_KERNEL_SSSE3 or CIPHER_KERNEL_AVX2
+ */
+uint8_t cipher_kernel_level(void) {
+	pthread_once(&cipher_kernel_once, cipher_kernel_init);
+
+	return cipher_kernel_in_use;
+}
+
+/**
+ * @brief Function to force a kernel level, the blocks running at the
+ * same time have to be done first. Every level gives the same text.
+ * 
+ * @param level CIPHER_KERNEL_SCALAR, CIPHER_KERNEL_SSSE3 or CIPHER_KERNEL_AVX2
+ * @return uint8_t 1 if the level is used from now on, 0 if the processor can not run it
+ */
+uint8_t cipher_kernel_set_level(uint8_t level) {
+	/* Keep the automatic choice from overwriting this one */
+	pthread_once(&cipher_kernel_once, cipher_kernel_init);
+
+	return cipher_kernel_use(level);
+}
+
+/**
+ * @brief Function to count the characters of a block that move the key,
+ * all of them except spaces and new lines
+ * 
+ * @param text pointer to the block
+ * @param len number of characters in the block
+ * @return size_t number of characters that move the key
+ */
+size_t cipher_count_block(const char *text, size_t len) {
+	/* Check if input data is valid */
+	if (text == NULL) {
+		return 0;
+	}
+
+	size_t kept = 0;
+	size_t iter = 0;
+
+#ifdef __SSE2__
+	/* SSE2 is part of the target, 16 characters at once */
+	for (; iter + 16 <= len; iter += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i *)(text + iter));
+		__m128i is_kept = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))));
+
+		kept += (size_t)__builtin_popcount((uint32_t)_mm_movemask_epi8(is_kept));
+	}
+#endif
+
+	for (; iter < len; ++iter) {
+		kept += cipher_is_kept(text[iter]);
+	}
+
+	return len - kept;
+}
+
+/**
+ * @brief Function to encrypt a block of text in place. Spaces and new
+ * lines are kept, every other character is shifted with the next key
+ * position, the key goes on from the previous block.
+ * 
+ * @param stream pointer to a key stream
+ * @param text pointer to the block
+ * @param len number of characters in the block
+ */
+void cipher_encrypt_block(cipher_stream_t *stream, char *text, size_t len) {
+	/* Check if input data is valid */
+	if ((stream == NULL) || (text == NULL)) {
+		return;
+	}
+
+	pthread_once(&cipher_kernel_once, cipher_kernel_init);
+
+	cipher_kernel(stream, text, len, 0);
+}
+
+/**
+ * @brief Function to decrypt a block of text in place, the reverse of
+ * cipher_encrypt_block for the letters
+ * 
+ * @param stream pointer to a key stream
+ * @param text pointer to the block
+ * @param len number of characters in the block
+ */
+void cipher_decrypt_block(cipher_stream_t *stream, char *text, size_t len) {
+	/* Check if input data is valid */
+	if ((stream == NULL) || (text == NULL)) {
+		return;
+	}
+
+	pthread_once(&cipher_kernel_once, cipher_kernel_init);
+
+	cipher_kernel(stream, text, len, 1);
+}
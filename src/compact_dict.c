@@ -0,0 +1,593 @@
+#include "include/compact_dict.h"
+
+#define NODE(dict, idx) ((dict)->pool + (idx))
+#define HEIGHT(dict, idx) (((idx) == COMPACT_NIL) ? 0 : NODE(dict, idx)->height)
+#define MAX(a, b) (((a) >= (b))?(a):(b))
+
+/**
+ * @brief Function to create a compact dictionary object.
+ * 
+ * @param create_key Function to create a key object
+ * @param destroy_key Function to destroy a key object
+ * @param create_value Function to create a value object
+ * @param destroy_value Function to destroy a value object
+ * @param cmp Function two compare two keys
+ * @return compact_dict_t* pointer to an allocated compact dictionary object or NULL
+ */
+compact_dict_t* create_compact_dict(create_func create_key, destroy_func destroy_key, create_func create_value, destroy_func destroy_value, compare_func cmp) {
+	/* Allocate the dictionary object */
+	compact_dict_t *new_dict = malloc(sizeof(*new_dict));
+
+	/* Check if dictionary was allocated successfully */
+	if (new_dict != NULL) {
+		new_dict->pool = malloc(sizeof(*new_dict->pool) * COMPACT_INIT_LEN);
+
+		if (new_dict->pool == NULL) {
+			free(new_dict);
+			return NULL;
+		}
+
+		/* Set default values for dictionary object */
+		new_dict->capacity = COMPACT_INIT_LEN;
+		new_dict->used = 0;
+		new_dict->free_head = COMPACT_NIL;
+		new_dict->root = COMPACT_NIL;
+		new_dict->create_key = create_key;
+		new_dict->destroy_key = destroy_key;
+		new_dict->create_value = create_value;
+		new_dict->destroy_value = destroy_value;
+		new_dict->cmp = cmp;
+		new_dict->size = 0;
+	}
+
+	return new_dict;
+}
+
+/**
+ * @brief Function to free all memory loaded for the compact dictionary object
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ */
+void destroy_compact_dict(compact_dict_t *dict) {
+	/* Check if input data is valid */
+	if (dict == NULL) {
+		return;
+	}
+
+	uint32_t iter = compact_dict_minimum(dict);
+
+	/* Destroy the content of every node */
+	while (iter != COMPACT_NIL) {
+		dict->destroy_key(NODE(dict, iter)->key);
+		dict->destroy_value(NODE(dict, iter)->value);
+
+		iter = NODE(dict, iter)->next;
+	}
+
+	/* The nodes go away with the pool */
+	free(dict->pool);
+	free(dict);
+}
+
+/**
+ * @brief Function to get the node object found at an index of the pool.
+ * The pointer is valid until the next insertion.
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param idx index of the node
+ * @return compact_node_t* pointer to the node or NULL
+ */
+compact_node_t* compact_dict_node(compact_dict_t *dict, uint32_t idx) {
+	if ((dict == NULL) || (idx >= dict->used)) {
+		return NULL;
+	}
+
+	return NODE(dict, idx);
+}
+
+/**
+ * @brief Function to take a node from the pool, a released
+ * node is reused first and the pool doubles when it is full.
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param key pointer to the key location
+ * @param value pointer to the value location
+ * @return uint32_t index of the new node or COMPACT_NIL
+ */
+static uint32_t compact_dict_new_node(compact_dict_t *dict, const void *key, const void *value) {
+	uint32_t new_idx = dict->free_head;
+
+	if (new_idx != COMPACT_NIL) {
+		dict->free_head = NODE(dict, new_idx)->next;
+	} else {
+		if (dict->used == dict->capacity) {
+			if (dict->capacity > (COMPACT_NIL - 1) / 2) {
+				return COMPACT_NIL;
+			}
+
+			compact_node_t *new_pool = realloc(dict->pool, sizeof(*new_pool) * dict->capacity * 2);
+
+			if (new_pool == NULL) {
+				return COMPACT_NIL;
+			}
+
+			dict->pool = new_pool;
+			dict->capacity *= 2;
+		}
+
+		new_idx = (dict->used)++;
+	}
+
+	compact_node_t *new_node = NODE(dict, new_idx);
+
+	/* Create key and value */
+	new_node->key = dict->create_key(key);
+	new_node->value = dict->create_value(value);
+
+	/* Set default node metadata */
+	new_node->left = new_node->right = COMPACT_NIL;
+	new_node->next = new_node->prev = COMPACT_NIL;
+	new_node->end = new_idx;
+	new_node->height = 1;
+
+	return new_idx;
+}
+
+/**
+ * @brief Function to give a node back to the pool
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param idx index of the node to release
+ */
+static void compact_dict_free_node(compact_dict_t *dict, uint32_t idx) {
+	dict->destroy_key(NODE(dict, idx)->key);
+	dict->destroy_value(NODE(dict, idx)->value);
+
+	NODE(dict, idx)->next = dict->free_head;
+	dict->free_head = idx;
+}
+
+/**
+ * @brief Function to search for a desired key
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param key pointer to a key location
+ * @return uint32_t index of the key head or COMPACT_NIL
+ */
+uint32_t compact_dict_search(compact_dict_t *dict, const void *key) {
+	/* Check if the input data is valid */
+	if (dict == NULL) {
+		return COMPACT_NIL;
+	}
+
+	uint32_t iter = dict->root;
+
+	/* Find the desired dictionary node */
+	while (iter != COMPACT_NIL) {
+		int32_t cmp_result = dict->cmp(NODE(dict, iter)->key, key);
+
+		if (cmp_result > 0) {
+			iter = NODE(dict, iter)->left;
+		} else if (cmp_result < 0) {
+			iter = NODE(dict, iter)->right;
+		} else {
+			return iter;
+		}
+	}
+
+	return COMPACT_NIL;
+}
+
+/**
+ * @brief Function to find the minimum key head
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @return uint32_t index of the minimum key head or COMPACT_NIL
+ */
+uint32_t compact_dict_minimum(compact_dict_t *dict) {
+	if ((dict == NULL) || (dict->root == COMPACT_NIL)) {
+		return COMPACT_NIL;
+	}
+
+	uint32_t iter = dict->root;
+
+	while (NODE(dict, iter)->left != COMPACT_NIL) {
+		iter = NODE(dict, iter)->left;
+	}
+
+	return iter;
+}
+
+/**
+ * @brief Function to find the maximum key head
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @return uint32_t index of the maximum key head or COMPACT_NIL
+ */
+uint32_t compact_dict_maximum(compact_dict_t *dict) {
+	if ((dict == NULL) || (dict->root == COMPACT_NIL)) {
+		return COMPACT_NIL;
+	}
+
+	uint32_t iter = dict->root;
+
+	while (NODE(dict, iter)->right != COMPACT_NIL) {
+		iter = NODE(dict, iter)->right;
+	}
+
+	return iter;
+}
+
+/**
+ * @brief Function to find the key head that follows a key head,
+ * the list gives it in O(1) without a parent link
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param idx index of a key head
+ * @return uint32_t index of the successor key head or COMPACT_NIL
+ */
+uint32_t compact_dict_successor(compact_dict_t *dict, uint32_t idx) {
+	if ((dict == NULL) || (idx >= dict->used)) {
+		return COMPACT_NIL;
+	}
+
+	return NODE(dict, NODE(dict, idx)->end)->next;
+}
+
+/**
+ * @brief Function to find the key head before a key head. The previous
+ * node is either a lone key head or a duplicate that links its key head.
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param idx index of a key head
+ * @return uint32_t index of the predecessor key head or COMPACT_NIL
+ */
+uint32_t compact_dict_predecessor(compact_dict_t *dict, uint32_t idx) {
+	if ((dict == NULL) || (idx >= dict->used)) {
+		return COMPACT_NIL;
+	}
+
+	uint32_t prev_idx = NODE(dict, idx)->prev;
+
+	if (prev_idx == COMPACT_NIL) {
+		return COMPACT_NIL;
+	}
+
+	return NODE(dict, prev_idx)->end;
+}
+
+/**
+ * @brief Function to update the height of a node
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param idx index of the node to fix
+ */
+static void compact_update_height(compact_dict_t *dict, uint32_t idx) {
+	uint8_t left_height = HEIGHT(dict, NODE(dict, idx)->left);
+	uint8_t right_height = HEIGHT(dict, NODE(dict, idx)->right);
+
+	NODE(dict, idx)->height = MAX(left_height, right_height) + 1;
+}
+
+/**
+ * @brief Function to get the balance factor of a node
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param idx index of the node
+ * @return int32_t the balance factor
+ */
+static int32_t compact_get_balance(compact_dict_t *dict, uint32_t idx) {
+	if (idx == COMPACT_NIL) {
+		return 0;
+	}
+
+	return (int32_t)HEIGHT(dict, NODE(dict, idx)->left) - (int32_t)HEIGHT(dict, NODE(dict, idx)->right);
+}
+
+/**
+ * @brief Function to rotate to left a sub-tree
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param idx index of the sub-tree root
+ * @return uint32_t index of the new sub-tree root
+ */
+static uint32_t compact_rotate_left(compact_dict_t *dict, uint32_t idx) {
+	uint32_t rotate_idx = NODE(dict, idx)->right;
+
+	NODE(dict, idx)->right = NODE(dict, rotate_idx)->left;
+	NODE(dict, rotate_idx)->left = idx;
+
+	compact_update_height(dict, idx);
+	compact_update_height(dict, rotate_idx);
+
+	return rotate_idx;
+}
+
+/**
+ * @brief Function to rotate to right a sub-tree
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param idx index of the sub-tree root
+ * @return uint32_t index of the new sub-tree root
+ */
+static uint32_t compact_rotate_right(compact_dict_t *dict, uint32_t idx) {
+	uint32_t rotate_idx = NODE(dict, idx)->left;
+
+	NODE(dict, idx)->left = NODE(dict, rotate_idx)->right;
+	NODE(dict, rotate_idx)->right = idx;
+
+	compact_update_height(dict, idx);
+	compact_update_height(dict, rotate_idx);
+
+	return rotate_idx;
+}
+
+/**
+ * @brief Function to balance a sub-tree whose children are balanced
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param idx index of the sub-tree root
+ * @return uint32_t index of the new sub-tree root
+ */
+static uint32_t compact_rebalance(compact_dict_t *dict, uint32_t idx) {
+	compact_update_height(dict, idx);
+
+	int32_t balance_fact = compact_get_balance(dict, idx);
+
+	/* Left-Left and Left-Right cases */
+	if (balance_fact > 1) {
+		if (compact_get_balance(dict, NODE(dict, idx)->left) < 0) {
+			NODE(dict, idx)->left = compact_rotate_left(dict, NODE(dict, idx)->left);
+		}
+
+		return compact_rotate_right(dict, idx);
+	}
+
+	/* Right-Right and Right-Left cases */
+	if (balance_fact < -1) {
+		if (compact_get_balance(dict, NODE(dict, idx)->right) > 0) {
+			NODE(dict, idx)->right = compact_rotate_right(dict, NODE(dict, idx)->right);
+		}
+
+		return compact_rotate_left(dict, idx);
+	}
+
+	return idx;
+}
+
+/**
+ * @brief Function to balance the nodes of a search path, from the deepest
+ * one up to the root. Without parent links the path is kept on a stack.
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param path indexes of the nodes from the root down
+ * @param dirs 0 if the path goes left from a node, 1 if it goes right
+ * @param path_len number of nodes in the path
+ */
+static void compact_fix_path(compact_dict_t *dict, uint32_t *path, uint8_t *dirs, size_t path_len) {
+	while (path_len > 0) {
+		--path_len;
+
+		uint32_t new_root = compact_rebalance(dict, path[path_len]);
+
+		/* Link the balanced sub-tree to its parent */
+		if (path_len == 0) {
+			dict->root = new_root;
+		} else if (dirs[path_len - 1] == 0) {
+			NODE(dict, path[path_len - 1])->left = new_root;
+		} else {
+			NODE(dict, path[path_len - 1])->right = new_root;
+		}
+	}
+}
+
+/**
+ * @brief Function to insert a new node into the compact dictionary obejct
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param key pointer to a key data
+ * @param value pointer to a value data
+ */
+void compact_dict_insert(compact_dict_t *dict, const void *key, const void *value) {
+	/* Check if input data is valid */
+	if (dict == NULL) {
+		return;
+	}
+
+	uint32_t path[COMPACT_MAX_HEIGHT];
+	uint8_t dirs[COMPACT_MAX_HEIGHT];
+	size_t path_len = 0;
+
+	uint32_t iter = dict->root;
+
+	/* Find insert position */
+	while (iter != COMPACT_NIL) {
+		int32_t cmp_result = dict->cmp(key, NODE(dict, iter)->key);
+
+		if (cmp_result == 0) {
+			break;
+		}
+
+		path[path_len] = iter;
+		dirs[path_len] = (cmp_result > 0);
+		++path_len;
+
+		iter = (cmp_result > 0) ? NODE(dict, iter)->right : NODE(dict, iter)->left;
+	}
+
+	/* The pool may move, so only indexes are kept from here */
+	uint32_t new_idx = compact_dict_new_node(dict, key, value);
+
+	if (new_idx == COMPACT_NIL) {
+		return;
+	}
+
+	++(dict->size);
+
+	if (iter != COMPACT_NIL) {
+
+		/* Same key, add at the end of the duplicate list */
+		uint32_t end_idx = NODE(dict, iter)->end;
+
+		NODE(dict, new_idx)->next = NODE(dict, end_idx)->next;
+		NODE(dict, new_idx)->prev = end_idx;
+		NODE(dict, new_idx)->end = iter;
+
+		if (NODE(dict, new_idx)->next != COMPACT_NIL) {
+			NODE(dict, NODE(dict, new_idx)->next)->prev = new_idx;
+		}
+
+		NODE(dict, end_idx)->next = new_idx;
+		NODE(dict, iter)->end = new_idx;
+
+		return;
+	}
+
+	if (path_len == 0) {
+		dict->root = new_idx;
+		return;
+	}
+
+	uint32_t parent_idx = path[path_len - 1];
+
+	if (dirs[path_len - 1] == 0) {
+
+		/* New left child, it comes right before its parent */
+		NODE(dict, parent_idx)->left = new_idx;
+		NODE(dict, new_idx)->next = parent_idx;
+		NODE(dict, new_idx)->prev = NODE(dict, parent_idx)->prev;
+	} else {
+
+		/* New right child, it comes right after its parent list */
+		NODE(dict, parent_idx)->right = new_idx;
+		NODE(dict, new_idx)->prev = NODE(dict, parent_idx)->end;
+		NODE(dict, new_idx)->next = NODE(dict, NODE(dict, parent_idx)->end)->next;
+	}
+
+	if (NODE(dict, new_idx)->prev != COMPACT_NIL) {
+		NODE(dict, NODE(dict, new_idx)->prev)->next = new_idx;
+	}
+
+	if (NODE(dict, new_idx)->next != COMPACT_NIL) {
+		NODE(dict, NODE(dict, new_idx)->next)->prev = new_idx;
+	}
+
+	/* Fix the avl tree */
+	compact_fix_path(dict, path, dirs, path_len);
+}
+
+/**
+ * @brief Function to delete one key node from the compact dictionary
+ * 
+ * @param dict pointer to an allocated compact dictionary object
+ * @param key pointer to a key data location to delete from dictionary
+ */
+void compact_dict_delete(compact_dict_t *dict, const void *key) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (key == NULL)) {
+		return;
+	}
+
+	uint32_t path[COMPACT_MAX_HEIGHT];
+	uint8_t dirs[COMPACT_MAX_HEIGHT];
+	size_t path_len = 0;
+
+	uint32_t iter = dict->root;
+
+	/* Find the key, remembering the path */
+	while (iter != COMPACT_NIL) {
+		int32_t cmp_result = dict->cmp(key, NODE(dict, iter)->key);
+
+		if (cmp_result == 0) {
+			break;
+		}
+
+		path[path_len] = iter;
+		dirs[path_len] = (cmp_result > 0);
+		++path_len;
+
+		iter = (cmp_result > 0) ? NODE(dict, iter)->right : NODE(dict, iter)->left;
+	}
+
+	if (iter == COMPACT_NIL) {
+		return;
+	}
+
+	--(dict->size);
+
+	compact_node_t *iter_node = NODE(dict, iter);
+
+	if (iter_node->end != iter) {
+
+		/* Remove the last duplicate from the list */
+		uint32_t delete_idx = iter_node->end;
+
+		NODE(dict, NODE(dict, delete_idx)->prev)->next = NODE(dict, delete_idx)->next;
+
+		if (NODE(dict, delete_idx)->next != COMPACT_NIL) {
+			NODE(dict, NODE(dict, delete_idx)->next)->prev = NODE(dict, delete_idx)->prev;
+		}
+
+		iter_node->end = NODE(dict, delete_idx)->prev;
+		compact_dict_free_node(dict, delete_idx);
+
+		return;
+	}
+
+	uint32_t replace_idx = COMPACT_NIL;
+
+	if ((iter_node->left != COMPACT_NIL) && (iter_node->right != COMPACT_NIL)) {
+		size_t iter_pos = path_len;
+
+		/* Find the successor, it will take the place of the node */
+		path[path_len] = iter;
+		dirs[path_len] = 1;
+		++path_len;
+
+		replace_idx = iter_node->right;
+
+		while (NODE(dict, replace_idx)->left != COMPACT_NIL) {
+			path[path_len] = replace_idx;
+			dirs[path_len] = 0;
+			++path_len;
+
+			replace_idx = NODE(dict, replace_idx)->left;
+		}
+
+		/* Unlink the successor from its parent */
+		if (dirs[path_len - 1] == 0) {
+			NODE(dict, path[path_len - 1])->left = NODE(dict, replace_idx)->right;
+		} else {
+			NODE(dict, path[path_len - 1])->right = NODE(dict, replace_idx)->right;
+		}
+
+		/* The successor takes the children of the node */
+		NODE(dict, replace_idx)->left = iter_node->left;
+		NODE(dict, replace_idx)->right = iter_node->right;
+		path[iter_pos] = replace_idx;
+	} else {
+		replace_idx = (iter_node->left != COMPACT_NIL) ? iter_node->left : iter_node->right;
+
+		if (path_len == 0) {
+			dict->root = replace_idx;
+		} else if (dirs[path_len - 1] == 0) {
+			NODE(dict, path[path_len - 1])->left = replace_idx;
+		} else {
+			NODE(dict, path[path_len - 1])->right = replace_idx;
+		}
+	}
+
+	/* Remove the node from the list */
+	if (iter_node->prev != COMPACT_NIL) {
+		NODE(dict, iter_node->prev)->next = iter_node->next;
+	}
+
+	if (iter_node->next != COMPACT_NIL) {
+		NODE(dict, iter_node->next)->prev = iter_node->prev;
+	}
+
+	compact_dict_free_node(dict, iter);
+
+	/* Fix the avl tree */
+	compact_fix_path(dict, path, dirs, path_len);
+}
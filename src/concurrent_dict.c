@@ -0,0 +1,266 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "include/concurrent_dict.h"
+
+/**
+ * @brief Function to create a dictionary object that can be shared
+ * between threads. On glibc the lock prefers the writers, so a steady
+ * stream of readers can not starve an insert or a delete.
+ * 
+ * @param create_key Function to create a key object
+ * @param destroy_key Function to destroy a key object
+ * @param create_value Function to create a value object
+ * @param destroy_value Function to destroy a value object
+ * @param cmp Function two compare two keys
+ * @return concurrent_dict_t* pointer to an allocated concurrent dictionary object or NULL
+ */
+concurrent_dict_t* create_concurrent_dict(create_func create_key, destroy_func destroy_key, create_func create_value, destroy_func destroy_value, compare_func cmp) {
+	concurrent_dict_t *new_cdict = malloc(sizeof(*new_cdict));
+
+	if (new_cdict == NULL) {
+		return NULL;
+	}
+
+	new_cdict->dict = create_dict(create_key, destroy_key, create_value, destroy_value, cmp);
+
+	if (new_cdict->dict == NULL) {
+		free(new_cdict);
+		return NULL;
+	}
+
+	pthread_rwlockattr_t attr;
+	pthread_rwlockattr_init(&attr);
+
+#ifdef __GLIBC__
+	pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+
+	if (pthread_rwlock_init(&new_cdict->lock, &attr) != 0) {
+		pthread_rwlockattr_destroy(&attr);
+		destroy_dict(new_cdict->dict);
+		free(new_cdict);
+		return NULL;
+	}
+
+	pthread_rwlockattr_destroy(&attr);
+
+	return new_cdict;
+}
+
+/**
+ * @brief Function to free all memory loaded for the concurrent dictionary
+ * object. No other thread may use the dictionary anymore.
+ * 
+ * @param cdict pointer to an allocated concurrent dictionary object
+ */
+void destroy_concurrent_dict(concurrent_dict_t *cdict) {
+	/* Check if input data is valid */
+	if (cdict == NULL) {
+		return;
+	}
+
+	pthread_rwlock_destroy(&cdict->lock);
+	destroy_dict(cdict->dict);
+	free(cdict);
+}
+
+/**
+ * @brief Function to take the lock in shared mode. Until the matching
+ * concurrent_dict_read_end the caller can use every function that does not
+ * change the returned dictionary, like dict_search, dict_lower_bound or the
+ * walks over the next/prev list.
+ * 
+ * @param cdict pointer to an allocated concurrent dictionary object
+ * @return dict_t* pointer to the guarded dictionary or NULL
+ */
+dict_t* concurrent_dict_read_begin(concurrent_dict_t *cdict) {
+	/* Check if input data is valid */
+	if (cdict == NULL) {
+		return NULL;
+	}
+
+	pthread_rwlock_rdlock(&cdict->lock);
+
+	return cdict->dict;
+}
+
+/**
+ * @brief Function to release the lock taken by concurrent_dict_read_begin
+ * 
+ * @param cdict pointer to an allocated concurrent dictionary object
+ */
+void concurrent_dict_read_end(concurrent_dict_t *cdict) {
+	/* Check if input data is valid */
+	if (cdict == NULL) {
+		return;
+	}
+
+	pthread_rwlock_unlock(&cdict->lock);
+}
+
+/**
+ * @brief Function to take the lock in exclusive mode, used to group
+ * several changes of the returned dictionary in one writer section
+ * 
+ * @param cdict pointer to an allocated concurrent dictionary object
+ * @return dict_t* pointer to the guarded dictionary or NULL
+ */
+dict_t* concurrent_dict_write_begin(concurrent_dict_t *cdict) {
+	/* Check if input data is valid */
+	if (cdict == NULL) {
+		return NULL;
+	}
+
+	pthread_rwlock_wrlock(&cdict->lock);
+
+	return cdict->dict;
+}
+
+/**
+ * @brief Function to release the lock taken by concurrent_dict_write_begin
+ * 
+ * @param cdict pointer to an allocated concurrent dictionary object
+ */
+void concurrent_dict_write_end(concurrent_dict_t *cdict) {
+	/* Check if input data is valid */
+	if (cdict == NULL) {
+		return;
+	}
+
+	pthread_rwlock_unlock(&cdict->lock);
+}
+
+/**
+ * @brief Function to search a key. The node is given to "visit" while
+ * the shared lock is still held, it must not be used after the call.
+ * 
+ * @param cdict pointer to an allocated concurrent dictionary object
+ * @param key pointer to a key location
+ * @param visit Function to call for the key head, can be NULL
+ * @param data pointer passed to the "visit" call
+ * @return uint8_t 1 if the key was found, 0 otherwise
+ */
+uint8_t concurrent_dict_search(concurrent_dict_t *cdict, const void *key, visit_func visit, void *data) {
+	/* Check if input data is valid */
+	if ((cdict == NULL) || (key == NULL)) {
+		return 0;
+	}
+
+	pthread_rwlock_rdlock(&cdict->lock);
+
+	dict_node_t *node = dict_search(cdict->dict, cdict->dict->root, key);
+
+	if ((node != NULL) && (visit != NULL)) {
+		visit(node, data);
+	}
+
+	pthread_rwlock_unlock(&cdict->lock);
+
+	return (node != NULL);
+}
+
+/**
+ * @brief Function to visit in order the keys between "left" and "right",
+ * both ends included, under the shared lock
+ * 
+ * @param cdict pointer to an allocated concurrent dictionary object
+ * @param left pointer to the lower key of the range, NULL for no lower key
+ * @param right pointer to the upper key of the range, NULL for no upper key
+ * @param visit Function to call for every key head
+ * @param data pointer passed to every "visit" call
+ * @return size_t number of visited keys
+ */
+size_t concurrent_dict_range(concurrent_dict_t *cdict, const void *left, const void *right, visit_func visit, void *data) {
+	/* Check if input data is valid */
+	if ((cdict == NULL) || (visit == NULL)) {
+		return 0;
+	}
+
+	size_t count = 0;
+
+	pthread_rwlock_rdlock(&cdict->lock);
+
+	dict_t *dict = cdict->dict;
+	dict_node_t *iter = (left != NULL) ? dict_lower_bound(dict, left) : dict_minimum(dict->root);
+
+	/* Step over the key heads */
+	while ((iter != NULL) && ((right == NULL) || (dict->cmp(iter->key, right) <= 0))) {
+		visit(iter, data);
+		++count;
+
+		iter = iter->end->next;
+	}
+
+	pthread_rwlock_unlock(&cdict->lock);
+
+	return count;
+}
+
+/**
+ * @brief Function to find the number of entries, duplicates included
+ * 
+ * @param cdict pointer to an allocated concurrent dictionary object
+ * @return size_t the number of entries
+ */
+size_t concurrent_dict_size(concurrent_dict_t *cdict) {
+	/* Check if input data is valid */
+	if (cdict == NULL) {
+		return 0;
+	}
+
+	pthread_rwlock_rdlock(&cdict->lock);
+
+	size_t size = cdict->dict->size;
+
+	pthread_rwlock_unlock(&cdict->lock);
+
+	return size;
+}
+
+/**
+ * @brief Function to insert a new entry under the exclusive lock, the
+ * key and value are created and the tree is rebalanced while it is held
+ * 
+ * @param cdict pointer to an allocated concurrent dictionary object
+ * @param key pointer to a key location
+ * @param value pointer to a value location
+ */
+void concurrent_dict_insert(concurrent_dict_t *cdict, const void *key, const void *value) {
+	/* Check if input data is valid */
+	if ((cdict == NULL) || (key == NULL) || (value == NULL)) {
+		return;
+	}
+
+	pthread_rwlock_wrlock(&cdict->lock);
+
+	dict_insert(cdict->dict, key, value);
+
+	pthread_rwlock_unlock(&cdict->lock);
+}
+
+/**
+ * @brief Function to delete the last entry of a key. A missing key is
+ * found under the shared lock, so it does not stop the readers.
+ * 
+ * @param cdict pointer to an allocated concurrent dictionary object
+ * @param key pointer to a key location
+ */
+void concurrent_dict_delete(concurrent_dict_t *cdict, const void *key) {
+	/* Check if input data is valid */
+	if ((cdict == NULL) || (key == NULL)) {
+		return;
+	}
+
+	if (concurrent_dict_search(cdict, key, NULL, NULL) == 0) {
+		return;
+	}
+
+	/* The key can be gone already, dict_delete ignores it then */
+	pthread_rwlock_wrlock(&cdict->lock);
+
+	dict_delete(cdict->dict, key);
+
+	pthread_rwlock_unlock(&cdict->lock);
+}
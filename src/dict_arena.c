@@ -0,0 +1,231 @@
+#include "include/dict_arena.h"
+
+#include <sys/mman.h>
+
+#define ARENA_ALIGN 16
+#define ALIGN_UP(size, align) (((size) + (align) - 1) & ~((size_t)(align) - 1))
+
+/**
+ * @brief Function to create an arena of fixed size objects.
+ * 
+ * @param obj_size size of one object in bytes
+ * @param slab_len number of objects to reserve at once, 0 for the default
+ * @param use_huge_pages 1 to back the slabs larger than a huge page with huge pages
+ * @return dict_arena_t* pointer to an allocated arena object or NULL
+ */
+dict_arena_t* create_dict_arena(size_t obj_size, size_t slab_len, uint8_t use_huge_pages) {
+	/* Check if input data is valid, the aligned size has to fit in a size_t */
+	if ((obj_size == 0) || (obj_size > SIZE_MAX - ARENA_ALIGN)) {
+		return NULL;
+	}
+
+	dict_arena_t *new_arena = malloc(sizeof(*new_arena));
+
+	if (new_arena != NULL) {
+
+		/* A released object has to keep the free list link */
+		if (obj_size < sizeof(void *)) {
+			obj_size = sizeof(void *);
+		}
+
+		new_arena->slabs = NULL;
+		new_arena->free_list = NULL;
+		new_arena->bump = new_arena->bump_end = NULL;
+		new_arena->obj_size = ALIGN_UP(obj_size, ARENA_ALIGN);
+		new_arena->slab_len = (slab_len == 0) ? ARENA_DEFAULT_SLAB_LEN : slab_len;
+		new_arena->use_huge_pages = use_huge_pages;
+		new_arena->refs = 1;
+	}
+
+	return new_arena;
+}
+
+/**
+ * @brief Function to reserve a new slab and to link it in the arena chain.
+ * Slabs that cover at least one huge page are mapped with huge pages when
+ * the arena asks for it, falling back to transparent huge pages and to
+ * plain heap memory.
+ * 
+ * @param arena pointer to an allocated arena object
+ * @return uint8_t 1 if a new slab was added, 0 otherwise
+ */
+static uint8_t dict_arena_grow(dict_arena_t *arena) {
+	size_t header_size = ALIGN_UP(sizeof(dict_slab_t), ARENA_ALIGN);
+	size_t bytes = header_size + arena->obj_size * arena->slab_len;
+
+	dict_slab_t *new_slab = NULL;
+	uint8_t is_mapped = 0;
+
+	if ((arena->use_huge_pages != 0) && (bytes >= ARENA_HUGE_PAGE_SIZE)) {
+		bytes = ALIGN_UP(bytes, ARENA_HUGE_PAGE_SIZE);
+
+#ifdef MAP_HUGETLB
+		void *slab_mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#else
+		void *slab_mem = MAP_FAILED;
+#endif
+
+		/* No reserved huge pages, ask for transparent ones */
+		if (slab_mem == MAP_FAILED) {
+			slab_mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+#ifdef MADV_HUGEPAGE
+			if (slab_mem != MAP_FAILED) {
+				madvise(slab_mem, bytes, MADV_HUGEPAGE);
+			}
+#endif
+		}
+
+		if (slab_mem != MAP_FAILED) {
+			new_slab = slab_mem;
+			is_mapped = 1;
+		}
+	}
+
+	if (new_slab == NULL) {
+		new_slab = malloc(bytes);
+
+		if (new_slab == NULL) {
+			return 0;
+		}
+	}
+
+	new_slab->next = arena->slabs;
+	new_slab->bytes = bytes;
+	new_slab->is_mapped = is_mapped;
+	arena->slabs = new_slab;
+
+	/* Objects are handed out from the start of the slab */
+	arena->bump = (uint8_t *)new_slab + header_size;
+	arena->bump_end = (uint8_t *)new_slab + bytes;
+
+	return 1;
+}
+
+/**
+ * @brief Function to allocate one object from the arena. Released
+ * objects are reused first.
+ * 
+ * @param arena pointer to an allocated arena object
+ * @return void* pointer to an uninitialized object or NULL
+ */
+void* dict_arena_alloc(dict_arena_t *arena) {
+	/* Check if input data is valid */
+	if (arena == NULL) {
+		return NULL;
+	}
+
+	/* Reuse a released object */
+	if (arena->free_list != NULL) {
+		void *obj = arena->free_list;
+		arena->free_list = *(void **)obj;
+
+		return obj;
+	}
+
+	/* Reserve a new slab if the current one is full */
+	if ((size_t)(arena->bump_end - arena->bump) < arena->obj_size) {
+		if (dict_arena_grow(arena) == 0) {
+			return NULL;
+		}
+	}
+
+	void *obj = arena->bump;
+	arena->bump += arena->obj_size;
+
+	return obj;
+}
+
+/**
+ * @brief Function to give an object back to the arena
+ * 
+ * @param arena pointer to an allocated arena object
+ * @param obj pointer to an object allocated from the same arena
+ */
+void dict_arena_free(dict_arena_t *arena, void *obj) {
+	/* Check if input data is valid */
+	if ((arena == NULL) || (obj == NULL)) {
+		return;
+	}
+
+	/* Push the object on the free list */
+	*(void **)obj = arena->free_list;
+	arena->free_list = obj;
+}
+
+/**
+ * @brief Function to let one more owner use the arena,
+ * every owner calls destroy_dict_arena when it is done
+ * 
+ * @param arena pointer to an allocated arena object
+ * @return dict_arena_t* the same arena
+ */
+dict_arena_t* dict_arena_share(dict_arena_t *arena) {
+	if (arena != NULL) {
+		++(arena->refs);
+	}
+
+	return arena;
+}
+
+/**
+ * @brief Function to move all the slabs of an arena with a single owner
+ * into another arena of the same object size. The objects keep their
+ * address, the objects released in "src" are not reused anymore.
+ * 
+ * @param dest pointer to the arena that takes the slabs
+ * @param src pointer to the arena to move, it is freed on success
+ * @return uint8_t 1 if the slabs were moved, 0 otherwise
+ */
+uint8_t dict_arena_merge(dict_arena_t *dest, dict_arena_t *src) {
+	/* Check if input data is valid */
+	if ((dest == NULL) || (src == NULL) || (dest == src) || (src->refs != 1) || (dest->obj_size != src->obj_size)) {
+		return 0;
+	}
+
+	/* Link the slabs of "src" at the end of the chain */
+	dict_slab_t **tail = &dest->slabs;
+
+	while (*tail != NULL) {
+		tail = &(*tail)->next;
+	}
+
+	*tail = src->slabs;
+
+	free(src);
+
+	return 1;
+}
+
+/**
+ * @brief Function to release the arena for one owner, the last owner
+ * frees all the slabs at once. The objects are not visited.
+ * 
+ * @param arena pointer to an allocated arena object
+ */
+void destroy_dict_arena(dict_arena_t *arena) {
+	/* Check if input data is valid */
+	if (arena == NULL) {
+		return;
+	}
+
+	/* Other owners still use the slabs */
+	if (--(arena->refs) != 0) {
+		return;
+	}
+
+	/* Iterate through the slab chain */
+	while (arena->slabs != NULL) {
+		dict_slab_t *delete_slab = arena->slabs;
+
+		arena->slabs = arena->slabs->next;
+
+		if (delete_slab->is_mapped != 0) {
+			munmap(delete_slab, delete_slab->bytes);
+		} else {
+			free(delete_slab);
+		}
+	}
+
+	free(arena);
+}
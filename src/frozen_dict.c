@@ -0,0 +1,549 @@
+#include "include/frozen_dict.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FROZEN_MAGIC "AVLFROZ"
+#define FROZEN_PREFETCH_LEVELS 4
+#define ALIGN_UP(size, align) (((size) + (align) - 1) & ~((size_t)(align) - 1))
+#define KEY(frozen, slot) ((frozen)->keys + (slot) * (frozen)->key_stride)
+
+/**
+ * @brief Function to find the slot of the smallest key, the leftmost slot
+ * 
+ * @param len number of distinct keys
+ * @return size_t the slot of the smallest key or FROZEN_NIL
+ */
+static size_t frozen_leftmost(size_t len) {
+	if (len == 0) {
+		return FROZEN_NIL;
+	}
+
+	size_t slot = 1;
+
+	while (2 * slot <= len) {
+		slot = 2 * slot;
+	}
+
+	return slot;
+}
+
+/**
+ * @brief Function to find the slot of the next key. A slot without a right
+ * child climbs while it is a right child, the trailing ones, and one more.
+ * 
+ * @param len number of distinct keys
+ * @param slot slot of a key
+ * @return size_t the slot of the next key or FROZEN_NIL
+ */
+static size_t frozen_next_slot(size_t len, size_t slot) {
+	if (2 * slot + 1 <= len) {
+		slot = 2 * slot + 1;
+
+		while (2 * slot <= len) {
+			slot = 2 * slot;
+		}
+
+		return slot;
+	}
+
+	return slot >> __builtin_ffsll(~(long long)slot);
+}
+
+/**
+ * @brief Function to find the slot of the previous key, the mirror of
+ * frozen_next_slot
+ * 
+ * @param len number of distinct keys
+ * @param slot slot of a key
+ * @return size_t the slot of the previous key or FROZEN_NIL
+ */
+static size_t frozen_prev_slot(size_t len, size_t slot) {
+	if (2 * slot <= len) {
+		slot = 2 * slot;
+
+		while (2 * slot + 1 <= len) {
+			slot = 2 * slot + 1;
+		}
+
+		return slot;
+	}
+
+	return slot >> __builtin_ffsll((long long)slot);
+}
+
+/**
+ * @brief Function to check an image and to point the frozen dictionary
+ * at its arrays. Only the sizes and the offsets are checked, a damaged
+ * image can give wrong answers but it is never read past its end.
+ * 
+ * @param frozen pointer to the frozen dictionary object to fill
+ * @param image pointer to the image
+ * @param bytes number of bytes of the image
+ * @return uint8_t 1 if the image is valid, 0 otherwise
+ */
+static uint8_t frozen_dict_attach(frozen_dict_t *frozen, const uint8_t *image, size_t bytes) {
+	frozen_header_t header;
+
+	if (bytes < sizeof(header)) {
+		return 0;
+	}
+
+	memcpy(&header, image, sizeof(header));
+
+	if ((memcmp(header.magic, FROZEN_MAGIC, sizeof(header.magic)) != 0) || (header.version != FROZEN_VERSION) ||
+		(header.bytes != bytes) || (header.key_stride == 0)) {
+		return 0;
+	}
+
+	/* Every array has to fit between its offset and the next one */
+	if ((header.len >= bytes / header.key_stride) || (header.len >= bytes / sizeof(uint64_t)) ||
+		((header.value_stride != 0) && (header.size > bytes / header.value_stride))) {
+		return 0;
+	}
+
+	if ((header.keys_offset < sizeof(header)) || (header.keys_offset > bytes) || (header.firsts_offset > bytes) ||
+		(header.keys_offset % FROZEN_ALIGN != 0) || (header.firsts_offset % FROZEN_ALIGN != 0) || (header.values_offset % FROZEN_ALIGN != 0) ||
+		(header.keys_offset + (header.len + 1) * header.key_stride > header.firsts_offset) ||
+		(header.firsts_offset + (header.len + 1) * sizeof(uint64_t) > header.values_offset) ||
+		(header.values_offset > bytes) || (header.size * header.value_stride > bytes - header.values_offset)) {
+		return 0;
+	}
+
+	frozen->image = image;
+	frozen->bytes = bytes;
+	frozen->keys = image + header.keys_offset;
+	frozen->firsts = (const uint64_t *)(image + header.firsts_offset);
+	frozen->values = image + header.values_offset;
+	frozen->key_stride = header.key_stride;
+	frozen->value_stride = header.value_stride;
+	frozen->len = header.len;
+	frozen->size = header.size;
+
+	return (frozen->firsts[FROZEN_NIL] == header.size);
+}
+
+/**
+ * @brief Definition of the state used to copy the values of a key
+ * 
+ */
+typedef struct frozen_fill_s {
+	uint8_t *dest;							/* Where to copy the next value */
+	size_t value_len;						/* Number of bytes available for one value */
+	size_t value_stride;					/* Distance between two values */
+	inline_func inline_value;				/* Function to copy a value object */
+	uint8_t is_failed;						/* 1 after a value that does not fit */
+} frozen_fill_t;
+
+/**
+ * @brief Function to copy one value in the image, passed as value_visit_func
+ * 
+ * @param value pointer to the value object
+ * @param data pointer to the frozen_fill_t state
+ */
+static void frozen_fill_value(void *value, void *data) {
+	frozen_fill_t *fill = data;
+
+	if ((fill->value_len != 0) && (fill->inline_value(fill->dest, fill->value_len, value) > fill->value_len)) {
+		fill->is_failed = 1;
+	}
+
+	fill->dest += fill->value_stride;
+}
+
+/**
+ * @brief Function to build a frozen copy of a dictionary. The distinct
+ * keys are copied inline in Eytzinger order and the values of every key
+ * follow each other in insertion order, the keys being in order as well.
+ * The frozen copy does not change when the dictionary does, and the keys
+ * are compared in their inline form with the dictionary compare function.
+ * 
+ * @param dict pointer to an allocated dictionary object
+ * @param key_len maximum number of bytes of an inline key
+ * @param inline_key Function to copy a key object in "key_len" bytes
+ * @param value_len maximum number of bytes of an inline value, 0 to keep only the keys
+ * @param inline_value Function to copy a value object in "value_len" bytes
+ * @return frozen_dict_t* pointer to an allocated frozen dictionary object or NULL if a key or value does not fit
+ */
+frozen_dict_t* dict_freeze(dict_t *dict, size_t key_len, inline_func inline_key, size_t value_len, inline_func inline_value) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (key_len == 0) || (key_len > UINT32_MAX) || (inline_key == NULL) ||
+		((value_len != 0) && (inline_value == NULL))) {
+		return NULL;
+	}
+
+	frozen_header_t header;
+	memset(&header, 0, sizeof(header));
+
+	memcpy(header.magic, FROZEN_MAGIC, sizeof(header.magic));
+	header.version = FROZEN_VERSION;
+	header.key_stride = ALIGN_UP(key_len, sizeof(uint64_t));
+	header.value_stride = ALIGN_UP(value_len, sizeof(uint64_t));
+	header.len = (dict->root != NULL) ? dict->root->subtree_keys : 0;
+	header.size = dict->size;
+
+	/* Each array starts on a cache line */
+	header.keys_offset = ALIGN_UP(sizeof(header), FROZEN_ALIGN);
+	header.firsts_offset = ALIGN_UP(header.keys_offset + (header.len + 1) * header.key_stride, FROZEN_ALIGN);
+	header.values_offset = ALIGN_UP(header.firsts_offset + (header.len + 1) * sizeof(uint64_t), FROZEN_ALIGN);
+	header.bytes = ALIGN_UP(header.values_offset + header.size * header.value_stride, FROZEN_ALIGN);
+
+	frozen_dict_t *new_frozen = malloc(sizeof(*new_frozen));
+	uint8_t *image = aligned_alloc(FROZEN_ALIGN, header.bytes);
+
+	if ((new_frozen == NULL) || (image == NULL)) {
+		free(new_frozen);
+		free(image);
+		return NULL;
+	}
+
+	/* The padding is written as zeros, so equal dictionaries give equal images */
+	memset(image, 0, header.bytes);
+	memcpy(image, &header, sizeof(header));
+
+	uint64_t *firsts = (uint64_t *)(image + header.firsts_offset);
+	frozen_fill_t fill = {image + header.values_offset, value_len, header.value_stride, inline_value, 0};
+
+	dict_node_t *head = (dict->root != NULL) ? dict_minimum(dict->root) : NULL;
+	size_t slot = frozen_leftmost(header.len);
+	uint64_t entries = 0;
+
+	/* The keys come in order, the slots are visited in order as well */
+	while ((head != NULL) && (fill.is_failed == 0)) {
+		if (inline_key(image + header.keys_offset + slot * header.key_stride, key_len, head->key) > key_len) {
+			fill.is_failed = 1;
+			break;
+		}
+
+		firsts[slot] = entries;
+		entries += head->count;
+
+		dict_foreach_value(head, frozen_fill_value, &fill);
+
+		slot = frozen_next_slot(header.len, slot);
+		head = head->end->next;
+	}
+
+	firsts[FROZEN_NIL] = entries;
+
+	new_frozen->is_mapped = 0;
+	new_frozen->cmp = dict->cmp;
+
+	if ((fill.is_failed != 0) || (frozen_dict_attach(new_frozen, image, header.bytes) == 0)) {
+		free(new_frozen);
+		free(image);
+		return NULL;
+	}
+
+	return new_frozen;
+}
+
+/**
+ * @brief Function to write the image of a frozen dictionary in a file,
+ * see frozen_dict_map
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ * @param filename name of the file
+ * @return uint8_t 1 if the image was written, 0 otherwise
+ */
+uint8_t frozen_dict_save(frozen_dict_t *frozen, const char * const filename) {
+	/* Check if input data is valid */
+	if ((frozen == NULL) || (filename == NULL)) {
+		return 0;
+	}
+
+	FILE *fout = fopen(filename, "wb");
+
+	if (fout == NULL) {
+		return 0;
+	}
+
+	uint8_t is_written = (fwrite(frozen->image, 1, frozen->bytes, fout) == frozen->bytes);
+
+	if (fclose(fout) != 0) {
+		is_written = 0;
+	}
+
+	return is_written;
+}
+
+/**
+ * @brief Function to use a frozen dictionary image written by
+ * frozen_dict_save straight from the page cache. The file is mapped
+ * read-only and nothing is copied, the pages are read by the queries.
+ * 
+ * @param filename name of the file
+ * @param cmp Function to compare two inline keys
+ * @return frozen_dict_t* pointer to an allocated frozen dictionary object or NULL
+ */
+frozen_dict_t* frozen_dict_map(const char * const filename, compare_func cmp) {
+	/* Check if input data is valid */
+	if ((filename == NULL) || (cmp == NULL)) {
+		return NULL;
+	}
+
+	int fd = open(filename, O_RDONLY);
+
+	if (fd < 0) {
+		return NULL;
+	}
+
+	struct stat file_stat;
+
+	if ((fstat(fd, &file_stat) != 0) || ((size_t)file_stat.st_size < sizeof(frozen_header_t))) {
+		close(fd);
+		return NULL;
+	}
+
+	size_t bytes = (size_t)file_stat.st_size;
+	uint8_t *image = mmap(NULL, bytes, PROT_READ, MAP_SHARED, fd, 0);
+
+	close(fd);
+
+	if (image == MAP_FAILED) {
+		return NULL;
+	}
+
+	/* The queries jump across the keys */
+	madvise(image, bytes, MADV_RANDOM);
+
+	frozen_dict_t *new_frozen = malloc(sizeof(*new_frozen));
+
+	if ((new_frozen == NULL) || (frozen_dict_attach(new_frozen, image, bytes) == 0)) {
+		free(new_frozen);
+		munmap(image, bytes);
+		return NULL;
+	}
+
+	new_frozen->is_mapped = 1;
+	new_frozen->cmp = cmp;
+
+	return new_frozen;
+}
+
+/**
+ * @brief Function to free a frozen dictionary object and its image
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ */
+void destroy_frozen_dict(frozen_dict_t *frozen) {
+	/* Check if input data is valid */
+	if (frozen == NULL) {
+		return;
+	}
+
+	if (frozen->is_mapped != 0) {
+		munmap((void *)frozen->image, frozen->bytes);
+	} else {
+		free((void *)frozen->image);
+	}
+
+	free(frozen);
+}
+
+/**
+ * @brief Function to get the inline key of a slot
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ * @param slot slot of a key
+ * @return const void* pointer to the inline key or NULL
+ */
+const void* frozen_dict_key(frozen_dict_t *frozen, size_t slot) {
+	/* Check if input data is valid */
+	if ((frozen == NULL) || (slot == FROZEN_NIL) || (slot > frozen->len)) {
+		return NULL;
+	}
+
+	return KEY(frozen, slot);
+}
+
+/**
+ * @brief Function to get the number of entries of a key
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ * @param slot slot of a key
+ * @return size_t number of entries with the key of the slot
+ */
+size_t frozen_dict_count(frozen_dict_t *frozen, size_t slot) {
+	/* Check if input data is valid */
+	if ((frozen == NULL) || (slot == FROZEN_NIL) || (slot > frozen->len)) {
+		return 0;
+	}
+
+	/* The first entry of the next key ends the run, slot 0 holds the size */
+	return frozen->firsts[frozen_next_slot(frozen->len, slot)] - frozen->firsts[slot];
+}
+
+/**
+ * @brief Function to get one inline value of a key, in insertion order
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ * @param slot slot of a key
+ * @param idx index of the value among the values of the key
+ * @return const void* pointer to the inline value or NULL
+ */
+const void* frozen_dict_value(frozen_dict_t *frozen, size_t slot, size_t idx) {
+	if ((frozen == NULL) || (frozen->value_stride == 0) || (idx >= frozen_dict_count(frozen, slot))) {
+		return NULL;
+	}
+
+	uint64_t entry = frozen->firsts[slot] + idx;
+
+	if (entry >= frozen->size) {
+		return NULL;
+	}
+
+	return frozen->values + entry * frozen->value_stride;
+}
+
+/**
+ * @brief Function to find the first key that is not smaller than the
+ * input key. The descent has no branch on the comparison and asks early
+ * for the keys four levels below, they lie next to each other in the layout.
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ * @param key pointer to a key in inline form
+ * @return size_t the slot of the key found or FROZEN_NIL
+ */
+size_t frozen_dict_lower_bound(frozen_dict_t *frozen, const void *key) {
+	/* Check if input data is valid */
+	if ((frozen == NULL) || (key == NULL)) {
+		return FROZEN_NIL;
+	}
+
+	size_t slot = 1;
+
+	while (slot <= frozen->len) {
+		__builtin_prefetch(KEY(frozen, slot << FROZEN_PREFETCH_LEVELS));
+		slot = 2 * slot + (frozen->cmp(KEY(frozen, slot), key) < 0);
+	}
+
+	/* Undo the right turns after the last left one */
+	return slot >> __builtin_ffsll(~(long long)slot);
+}
+
+/**
+ * @brief Function to find the first key that is greater than the input key
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ * @param key pointer to a key in inline form
+ * @return size_t the slot of the key found or FROZEN_NIL
+ */
+size_t frozen_dict_upper_bound(frozen_dict_t *frozen, const void *key) {
+	/* Check if input data is valid */
+	if ((frozen == NULL) || (key == NULL)) {
+		return FROZEN_NIL;
+	}
+
+	size_t slot = 1;
+
+	while (slot <= frozen->len) {
+		__builtin_prefetch(KEY(frozen, slot << FROZEN_PREFETCH_LEVELS));
+		slot = 2 * slot + (frozen->cmp(KEY(frozen, slot), key) <= 0);
+	}
+
+	return slot >> __builtin_ffsll(~(long long)slot);
+}
+
+/**
+ * @brief Function to find a key
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ * @param key pointer to a key in inline form
+ * @return size_t the slot of the key or FROZEN_NIL if it is missing
+ */
+size_t frozen_dict_search(frozen_dict_t *frozen, const void *key) {
+	size_t slot = frozen_dict_lower_bound(frozen, key);
+
+	if ((slot == FROZEN_NIL) || (frozen->cmp(KEY(frozen, slot), key) != 0)) {
+		return FROZEN_NIL;
+	}
+
+	return slot;
+}
+
+/**
+ * @brief Function to find the smallest key
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ * @return size_t the slot of the smallest key or FROZEN_NIL
+ */
+size_t frozen_dict_minimum(frozen_dict_t *frozen) {
+	return (frozen != NULL) ? frozen_leftmost(frozen->len) : FROZEN_NIL;
+}
+
+/**
+ * @brief Function to find the greatest key
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ * @return size_t the slot of the greatest key or FROZEN_NIL
+ */
+size_t frozen_dict_maximum(frozen_dict_t *frozen) {
+	if ((frozen == NULL) || (frozen->len == 0)) {
+		return FROZEN_NIL;
+	}
+
+	size_t slot = 1;
+
+	while (2 * slot + 1 <= frozen->len) {
+		slot = 2 * slot + 1;
+	}
+
+	return slot;
+}
+
+/**
+ * @brief Function to find the next key in order
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ * @param slot slot of a key
+ * @return size_t the slot of the next key or FROZEN_NIL
+ */
+size_t frozen_dict_successor(frozen_dict_t *frozen, size_t slot) {
+	/* Check if input data is valid */
+	if ((frozen == NULL) || (slot == FROZEN_NIL) || (slot > frozen->len)) {
+		return FROZEN_NIL;
+	}
+
+	return frozen_next_slot(frozen->len, slot);
+}
+
+/**
+ * @brief Function to find the previous key in order
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ * @param slot slot of a key
+ * @return size_t the slot of the previous key or FROZEN_NIL
+ */
+size_t frozen_dict_predecessor(frozen_dict_t *frozen, size_t slot) {
+	/* Check if input data is valid */
+	if ((frozen == NULL) || (slot == FROZEN_NIL) || (slot > frozen->len)) {
+		return FROZEN_NIL;
+	}
+
+	return frozen_prev_slot(frozen->len, slot);
+}
+
+/**
+ * @brief Function to count the entries, duplicates included,
+ * with a key between "left" and "right", both ends included
+ * 
+ * @param frozen pointer to an allocated frozen dictionary object
+ * @param left pointer to the lower key of the range, in inline form
+ * @param right pointer to the upper key of the range, in inline form
+ * @return size_t number of entries in the range
+ */
+size_t frozen_dict_count_range(frozen_dict_t *frozen, const void *left, const void *right) {
+	/* Check if input data is valid */
+	if ((frozen == NULL) || (left == NULL) || (right == NULL) || (frozen->cmp(left, right) > 0)) {
+		return 0;
+	}
+
+	/* FROZEN_NIL reads the size, the end of the last run */
+	uint64_t first = frozen->firsts[frozen_dict_lower_bound(frozen, left)];
+	uint64_t last = frozen->firsts[frozen_dict_upper_bound(frozen, right)];
+
+	return (last > first) ? last - first : 0;
+}
@@ -7,6 +7,10 @@
 #include <string.h>
 #include <ctype.h>
 
+#include "dict_arena.h"
+
+#define DICT_SNAPSHOT_VERSION 1
+
 /**
  * @brief Definitions of some basic functions
  * 
@@ -14,9 +18,13 @@
 typedef void* 		(*create_func)		(const void *elem);
 typedef void 		(*destroy_func)		(void *elem);
 typedef int32_t 	(*compare_func)		(const void *elem1, const void *elem2);
+typedef size_t 		(*inline_func)		(void *dest, size_t dest_len, const void *elem);
+typedef uint8_t 	(*bulk_next_func)	(void *stream, const void **key, const void **value);
 
 /**
- * @brief Definition of a dictionary node object
+ * @brief Definition of a dictionary node object. The order statistic
+ * fields, from count to max_freq, are kept on every node in every mode
+ * and cost 32 bytes per node on a 64 bit target.
  * 
  */
 typedef struct dict_node_s{
@@ -29,8 +37,18 @@ typedef struct dict_node_s{
 	struct dict_node_s *prev; 				/* Pointer to previous node */
 	struct dict_node_s *end; 				/* Pointer to end node */
 	int64_t height;							/* Height of the node */
+	size_t count;							/* Number of entries with this key, kept by the key head */
+	size_t subtree_size;					/* Number of entries in the sub-tree */
+	size_t subtree_keys;					/* Number of distinct keys in the sub-tree */
+	struct dict_node_s *max_freq;			/* Pointer to the most frequent key in the sub-tree */
+	void **dup_values;						/* Vector with the values after the first one, see dict_set_value_vectors */
+	size_t dup_capacity;					/* Capacity of the value vector */
+	uint8_t key_data[];						/* Inline key storage, see dict_set_inline_keys */
 } dict_node_t;
 
+typedef void 		(*visit_func)		(dict_node_t *node, void *data);
+typedef void 		(*value_visit_func)	(void *value, void *data);
+
 /**
  * @brief Definition of a dictionary object
  * 
@@ -43,6 +61,11 @@ typedef struct dict_s{
 	destroy_func destroy_value; 			/* Function to destroy a value object */
 	compare_func cmp; 						/* Function two compare two keys */
 	size_t size;							/* The number of nodes in the dictionary */
+	dict_arena_t *arena;					/* Node arena or NULL to use the heap */
+	inline_func inline_key;					/* Function to copy a key object inside the node */
+	size_t inline_key_len;					/* Number of key bytes stored inside every node */
+	uint8_t value_vectors;					/* 1 if duplicates are kept as value vectors */
+	size_t heap_keys;						/* Upper bound of the keys created outside the nodes */
 } dict_t;
 
 
@@ -50,16 +73,25 @@ dict_t* 			create_dict					(create_func create_key, destroy_func destroy_key, cr
 dict_node_t* 		create_dict_node			(dict_t *dict, const void *key, const void *value);
 void 				destroy_dict_node			(dict_t *dict, dict_node_t *delete_node);
 void 				destroy_dict				(dict_t *dict);
+uint8_t 			dict_set_node_arena			(dict_t *dict, size_t slab_len, uint8_t use_huge_pages);
+uint8_t 			dict_set_inline_keys		(dict_t *dict, size_t key_len, inline_func inline_key);
+uint8_t 			dict_set_value_vectors		(dict_t *dict);
 
 uint8_t 			is_dict_empty				(dict_t *dict);
+void 				dict_foreach_value			(dict_node_t *start_node, value_visit_func visit, void *data);
 
 dict_node_t* 		dict_search					(dict_t *dict, dict_node_t *start_node, const void *key);
+dict_node_t* 		dict_lower_bound			(dict_t *dict, const void *key);
+dict_node_t* 		dict_upper_bound			(dict_t *dict, const void *key);
 dict_node_t* 		dict_minimum				(dict_node_t *start_node);
 dict_node_t* 		dict_maximum				(dict_node_t *start_node);
 dict_node_t* 		dict_successor				(dict_node_t *start_node);
 dict_node_t* 		dict_predecessor			(dict_node_t *start_node);
+size_t 				dict_node_level				(dict_node_t *start_node);
+void 				dict_level_traverse			(dict_t *dict, size_t level, visit_func visit, void *data);
 
 void 				update_height				(dict_node_t *fix_node);
+void 				update_subtree_size			(dict_node_t *fix_node);
 void 				dict_rotate_left			(dict_t *dict, dict_node_t *fix_node);
 void 				dict_rotate_right			(dict_t *dict, dict_node_t *fix_node);
 int64_t 			dict_get_balance			(dict_node_t *fix_node);
@@ -67,4 +99,25 @@ int64_t 			dict_get_balance			(dict_node_t *fix_node);
 void 				dict_insert					(dict_t *dict, const void *key, const void *value);
 void 				dict_delete					(dict_t *dict, const void *key);
 
+void 				dict_bulk_load_stream		(dict_t *dict, bulk_next_func next_pair, void *stream);
+void 				dict_bulk_load				(dict_t *dict, const void * const *keys, const void * const *values, size_t len);
+
+size_t 				dict_rank					(dict_t *dict, const void *key);
+dict_node_t* 		dict_select					(dict_t *dict, size_t idx);
+dict_node_t* 		dict_select_key				(dict_t *dict, size_t idx);
+size_t 				dict_count_range			(dict_t *dict, const void *left, const void *right);
+dict_node_t* 		dict_most_frequent			(dict_t *dict);
+
+uint8_t 			dict_join					(dict_t *dict, dict_t *other);
+dict_t* 			dict_split_at				(dict_t *dict, const void *key);
+void 				dict_union					(dict_t *dict, dict_t *other);
+void 				dict_intersection			(dict_t *dict, dict_t *other);
+void 				dict_difference				(dict_t *dict, dict_t *other);
+
+void 				dict_insert_batch			(dict_t *dict, const void * const *keys, const void * const *values, size_t len);
+void 				dict_delete_batch			(dict_t *dict, const void * const *keys, size_t len);
+
+uint8_t 			dict_save					(dict_t *dict, const char * const filename, inline_func save_key, inline_func save_value);
+uint8_t 			dict_load					(dict_t *dict, const char * const filename);
+
 #endif /* DICT_H_ */
\ No newline at end of file
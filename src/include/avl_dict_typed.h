@@ -0,0 +1,396 @@
+#ifndef AVL_DICT_TYPED_H_
+#define AVL_DICT_TYPED_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/**
+ * @brief Macro to generate a dictionary specialized for one key type and
+ * one value type. Keys and values are stored by value inside the nodes and
+ * the keys are compared with "cmp_inline", a function or a macro taking two
+ * keys and returning a negative, zero or a positive int, so the compiler can
+ * inline every comparison. Duplicates are kept in the next/prev list exactly
+ * like in the avl_dict.h dictionary.
+ * 
+ * The generated names start with "prefix": prefix_t, prefix_node_t,
+ * prefix_create, prefix_destroy, prefix_search, prefix_minimum,
+ * prefix_maximum, prefix_successor, prefix_predecessor, prefix_insert
+ * and prefix_delete. Fixed size string keys can be used by wrapping
+ * the char array in a struct.
+ * 
+ * @param prefix prefix of the generated types and functions
+ * @param KeyT type of the keys
+ * @param ValT type of the values
+ * @param cmp_inline function or macro to compare two keys
+ */
+#define DEFINE_AVL_DICT(prefix, KeyT, ValT, cmp_inline) \
+typedef struct prefix##_node_s { \
+	KeyT key;								/* Key stored by value */ \
+	ValT value;								/* Value stored by value */ \
+	struct prefix##_node_s *parent;			/* Pointer to parent node */ \
+	struct prefix##_node_s *left;			/* Pointer to left child */ \
+	struct prefix##_node_s *right;			/* Pointer to right child */ \
+	struct prefix##_node_s *next;			/* Pointer to next node */ \
+	struct prefix##_node_s *prev;			/* Pointer to previous node */ \
+	struct prefix##_node_s *end;			/* Pointer to end node */ \
+	int64_t height;							/* Height of the node */ \
+} prefix##_node_t; \
+ \
+typedef struct prefix##_s { \
+	prefix##_node_t *root;					/* Pointer to first node in the dictionary */ \
+	size_t size;							/* The number of nodes in the dictionary */ \
+} prefix##_t; \
+ \
+static inline prefix##_t* prefix##_create(void) { \
+	prefix##_t *new_dict = malloc(sizeof(*new_dict)); \
+ \
+	if (new_dict != NULL) { \
+		new_dict->root = NULL; \
+		new_dict->size = 0; \
+	} \
+ \
+	return new_dict; \
+} \
+ \
+static inline prefix##_node_t* prefix##_minimum(prefix##_node_t *start_node) { \
+	if (start_node != NULL) { \
+		while (start_node->left != NULL) { \
+			start_node = start_node->left; \
+		} \
+	} \
+ \
+	return start_node; \
+} \
+ \
+static inline prefix##_node_t* prefix##_maximum(prefix##_node_t *start_node) { \
+	if (start_node != NULL) { \
+		while (start_node->right != NULL) { \
+			start_node = start_node->right; \
+		} \
+	} \
+ \
+	return start_node; \
+} \
+ \
+static inline void prefix##_destroy(prefix##_t *dict) { \
+	if (dict == NULL) { \
+		return; \
+	} \
+ \
+	prefix##_node_t *min_node = prefix##_minimum(dict->root); \
+ \
+	/* Iterate through all dictionary nodes */ \
+	while (min_node != NULL) { \
+		prefix##_node_t *delete_node = min_node; \
+ \
+		min_node = min_node->next; \
+		free(delete_node); \
+	} \
+ \
+	free(dict); \
+} \
+ \
+static inline prefix##_node_t* prefix##_search(prefix##_t *dict, KeyT key) { \
+	if (dict == NULL) { \
+		return NULL; \
+	} \
+ \
+	prefix##_node_t *iter = dict->root; \
+ \
+	while (iter != NULL) { \
+		int cmp_result = cmp_inline(iter->key, key); \
+ \
+		if (cmp_result > 0) { \
+			iter = iter->left; \
+		} else if (cmp_result < 0) { \
+			iter = iter->right; \
+		} else { \
+			return iter; \
+		} \
+	} \
+ \
+	return NULL; \
+} \
+ \
+static inline prefix##_node_t* prefix##_successor(prefix##_node_t *start_node) { \
+	if (start_node == NULL) { \
+		return NULL; \
+	} \
+ \
+	if (start_node->right != NULL) { \
+		return prefix##_minimum(start_node->right); \
+	} \
+ \
+	prefix##_node_t *parent_node = start_node->parent; \
+ \
+	while ((parent_node != NULL) && (parent_node->right == start_node)) { \
+		start_node = parent_node; \
+		parent_node = parent_node->parent; \
+	} \
+ \
+	return parent_node; \
+} \
+ \
+static inline prefix##_node_t* prefix##_predecessor(prefix##_node_t *start_node) { \
+	if (start_node == NULL) { \
+		return NULL; \
+	} \
+ \
+	if (start_node->left != NULL) { \
+		return prefix##_maximum(start_node->left); \
+	} \
+ \
+	prefix##_node_t *parent_node = start_node->parent; \
+ \
+	while ((parent_node != NULL) && (parent_node->left == start_node)) { \
+		start_node = parent_node; \
+		parent_node = parent_node->parent; \
+	} \
+ \
+	return parent_node; \
+} \
+ \
+static inline void prefix##_update_height(prefix##_node_t *fix_node) { \
+	int64_t left_height = (fix_node->left != NULL) ? fix_node->left->height : 0; \
+	int64_t right_height = (fix_node->right != NULL) ? fix_node->right->height : 0; \
+ \
+	fix_node->height = ((left_height >= right_height) ? left_height : right_height) + 1; \
+} \
+ \
+static inline int64_t prefix##_get_balance(prefix##_node_t *fix_node) { \
+	if (fix_node == NULL) { \
+		return 0; \
+	} \
+ \
+	int64_t left_height = (fix_node->left != NULL) ? fix_node->left->height : 0; \
+	int64_t right_height = (fix_node->right != NULL) ? fix_node->right->height : 0; \
+ \
+	return left_height - right_height; \
+} \
+ \
+/* Put "new_node" in the tree position of "old_node" */ \
+static inline void prefix##_transplant(prefix##_t *dict, prefix##_node_t *old_node, prefix##_node_t *new_node) { \
+	if (old_node->parent == NULL) { \
+		dict->root = new_node; \
+	} else if (old_node->parent->left == old_node) { \
+		old_node->parent->left = new_node; \
+	} else { \
+		old_node->parent->right = new_node; \
+	} \
+ \
+	if (new_node != NULL) { \
+		new_node->parent = old_node->parent; \
+	} \
+} \
+ \
+static inline void prefix##_rotate_left(prefix##_t *dict, prefix##_node_t *fix_node) { \
+	prefix##_node_t *rotate_node = fix_node->right; \
+ \
+	fix_node->right = rotate_node->left; \
+ \
+	if (rotate_node->left != NULL) { \
+		rotate_node->left->parent = fix_node; \
+	} \
+ \
+	prefix##_transplant(dict, fix_node, rotate_node); \
+	rotate_node->left = fix_node; \
+	fix_node->parent = rotate_node; \
+ \
+	prefix##_update_height(fix_node); \
+	prefix##_update_height(rotate_node); \
+} \
+ \
+static inline void prefix##_rotate_right(prefix##_t *dict, prefix##_node_t *fix_node) { \
+	prefix##_node_t *rotate_node = fix_node->left; \
+ \
+	fix_node->left = rotate_node->right; \
+ \
+	if (rotate_node->right != NULL) { \
+		rotate_node->right->parent = fix_node; \
+	} \
+ \
+	prefix##_transplant(dict, fix_node, rotate_node); \
+	rotate_node->right = fix_node; \
+	fix_node->parent = rotate_node; \
+ \
+	prefix##_update_height(fix_node); \
+	prefix##_update_height(rotate_node); \
+} \
+ \
+/* Rebalance every node from "fix_node" up to the root */ \
+static inline void prefix##_fix_up(prefix##_t *dict, prefix##_node_t *fix_node) { \
+	while (fix_node != NULL) { \
+		prefix##_update_height(fix_node); \
+ \
+		int64_t balance_fact = prefix##_get_balance(fix_node); \
+ \
+		if (balance_fact > 1) { \
+			if (prefix##_get_balance(fix_node->left) < 0) { \
+				prefix##_rotate_left(dict, fix_node->left); \
+			} \
+ \
+			prefix##_rotate_right(dict, fix_node); \
+		} else if (balance_fact < -1) { \
+			if (prefix##_get_balance(fix_node->right) > 0) { \
+				prefix##_rotate_right(dict, fix_node->right); \
+			} \
+ \
+			prefix##_rotate_left(dict, fix_node); \
+		} \
+ \
+		fix_node = fix_node->parent; \
+	} \
+} \
+ \
+static inline void prefix##_insert(prefix##_t *dict, KeyT key, ValT value) { \
+	if (dict == NULL) { \
+		return; \
+	} \
+ \
+	prefix##_node_t *new_node = malloc(sizeof(*new_node)); \
+ \
+	if (new_node == NULL) { \
+		return; \
+	} \
+ \
+	new_node->key = key; \
+	new_node->value = value; \
+	new_node->parent = new_node->left = new_node->right = NULL; \
+	new_node->next = new_node->prev = NULL; \
+	new_node->end = new_node; \
+	new_node->height = 1; \
+ \
+	++(dict->size); \
+ \
+	if (dict->root == NULL) { \
+		dict->root = new_node; \
+		return; \
+	} \
+ \
+	prefix##_node_t *iter = dict->root; \
+	prefix##_node_t *parent_iter = NULL; \
+	int cmp_result = 0; \
+ \
+	/* Find insert position */ \
+	while (iter != NULL) { \
+		parent_iter = iter; \
+		cmp_result = cmp_inline(key, iter->key); \
+ \
+		if (cmp_result > 0) { \
+			iter = iter->right; \
+		} else if (cmp_result < 0) { \
+			iter = iter->left; \
+		} else { \
+			break; \
+		} \
+	} \
+ \
+	if (iter != NULL) { \
+ \
+		/* Same key, add at the end of the duplicate list */ \
+		new_node->end = NULL; \
+		new_node->next = iter->end->next; \
+ \
+		if (new_node->next != NULL) { \
+			new_node->next->prev = new_node; \
+		} \
+ \
+		iter->end->next = new_node; \
+		new_node->prev = iter->end; \
+		iter->end = new_node; \
+ \
+		return; \
+	} \
+ \
+	new_node->parent = parent_iter; \
+ \
+	if (cmp_result < 0) { \
+		parent_iter->left = new_node; \
+		new_node->next = parent_iter; \
+		new_node->prev = parent_iter->prev; \
+		parent_iter->prev = new_node; \
+	} else { \
+		parent_iter->right = new_node; \
+		new_node->prev = parent_iter->end; \
+		new_node->next = parent_iter->end->next; \
+		parent_iter->end->next = new_node; \
+	} \
+ \
+	if (new_node->prev != NULL) { \
+		new_node->prev->next = new_node; \
+	} \
+ \
+	if (new_node->next != NULL) { \
+		new_node->next->prev = new_node; \
+	} \
+ \
+	prefix##_fix_up(dict, parent_iter); \
+} \
+ \
+static inline void prefix##_delete(prefix##_t *dict, KeyT key) { \
+	prefix##_node_t *iter = prefix##_search(dict, key); \
+ \
+	if (iter == NULL) { \
+		return; \
+	} \
+ \
+	--(dict->size); \
+ \
+	if (iter->end != iter) { \
+ \
+		/* Remove the last duplicate from the list */ \
+		prefix##_node_t *delete_node = iter->end; \
+		delete_node->prev->next = delete_node->next; \
+ \
+		if (delete_node->next != NULL) { \
+			delete_node->next->prev = delete_node->prev; \
+		} \
+ \
+		iter->end = delete_node->prev; \
+		free(delete_node); \
+ \
+		return; \
+	} \
+ \
+	prefix##_node_t *fix_node = iter->parent; \
+ \
+	if ((iter->left != NULL) && (iter->right != NULL)) { \
+ \
+		/* The successor node, with its list, takes the place of the node */ \
+		prefix##_node_t *successor_iter = prefix##_minimum(iter->right); \
+ \
+		if (successor_iter->parent != iter) { \
+			fix_node = successor_iter->parent; \
+ \
+			prefix##_transplant(dict, successor_iter, successor_iter->right); \
+			successor_iter->right = iter->right; \
+			successor_iter->right->parent = successor_iter; \
+		} else { \
+			fix_node = successor_iter; \
+		} \
+ \
+		prefix##_transplant(dict, iter, successor_iter); \
+		successor_iter->left = iter->left; \
+		successor_iter->left->parent = successor_iter; \
+	} else if (iter->left != NULL) { \
+		prefix##_transplant(dict, iter, iter->left); \
+	} else { \
+		prefix##_transplant(dict, iter, iter->right); \
+	} \
+ \
+	/* Remove the node from the list */ \
+	if (iter->prev != NULL) { \
+		iter->prev->next = iter->next; \
+	} \
+ \
+	if (iter->next != NULL) { \
+		iter->next->prev = iter->prev; \
+	} \
+ \
+	free(iter); \
+ \
+	prefix##_fix_up(dict, fix_node); \
+}
+
+#endif /* AVL_DICT_TYPED_H_ */
@@ -0,0 +1,104 @@
+#ifndef BTREE_DICT_H_
+#define BTREE_DICT_H_
+
+#include "avl_dict.h"
+
+#ifndef BTREE_NODE_KEYS
+#define BTREE_NODE_KEYS 15
+#endif
+
+/* A leaf that is not the root keeps a key after a delete */
+#if BTREE_NODE_KEYS < 4
+#error "BTREE_NODE_KEYS has to be at least 4"
+#endif
+
+#define BTREE_MIN_KEYS (BTREE_NODE_KEYS / 2)
+#define BTREE_MAX_HEIGHT 32
+
+/**
+ * @brief Definition of the values of one key, the first value is kept
+ * in the entry and the others in a vector, in insertion order
+ * 
+ */
+typedef struct btree_entry_s {
+	void *value;							/* Pointer to the first value location */
+	void **dup_values;						/* Vector with the values after the first one */
+	size_t count;							/* Number of values of the key */
+	size_t dup_capacity;					/* Capacity of the value vector */
+} btree_entry_t;
+
+/**
+ * @brief Definition of the part shared by the inner nodes and the leaves.
+ * The key pointers are packed first, so a search in a node reads a few
+ * cache lines instead of one node for every comparison.
+ * 
+ */
+typedef struct btree_node_s {
+	uint32_t len;							/* Number of keys in the node */
+	uint32_t is_leaf;						/* 1 for a leaf, 0 for an inner node */
+	void *keys[BTREE_NODE_KEYS];			/* Pointers to the key locations, in order */
+} btree_node_t;
+
+/**
+ * @brief Definition of an inner node, the keys of child i are smaller
+ * than key i and not smaller than key i - 1
+ * 
+ */
+typedef struct btree_inner_s {
+	btree_node_t base;						/* Keys of the node */
+	btree_node_t *children[BTREE_NODE_KEYS + 1];	/* Pointers to the children */
+} btree_inner_t;
+
+/**
+ * @brief Definition of a leaf, the leaves are linked in key order
+ * 
+ */
+typedef struct btree_leaf_s {
+	btree_node_t base;						/* Keys of the leaf */
+	struct btree_leaf_s *next;				/* Pointer to the next leaf */
+	struct btree_leaf_s *prev;				/* Pointer to the previous leaf */
+	btree_entry_t entries[BTREE_NODE_KEYS];	/* Values of every key */
+} btree_leaf_t;
+
+/**
+ * @brief Definition of the position of a key, a NULL leaf stands for no key
+ * 
+ */
+typedef struct btree_pos_s {
+	btree_leaf_t *leaf;						/* Pointer to the leaf of the key */
+	uint32_t idx;							/* Index of the key in the leaf */
+} btree_pos_t;
+
+/**
+ * @brief Definition of a B+ tree dictionary object
+ * 
+ */
+typedef struct btree_dict_s {
+	btree_node_t *root;						/* Pointer to the root node */
+	create_func create_key;					/* Function to create a key object */
+	destroy_func destroy_key;				/* Function to destroy a key object */
+	create_func create_value;				/* Function to create a value object */
+	destroy_func destroy_value;				/* Function to destroy a value object */
+	compare_func cmp;						/* Function two compare two keys */
+	size_t size;							/* The number of entries in the dictionary */
+	size_t height;							/* The number of levels, the leaves included */
+} btree_dict_t;
+
+btree_dict_t*		create_btree_dict			(create_func create_key, destroy_func destroy_key, create_func create_value, destroy_func destroy_value, compare_func cmp);
+void 				destroy_btree_dict			(btree_dict_t *dict);
+
+const void*			btree_dict_key				(btree_pos_t pos);
+size_t				btree_dict_count			(btree_pos_t pos);
+void 				btree_dict_foreach_value	(btree_pos_t pos, value_visit_func visit, void *data);
+
+btree_pos_t 		btree_dict_search			(btree_dict_t *dict, const void *key);
+btree_pos_t 		btree_dict_lower_bound		(btree_dict_t *dict, const void *key);
+btree_pos_t 		btree_dict_minimum			(btree_dict_t *dict);
+btree_pos_t 		btree_dict_maximum			(btree_dict_t *dict);
+btree_pos_t 		btree_dict_successor		(btree_pos_t pos);
+btree_pos_t 		btree_dict_predecessor		(btree_pos_t pos);
+
+void 				btree_dict_insert			(btree_dict_t *dict, const void *key, const void *value);
+void 				btree_dict_delete			(btree_dict_t *dict, const void *key);
+
+#endif /* BTREE_DICT_H_ */
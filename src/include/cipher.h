@@ -13,9 +13,18 @@ typedef struct range_s {
 } range_t;
 
 void 			build_dict_from_file			(const char * const filename, dict_t *dict);
+void 			build_dict_from_file_parallel	(const char * const filename, dict_t *dict, size_t threads);
 
 void 			encrypt							(const char * const infile, const char * const outfile, range_t *key);
 void 			decrypt							(const char * const infile, const char * const outfile, range_t *key);
+uint8_t 		encrypt_stream					(FILE *fin, FILE *fout, range_t *key);
+uint8_t 		decrypt_stream					(FILE *fin, FILE *fout, range_t *key);
+uint8_t 		encrypt_fd						(int fd_in, int fd_out, range_t *key);
+uint8_t 		decrypt_fd						(int fd_in, int fd_out, range_t *key);
+uint8_t 		encrypt_in_place				(const char * const filename, range_t *key);
+uint8_t 		decrypt_in_place				(const char * const filename, range_t *key);
+uint8_t 		encrypt_parallel				(const char * const infile, const char * const outfile, range_t *key, size_t threads);
+uint8_t 		decrypt_parallel				(const char * const infile, const char * const outfile, range_t *key, size_t threads);
 void 			print_key						(const char * const filename, range_t *key);
 
 range_t* 		inorder_key_query				(dict_t *dict);
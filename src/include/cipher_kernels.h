@@ -0,0 +1,52 @@
+#ifndef CIPHER_KERNELS_H_
+#define CIPHER_KERNELS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CIPHER_KERNEL_SCALAR 0
+#define CIPHER_KERNEL_SSSE3 1
+#define CIPHER_KERNEL_AVX2 2
+
+#define CIPHER_LETTER_LEN 26
+#define CIPHER_KEPT 0xFE
+#define CIPHER_OTHER 0xFF
+
+/**
+ * @brief Definition of a prepared key. The shift of every key position is
+ * already reduced modulo 26 and the first positions are repeated after the
+ * end, so a vector load never has to wrap. The substitution tables give
+ * the shifted letter of every shift and every letter.
+ * 
+ */
+typedef struct cipher_key_s {
+	uint8_t *shifts;						/* Shift of every key position */
+	size_t size;							/* Number of key positions */
+	uint8_t letters[256];					/* Letter of every character, CIPHER_KEPT or CIPHER_OTHER */
+	uint8_t encrypt_table[CIPHER_LETTER_LEN][CIPHER_LETTER_LEN];	/* Encrypted letter by shift and letter */
+	uint8_t decrypt_table[CIPHER_LETTER_LEN][CIPHER_LETTER_LEN];	/* Decrypted letter by shift and letter */
+} cipher_key_t;
+
+/**
+ * @brief Definition of a position in the key stream of a prepared key,
+ * several streams can share the same key
+ * 
+ */
+typedef struct cipher_stream_s {
+	const cipher_key_t *key;				/* Pointer to the prepared key */
+	size_t idx;								/* Key position of the next letter */
+} cipher_stream_t;
+
+cipher_key_t*		create_cipher_key			(const int32_t *index, size_t size);
+void				destroy_cipher_key			(cipher_key_t *key);
+
+void				cipher_encrypt_block		(cipher_stream_t *stream, char *text, size_t len);
+void				cipher_decrypt_block		(cipher_stream_t *stream, char *text, size_t len);
+size_t				cipher_count_block			(const char *text, size_t len);
+
+uint8_t				cipher_kernel_level			(void);
+uint8_t				cipher_kernel_set_level		(uint8_t level);
+
+#endif /* CIPHER_KERNELS_H_ */
@@ -0,0 +1,58 @@
+#ifndef COMPACT_DICT_H_
+#define COMPACT_DICT_H_
+
+#include "avl_dict.h"
+
+#define COMPACT_NIL UINT32_MAX
+#define COMPACT_INIT_LEN 16
+#define COMPACT_MAX_HEIGHT 64
+
+/**
+ * @brief Definition of a compact dictionary node object. The nodes live
+ * in one pool and link each other by their 32-bit index in the pool.
+ * There is no parent link, the ordered list replaces it.
+ * 
+ */
+typedef struct compact_node_s {
+	void *key;								/* Pointer to key location */
+	void *value;							/* Pointer to value location */
+	uint32_t left;							/* Index of left child */
+	uint32_t right;							/* Index of right child */
+	uint32_t next;							/* Index of next node */
+	uint32_t prev;							/* Index of previous node */
+	uint32_t end;							/* Index of end node for a key head, of the key head for a duplicate */
+	uint8_t height;							/* Height of the node */
+} compact_node_t;
+
+/**
+ * @brief Definition of a compact dictionary object
+ * 
+ */
+typedef struct compact_dict_s {
+	compact_node_t *pool;					/* Pointer to the node pool */
+	uint32_t capacity;						/* Number of nodes in the pool */
+	uint32_t used;							/* Number of pool nodes handed out at least once */
+	uint32_t free_head;						/* Index of the first released node */
+	uint32_t root;							/* Index of the root node */
+	create_func create_key;					/* Function to create a key object */
+	destroy_func destroy_key;				/* Function to destroy a key object */
+	create_func create_value;				/* Function to create a value object */
+	destroy_func destroy_value;				/* Function to destroy a value object */
+	compare_func cmp;						/* Function two compare two keys */
+	size_t size;							/* The number of nodes in the dictionary */
+} compact_dict_t;
+
+compact_dict_t*		create_compact_dict			(create_func create_key, destroy_func destroy_key, create_func create_value, destroy_func destroy_value, compare_func cmp);
+void 				destroy_compact_dict		(compact_dict_t *dict);
+compact_node_t*		compact_dict_node			(compact_dict_t *dict, uint32_t idx);
+
+uint32_t 			compact_dict_search			(compact_dict_t *dict, const void *key);
+uint32_t 			compact_dict_minimum		(compact_dict_t *dict);
+uint32_t 			compact_dict_maximum		(compact_dict_t *dict);
+uint32_t 			compact_dict_successor		(compact_dict_t *dict, uint32_t idx);
+uint32_t 			compact_dict_predecessor	(compact_dict_t *dict, uint32_t idx);
+
+void 				compact_dict_insert			(compact_dict_t *dict, const void *key, const void *value);
+void 				compact_dict_delete			(compact_dict_t *dict, const void *key);
+
+#endif /* COMPACT_DICT_H_ */
@@ -0,0 +1,35 @@
+#ifndef CONCURRENT_DICT_H_
+#define CONCURRENT_DICT_H_
+
+#include <pthread.h>
+
+#include "avl_dict.h"
+
+/**
+ * @brief Definition of a dictionary object shared between threads.
+ * Readers hold the lock in shared mode while they search or walk
+ * the ordered list, writers hold it in exclusive mode for the whole
+ * insert or delete, so every writer blocks all the readers.
+ * 
+ */
+typedef struct concurrent_dict_s {
+	dict_t *dict;							/* Pointer to the guarded dictionary */
+	pthread_rwlock_t lock;					/* Reader-writer lock of the dictionary */
+} concurrent_dict_t;
+
+concurrent_dict_t*	create_concurrent_dict		(create_func create_key, destroy_func destroy_key, create_func create_value, destroy_func destroy_value, compare_func cmp);
+void 				destroy_concurrent_dict		(concurrent_dict_t *cdict);
+
+dict_t*				concurrent_dict_read_begin	(concurrent_dict_t *cdict);
+void 				concurrent_dict_read_end	(concurrent_dict_t *cdict);
+dict_t*				concurrent_dict_write_begin	(concurrent_dict_t *cdict);
+void 				concurrent_dict_write_end	(concurrent_dict_t *cdict);
+
+uint8_t 			concurrent_dict_search		(concurrent_dict_t *cdict, const void *key, visit_func visit, void *data);
+size_t 				concurrent_dict_range		(concurrent_dict_t *cdict, const void *left, const void *right, visit_func visit, void *data);
+size_t 				concurrent_dict_size		(concurrent_dict_t *cdict);
+
+void 				concurrent_dict_insert		(concurrent_dict_t *cdict, const void *key, const void *value);
+void 				concurrent_dict_delete		(concurrent_dict_t *cdict, const void *key);
+
+#endif /* CONCURRENT_DICT_H_ */
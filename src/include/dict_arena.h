@@ -0,0 +1,44 @@
+#ifndef DICT_ARENA_H_
+#define DICT_ARENA_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ARENA_DEFAULT_SLAB_LEN 4096
+#define ARENA_HUGE_PAGE_SIZE (2UL * 1024UL * 1024UL)
+
+/**
+ * @brief Definition of a slab header, the objects follow the header
+ * 
+ */
+typedef struct dict_slab_s {
+	struct dict_slab_s *next;				/* Pointer to the next slab in the chain */
+	size_t bytes;							/* Number of bytes reserved for the slab */
+	uint8_t is_mapped;						/* 1 if the slab was reserved with mmap */
+} dict_slab_t;
+
+/**
+ * @brief Definition of a fixed size object arena
+ * 
+ */
+typedef struct dict_arena_s {
+	dict_slab_t *slabs;						/* Pointer to the slab chain */
+	void *free_list;						/* Pointer to the first released object */
+	uint8_t *bump;							/* Next unused object from the newest slab */
+	uint8_t *bump_end;						/* End of the newest slab */
+	size_t obj_size;						/* Size of one object in bytes */
+	size_t slab_len;						/* Number of objects in one slab */
+	uint8_t use_huge_pages;					/* 1 if large slabs are backed by huge pages */
+	size_t refs;							/* Number of dictionaries using the arena */
+} dict_arena_t;
+
+dict_arena_t*		create_dict_arena			(size_t obj_size, size_t slab_len, uint8_t use_huge_pages);
+void*				dict_arena_alloc			(dict_arena_t *arena);
+void				dict_arena_free				(dict_arena_t *arena, void *obj);
+dict_arena_t*		dict_arena_share			(dict_arena_t *arena);
+uint8_t				dict_arena_merge			(dict_arena_t *dest, dict_arena_t *src);
+void				destroy_dict_arena			(dict_arena_t *arena);
+
+#endif /* DICT_ARENA_H_ */
@@ -0,0 +1,68 @@
+#ifndef FROZEN_DICT_H_
+#define FROZEN_DICT_H_
+
+#include "avl_dict.h"
+
+#define FROZEN_NIL 0
+#define FROZEN_VERSION 1
+#define FROZEN_ALIGN 64
+
+/**
+ * @brief Definition of the header of a frozen dictionary image. The
+ * arrays follow it in the same memory block or file, at the given
+ * offsets, so the image can be used right after it is mapped.
+ * 
+ */
+typedef struct frozen_header_s {
+	char magic[8];							/* FROZEN_MAGIC */
+	uint32_t version;						/* FROZEN_VERSION */
+	uint32_t key_stride;					/* Number of bytes of one inline key */
+	uint64_t value_stride;					/* Number of bytes of one inline value */
+	uint64_t len;							/* Number of distinct keys */
+	uint64_t size;							/* Number of entries, duplicates included */
+	uint64_t keys_offset;					/* Offset of the keys, in Eytzinger order */
+	uint64_t firsts_offset;					/* Offset of the first entry index of every key, in Eytzinger order */
+	uint64_t values_offset;					/* Offset of the values, in key order */
+	uint64_t bytes;							/* Number of bytes of the image */
+} frozen_header_t;
+
+/**
+ * @brief Definition of a frozen dictionary object. The distinct keys are
+ * stored inline in Eytzinger order: the children of slot k are the slots
+ * 2k and 2k + 1, slot 0 is not used. A slot number is the position of a
+ * key, FROZEN_NIL stands for no key.
+ * 
+ */
+typedef struct frozen_dict_s {
+	const uint8_t *image;					/* Pointer to the image, header first */
+	size_t bytes;							/* Number of bytes of the image */
+	uint8_t is_mapped;						/* 1 if the image is mapped from a file */
+	const uint8_t *keys;					/* Pointer to the inline keys */
+	const uint64_t *firsts;					/* Pointer to the first entry index of every key, slot 0 holds the size */
+	const uint8_t *values;					/* Pointer to the inline values */
+	size_t key_stride;						/* Number of bytes of one inline key */
+	size_t value_stride;					/* Number of bytes of one inline value */
+	size_t len;								/* Number of distinct keys */
+	size_t size;							/* Number of entries, duplicates included */
+	compare_func cmp;						/* Function two compare two inline keys */
+} frozen_dict_t;
+
+frozen_dict_t*		dict_freeze					(dict_t *dict, size_t key_len, inline_func inline_key, size_t value_len, inline_func inline_value);
+uint8_t				frozen_dict_save			(frozen_dict_t *frozen, const char * const filename);
+frozen_dict_t*		frozen_dict_map				(const char * const filename, compare_func cmp);
+void				destroy_frozen_dict			(frozen_dict_t *frozen);
+
+const void*			frozen_dict_key				(frozen_dict_t *frozen, size_t slot);
+size_t				frozen_dict_count			(frozen_dict_t *frozen, size_t slot);
+const void*			frozen_dict_value			(frozen_dict_t *frozen, size_t slot, size_t idx);
+
+size_t				frozen_dict_search			(frozen_dict_t *frozen, const void *key);
+size_t				frozen_dict_lower_bound		(frozen_dict_t *frozen, const void *key);
+size_t				frozen_dict_upper_bound		(frozen_dict_t *frozen, const void *key);
+size_t				frozen_dict_minimum			(frozen_dict_t *frozen);
+size_t				frozen_dict_maximum			(frozen_dict_t *frozen);
+size_t				frozen_dict_successor		(frozen_dict_t *frozen, size_t slot);
+size_t				frozen_dict_predecessor		(frozen_dict_t *frozen, size_t slot);
+size_t				frozen_dict_count_range		(frozen_dict_t *frozen, const void *left, const void *right);
+
+#endif /* FROZEN_DICT_H_ */
@@ -0,0 +1,76 @@
+#ifndef PERSISTENT_DICT_H_
+#define PERSISTENT_DICT_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "avl_dict.h"
+
+/**
+ * @brief Definition of one entry of a key. The entries of a key form
+ * a stack, newest first, shared by all the versions that hold the key.
+ * 
+ */
+typedef struct persistent_entry_s {
+	void *key;								/* Pointer to key location */
+	void *value;							/* Pointer to value location */
+	struct persistent_entry_s *next;		/* Pointer to the previous entry of the key */
+	atomic_size_t refs;						/* Number of nodes and entries pointing here */
+} persistent_entry_t;
+
+/**
+ * @brief Definition of a persistent dictionary node. A node is never
+ * changed while another version can reach it, the writers copy it.
+ * 
+ */
+typedef struct persistent_node_s {
+	persistent_entry_t *entries;			/* Pointer to the newest entry of the key */
+	struct persistent_node_s *left;			/* Pointer to left child */
+	struct persistent_node_s *right;		/* Pointer to right child */
+	int64_t height;							/* Height of the node */
+	size_t count;							/* Number of entries of the key */
+	atomic_size_t refs;						/* Number of nodes and versions pointing here */
+} persistent_node_t;
+
+/**
+ * @brief Definition of an immutable version of the dictionary
+ * 
+ */
+typedef struct persistent_version_s {
+	persistent_node_t *root;				/* Pointer to the root of the version */
+	size_t size;							/* The number of entries in the version */
+	atomic_size_t refs;						/* Number of snapshots, plus one while the dictionary holds it */
+	struct persistent_version_s *next;		/* Pointer to the next retired version */
+} persistent_version_t;
+
+/**
+ * @brief Definition of a persistent dictionary object
+ * 
+ */
+typedef struct persistent_dict_s {
+	_Atomic(persistent_version_t *) current;/* Pointer to the newest version */
+	persistent_version_t *retired;			/* Versions waiting for the readers to leave */
+	atomic_size_t readers;					/* Number of readers taking a snapshot right now */
+	pthread_mutex_t writer;					/* Lock of the writers */
+	create_func create_key;					/* Function to create a key object */
+	destroy_func destroy_key;				/* Function to destroy a key object */
+	create_func create_value;				/* Function to create a value object */
+	destroy_func destroy_value;				/* Function to destroy a value object */
+	compare_func cmp;						/* Function two compare two keys */
+} persistent_dict_t;
+
+typedef void 		(*persistent_visit_func)	(persistent_node_t *node, void *data);
+
+persistent_dict_t*	create_persistent_dict		(create_func create_key, destroy_func destroy_key, create_func create_value, destroy_func destroy_value, compare_func cmp);
+void 				destroy_persistent_dict		(persistent_dict_t *dict);
+
+persistent_version_t*	persistent_dict_snapshot	(persistent_dict_t *dict);
+void 				persistent_dict_release		(persistent_dict_t *dict, persistent_version_t *snapshot);
+
+persistent_node_t*	persistent_snapshot_search	(persistent_dict_t *dict, persistent_version_t *snapshot, const void *key);
+void 				persistent_snapshot_foreach	(persistent_version_t *snapshot, persistent_visit_func visit, void *data);
+
+void 				persistent_dict_insert		(persistent_dict_t *dict, const void *key, const void *value);
+void 				persistent_dict_delete		(persistent_dict_t *dict, const void *key);
+
+#endif /* PERSISTENT_DICT_H_ */
@@ -0,0 +1,33 @@
+#ifndef SHARDED_DICT_H_
+#define SHARDED_DICT_H_
+
+#include "concurrent_dict.h"
+
+/**
+ * @brief Definition of a dictionary split by key ranges in independent
+ * shards. Shard "i" holds the keys from split_keys[i - 1], included,
+ * up to split_keys[i], excluded.
+ * 
+ */
+typedef struct sharded_dict_s {
+	concurrent_dict_t **shards;				/* Array of shards, each with its own lock */
+	size_t shards_len;						/* Number of shards */
+	void **split_keys;						/* Sorted array with the first key of every shard but the first */
+	destroy_func destroy_key;				/* Function to destroy a key object */
+	compare_func cmp;						/* Function two compare two keys */
+} sharded_dict_t;
+
+sharded_dict_t*		create_sharded_dict			(create_func create_key, destroy_func destroy_key, create_func create_value, destroy_func destroy_value, compare_func cmp, const void **split_keys, size_t split_len);
+void 				destroy_sharded_dict		(sharded_dict_t *sdict);
+size_t 				sharded_dict_shard			(sharded_dict_t *sdict, const void *key);
+
+uint8_t 			sharded_dict_search			(sharded_dict_t *sdict, const void *key, visit_func visit, void *data);
+uint8_t 			sharded_dict_minimum		(sharded_dict_t *sdict, visit_func visit, void *data);
+uint8_t 			sharded_dict_maximum		(sharded_dict_t *sdict, visit_func visit, void *data);
+size_t 				sharded_dict_range			(sharded_dict_t *sdict, const void *left, const void *right, visit_func visit, void *data);
+size_t 				sharded_dict_size			(sharded_dict_t *sdict);
+
+void 				sharded_dict_insert			(sharded_dict_t *sdict, const void *key, const void *value);
+void 				sharded_dict_delete			(sharded_dict_t *sdict, const void *key);
+
+#endif /* SHARDED_DICT_H_ */
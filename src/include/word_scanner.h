@@ -0,0 +1,40 @@
+#ifndef WORD_SCANNER_H_
+#define WORD_SCANNER_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define WORD_SEPARATOR ",.? \n\r"
+#define WORD_SCAN_SCALAR 0
+#define WORD_SCAN_SSE2 1
+#define WORD_SCAN_AVX2 2
+
+/**
+ * @brief Definition of one word found by the scanner
+ * 
+ */
+typedef struct word_slice_s {
+	size_t start;							/* Offset of the first character of the word */
+	size_t len;								/* Number of characters in the word */
+} word_slice_t;
+
+extern const uint8_t word_separator_table[256];
+
+/**
+ * @brief Function to check if a character ends a word, the characters
+ * from WORD_SEPARATOR and the string terminator end a word
+ * 
+ * @param c the character to check
+ * @return uint8_t 1 if the character is a separator, 0 otherwise
+ */
+static inline uint8_t word_is_separator(char c) {
+	return word_separator_table[(uint8_t)c];
+}
+
+size_t				word_scan					(const char *text, size_t len, size_t *pos, word_slice_t *slices, size_t slices_len);
+uint8_t				word_scan_level				(void);
+uint8_t				word_scan_set_level			(uint8_t level);
+
+#endif /* WORD_SCANNER_H_ */
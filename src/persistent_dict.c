@@ -0,0 +1,607 @@
+#include "include/persistent_dict.h"
+
+#define HEIGHT(node) (((node) == NULL) ? 0 : (node)->height)
+#define MAX(a, b) (((a) >= (b))?(a):(b))
+
+/**
+ * @brief Function to drop one reference of an entry stack,
+ * the entries left without references are destroyed
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param entry pointer to the newest entry of the stack
+ */
+static void persistent_entry_release(persistent_dict_t *dict, persistent_entry_t *entry) {
+	/* Iterate while the stack is not shared anymore */
+	while ((entry != NULL) && (atomic_fetch_sub(&entry->refs, 1) == 1)) {
+		persistent_entry_t *next = entry->next;
+
+		dict->destroy_key(entry->key);
+		dict->destroy_value(entry->value);
+		free(entry);
+
+		entry = next;
+	}
+}
+
+/**
+ * @brief Function to add one more reference to a node
+ * 
+ * @param node pointer to a persistent node or NULL
+ * @return persistent_node_t* the same node
+ */
+static persistent_node_t* persistent_node_retain(persistent_node_t *node) {
+	if (node != NULL) {
+		atomic_fetch_add(&node->refs, 1);
+	}
+
+	return node;
+}
+
+/**
+ * @brief Function to drop one reference of a node, a node left
+ * without references is freed together with its references
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param node pointer to a persistent node or NULL
+ */
+static void persistent_node_release(persistent_dict_t *dict, persistent_node_t *node) {
+	if ((node == NULL) || (atomic_fetch_sub(&node->refs, 1) != 1)) {
+		return;
+	}
+
+	persistent_entry_release(dict, node->entries);
+	persistent_node_release(dict, node->left);
+	persistent_node_release(dict, node->right);
+
+	free(node);
+}
+
+/**
+ * @brief Function to create a node with the first entry of a key
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param key pointer to a key location
+ * @param value pointer to a value location
+ * @return persistent_node_t* pointer to the new node
+ */
+static persistent_node_t* persistent_node_create(persistent_dict_t *dict, const void *key, const void *value) {
+	persistent_node_t *new_node = malloc(sizeof(*new_node));
+	persistent_entry_t *new_entry = malloc(sizeof(*new_entry));
+
+	if ((new_node == NULL) || (new_entry == NULL)) {
+		printf("Error at malloc\n");
+		exit(EXIT_FAILURE);
+	}
+
+	new_entry->key = dict->create_key(key);
+	new_entry->value = dict->create_value(value);
+	new_entry->next = NULL;
+	atomic_init(&new_entry->refs, 1);
+
+	new_node->entries = new_entry;
+	new_node->left = new_node->right = NULL;
+	new_node->height = 1;
+	new_node->count = 1;
+	atomic_init(&new_node->refs, 1);
+
+	return new_node;
+}
+
+/**
+ * @brief Function to get a node that the writer may change. The node is
+ * kept if the caller holds its only reference, otherwise it is copied
+ * and the reference of the caller moves to the copy.
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param node pointer to a persistent node, the reference is consumed
+ * @return persistent_node_t* pointer to a node with one reference or NULL
+ */
+static persistent_node_t* persistent_node_unique(persistent_dict_t *dict, persistent_node_t *node) {
+	if (atomic_load(&node->refs) == 1) {
+		return node;
+	}
+
+	persistent_node_t *new_node = malloc(sizeof(*new_node));
+
+	if (new_node == NULL) {
+		printf("Error at malloc\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* The copy shares the children and the entries */
+	new_node->entries = node->entries;
+	atomic_fetch_add(&node->entries->refs, 1);
+	new_node->left = persistent_node_retain(node->left);
+	new_node->right = persistent_node_retain(node->right);
+	new_node->height = node->height;
+	new_node->count = node->count;
+	atomic_init(&new_node->refs, 1);
+
+	persistent_node_release(dict, node);
+
+	return new_node;
+}
+
+/**
+ * @brief Function to rotate to the left a node the writer owns
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param node pointer to a node with one reference
+ * @return persistent_node_t* pointer to the new root of the sub-tree
+ */
+static persistent_node_t* persistent_rotate_left(persistent_dict_t *dict, persistent_node_t *node) {
+	persistent_node_t *right = persistent_node_unique(dict, node->right);
+
+	node->right = right->left;
+	right->left = node;
+
+	node->height = 1 + MAX(HEIGHT(node->left), HEIGHT(node->right));
+	right->height = 1 + MAX(HEIGHT(right->left), HEIGHT(right->right));
+
+	return right;
+}
+
+/**
+ * @brief Function to rotate to the right a node the writer owns
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param node pointer to a node with one reference
+ * @return persistent_node_t* pointer to the new root of the sub-tree
+ */
+static persistent_node_t* persistent_rotate_right(persistent_dict_t *dict, persistent_node_t *node) {
+	persistent_node_t *left = persistent_node_unique(dict, node->left);
+
+	node->left = left->right;
+	left->right = node;
+
+	node->height = 1 + MAX(HEIGHT(node->left), HEIGHT(node->right));
+	left->height = 1 + MAX(HEIGHT(left->left), HEIGHT(left->right));
+
+	return left;
+}
+
+/**
+ * @brief Function to update the height of a node the writer owns and
+ * to balance its sub-tree, copying the shared nodes that are rotated
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param node pointer to a node with one reference
+ * @return persistent_node_t* pointer to the new root of the sub-tree
+ */
+static persistent_node_t* persistent_balance(persistent_dict_t *dict, persistent_node_t *node) {
+	node->height = 1 + MAX(HEIGHT(node->left), HEIGHT(node->right));
+
+	int64_t balance = HEIGHT(node->left) - HEIGHT(node->right);
+
+	if (balance > 1) {
+		if (HEIGHT(node->left->left) < HEIGHT(node->left->right)) {
+			node->left = persistent_rotate_left(dict, persistent_node_unique(dict, node->left));
+		}
+
+		return persistent_rotate_right(dict, node);
+	}
+
+	if (balance < -1) {
+		if (HEIGHT(node->right->right) < HEIGHT(node->right->left)) {
+			node->right = persistent_rotate_right(dict, persistent_node_unique(dict, node->right));
+		}
+
+		return persistent_rotate_left(dict, node);
+	}
+
+	return node;
+}
+
+/**
+ * @brief Subroutine function of the insert, it copies the path
+ * from the sub-tree root to the key
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param node pointer to the sub-tree root or NULL, the reference is consumed
+ * @param key pointer to a key location
+ * @param value pointer to a value location
+ * @return persistent_node_t* pointer to the new sub-tree root
+ */
+static persistent_node_t* persistent_insert_helper(persistent_dict_t *dict, persistent_node_t *node, const void *key, const void *value) {
+	if (node == NULL) {
+		return persistent_node_create(dict, key, value);
+	}
+
+	node = persistent_node_unique(dict, node);
+
+	int32_t cmp_result = dict->cmp(node->entries->key, key);
+
+	if (cmp_result == 0) {
+		persistent_entry_t *new_entry = malloc(sizeof(*new_entry));
+
+		if (new_entry == NULL) {
+			printf("Error at malloc\n");
+			exit(EXIT_FAILURE);
+		}
+
+		/* The new entry takes the reference of the node to the old stack */
+		new_entry->key = dict->create_key(key);
+		new_entry->value = dict->create_value(value);
+		new_entry->next = node->entries;
+		atomic_init(&new_entry->refs, 1);
+
+		node->entries = new_entry;
+		++(node->count);
+
+		return node;
+	}
+
+	if (cmp_result > 0) {
+		node->left = persistent_insert_helper(dict, node->left, key, value);
+	} else {
+		node->right = persistent_insert_helper(dict, node->right, key, value);
+	}
+
+	return persistent_balance(dict, node);
+}
+
+/**
+ * @brief Subroutine function of the delete to unlink the minimum
+ * node of a sub-tree
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param node pointer to the sub-tree root, the reference is consumed
+ * @return persistent_node_t* pointer to the new sub-tree root or NULL
+ */
+static persistent_node_t* persistent_delete_min(persistent_dict_t *dict, persistent_node_t *node) {
+	if (node->left == NULL) {
+		persistent_node_t *right = persistent_node_retain(node->right);
+
+		persistent_node_release(dict, node);
+
+		return right;
+	}
+
+	node = persistent_node_unique(dict, node);
+	node->left = persistent_delete_min(dict, node->left);
+
+	return persistent_balance(dict, node);
+}
+
+/**
+ * @brief Subroutine function of the delete, it copies the path
+ * from the sub-tree root to the key
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param node pointer to the sub-tree root or NULL, the reference is consumed
+ * @param key pointer to a key location that is in the sub-tree
+ * @return persistent_node_t* pointer to the new sub-tree root or NULL
+ */
+static persistent_node_t* persistent_delete_helper(persistent_dict_t *dict, persistent_node_t *node, const void *key) {
+	if (node == NULL) {
+		return NULL;
+	}
+
+	int32_t cmp_result = dict->cmp(node->entries->key, key);
+
+	if ((cmp_result == 0) && ((node->left == NULL) || (node->right == NULL))) {
+		if (node->count == 1) {
+
+			/* The only child takes the place of the node */
+			persistent_node_t *child = persistent_node_retain((node->left != NULL) ? node->left : node->right);
+
+			persistent_node_release(dict, node);
+
+			return child;
+		}
+	}
+
+	node = persistent_node_unique(dict, node);
+
+	if (cmp_result == 0) {
+		persistent_entry_t *delete_entry = node->entries;
+
+		if (node->count > 1) {
+
+			/* Remove the newest entry of the key */
+			node->entries = delete_entry->next;
+			atomic_fetch_add(&node->entries->refs, 1);
+			--(node->count);
+
+			persistent_entry_release(dict, delete_entry);
+
+			return node;
+		}
+
+		/* The minimum of the right sub-tree takes the place of the node */
+		persistent_node_t *min_node = node->right;
+
+		while (min_node->left != NULL) {
+			min_node = min_node->left;
+		}
+
+		node->entries = min_node->entries;
+		atomic_fetch_add(&node->entries->refs, 1);
+		node->count = min_node->count;
+		node->right = persistent_delete_min(dict, node->right);
+
+		persistent_entry_release(dict, delete_entry);
+	} else if (cmp_result > 0) {
+		node->left = persistent_delete_helper(dict, node->left, key);
+	} else {
+		node->right = persistent_delete_helper(dict, node->right, key);
+	}
+
+	return persistent_balance(dict, node);
+}
+
+/**
+ * @brief Function to free a version and to release its tree
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param version pointer to the version, the reference is consumed
+ */
+static void persistent_version_release(persistent_dict_t *dict, persistent_version_t *version) {
+	if (atomic_fetch_sub(&version->refs, 1) != 1) {
+		return;
+	}
+
+	persistent_node_release(dict, version->root);
+	free(version);
+}
+
+/**
+ * @brief Function to make a new tree the newest version. The versions
+ * it replaces are released once no reader is between reading the newest
+ * version and taking its reference, readers that already took one keep
+ * their versions alive.
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param root pointer to the root of the new tree, the reference is consumed
+ * @param size the number of entries in the new tree
+ */
+static void persistent_publish(persistent_dict_t *dict, persistent_node_t *root, size_t size) {
+	persistent_version_t *new_version = malloc(sizeof(*new_version));
+
+	if (new_version == NULL) {
+		printf("Error at malloc\n");
+		exit(EXIT_FAILURE);
+	}
+
+	new_version->root = root;
+	new_version->size = size;
+	new_version->next = NULL;
+	atomic_init(&new_version->refs, 1);
+
+	persistent_version_t *old_version = atomic_exchange(&dict->current, new_version);
+
+	old_version->next = dict->retired;
+	dict->retired = old_version;
+
+	/* Grace period, the new readers can only see the new version */
+	if (atomic_load(&dict->readers) == 0) {
+		while (dict->retired != NULL) {
+			persistent_version_t *version = dict->retired;
+
+			dict->retired = version->next;
+			persistent_version_release(dict, version);
+		}
+	}
+}
+
+/**
+ * @brief Function to create a persistent dictionary object. Every
+ * change makes a new version that copies just the changed path, so
+ * the snapshots taken before stay the same.
+ * 
+ * @param create_key Function to create a key object
+ * @param destroy_key Function to destroy a key object
+ * @param create_value Function to create a value object
+ * @param destroy_value Function to destroy a value object
+ * @param cmp Function two compare two keys
+ * @return persistent_dict_t* pointer to an allocated persistent dictionary object or NULL
+ */
+persistent_dict_t* create_persistent_dict(create_func create_key, destroy_func destroy_key, create_func create_value, destroy_func destroy_value, compare_func cmp) {
+	persistent_dict_t *new_dict = malloc(sizeof(*new_dict));
+
+	if (new_dict == NULL) {
+		return NULL;
+	}
+
+	persistent_version_t *empty_version = malloc(sizeof(*empty_version));
+
+	if ((empty_version == NULL) || (pthread_mutex_init(&new_dict->writer, NULL) != 0)) {
+		free(empty_version);
+		free(new_dict);
+		return NULL;
+	}
+
+	empty_version->root = NULL;
+	empty_version->size = 0;
+	empty_version->next = NULL;
+	atomic_init(&empty_version->refs, 1);
+
+	atomic_init(&new_dict->current, empty_version);
+	new_dict->retired = NULL;
+	atomic_init(&new_dict->readers, 0);
+	new_dict->create_key = create_key;
+	new_dict->destroy_key = destroy_key;
+	new_dict->create_value = create_value;
+	new_dict->destroy_value = destroy_value;
+	new_dict->cmp = cmp;
+
+	return new_dict;
+}
+
+/**
+ * @brief Function to free all memory loaded for the persistent dictionary
+ * object. All the snapshots must be released before.
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ */
+void destroy_persistent_dict(persistent_dict_t *dict) {
+	/* Check if input data is valid */
+	if (dict == NULL) {
+		return;
+	}
+
+	while (dict->retired != NULL) {
+		persistent_version_t *version = dict->retired;
+
+		dict->retired = version->next;
+		persistent_version_release(dict, version);
+	}
+
+	persistent_version_release(dict, atomic_load(&dict->current));
+	pthread_mutex_destroy(&dict->writer);
+
+	free(dict);
+}
+
+/**
+ * @brief Function to take the newest version without any lock.
+ * The snapshot does not change and stays valid until
+ * persistent_dict_release, whatever the writers do.
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @return persistent_version_t* pointer to the snapshot or NULL
+ */
+persistent_version_t* persistent_dict_snapshot(persistent_dict_t *dict) {
+	/* Check if input data is valid */
+	if (dict == NULL) {
+		return NULL;
+	}
+
+	/* Keep the writers from releasing the version before it has our reference */
+	atomic_fetch_add(&dict->readers, 1);
+
+	persistent_version_t *snapshot = atomic_load(&dict->current);
+	atomic_fetch_add(&snapshot->refs, 1);
+
+	atomic_fetch_sub(&dict->readers, 1);
+
+	return snapshot;
+}
+
+/**
+ * @brief Function to give back a snapshot, the last reference
+ * of an old version frees the nodes used by no other version
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param snapshot pointer to a snapshot of the same dictionary
+ */
+void persistent_dict_release(persistent_dict_t *dict, persistent_version_t *snapshot) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (snapshot == NULL)) {
+		return;
+	}
+
+	persistent_version_release(dict, snapshot);
+}
+
+/**
+ * @brief Function to search a key in a snapshot
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param snapshot pointer to a snapshot of the same dictionary
+ * @param key pointer to a key location
+ * @return persistent_node_t* pointer to the node of the key or NULL
+ */
+persistent_node_t* persistent_snapshot_search(persistent_dict_t *dict, persistent_version_t *snapshot, const void *key) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (snapshot == NULL) || (key == NULL)) {
+		return NULL;
+	}
+
+	persistent_node_t *iter = snapshot->root;
+
+	while (iter != NULL) {
+		int32_t cmp_result = dict->cmp(iter->entries->key, key);
+
+		if (cmp_result == 0) {
+			return iter;
+		}
+
+		iter = (cmp_result > 0) ? iter->left : iter->right;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Subroutine function of the inorder walk of a snapshot
+ * 
+ * @param node pointer to the sub-tree root
+ * @param visit Function to call for every node
+ * @param data pointer passed to every "visit" call
+ */
+static void persistent_foreach_helper(persistent_node_t *node, persistent_visit_func visit, void *data) {
+	while (node != NULL) {
+		persistent_foreach_helper(node->left, visit, data);
+		visit(node, data);
+
+		node = node->right;
+	}
+}
+
+/**
+ * @brief Function to visit the keys of a snapshot in order,
+ * the entries of a key are on the node stack, newest first
+ * 
+ * @param snapshot pointer to a snapshot
+ * @param visit Function to call for every node
+ * @param data pointer passed to every "visit" call
+ */
+void persistent_snapshot_foreach(persistent_version_t *snapshot, persistent_visit_func visit, void *data) {
+	/* Check if input data is valid */
+	if ((snapshot == NULL) || (visit == NULL)) {
+		return;
+	}
+
+	persistent_foreach_helper(snapshot->root, visit, data);
+}
+
+/**
+ * @brief Function to insert a new entry and to publish the new version
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param key pointer to a key location
+ * @param value pointer to a value location
+ */
+void persistent_dict_insert(persistent_dict_t *dict, const void *key, const void *value) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (key == NULL) || (value == NULL)) {
+		return;
+	}
+
+	pthread_mutex_lock(&dict->writer);
+
+	persistent_version_t *version = atomic_load(&dict->current);
+	persistent_node_t *root = persistent_insert_helper(dict, persistent_node_retain(version->root), key, value);
+
+	persistent_publish(dict, root, version->size + 1);
+
+	pthread_mutex_unlock(&dict->writer);
+}
+
+/**
+ * @brief Function to delete the newest entry of a key
+ * and to publish the new version
+ * 
+ * @param dict pointer to an allocated persistent dictionary object
+ * @param key pointer to a key location
+ */
+void persistent_dict_delete(persistent_dict_t *dict, const void *key) {
+	/* Check if input data is valid */
+	if ((dict == NULL) || (key == NULL)) {
+		return;
+	}
+
+	pthread_mutex_lock(&dict->writer);
+
+	persistent_version_t *version = atomic_load(&dict->current);
+
+	/* A missing key does not make a new version */
+	if (persistent_snapshot_search(dict, version, key) != NULL) {
+		persistent_node_t *root = persistent_delete_helper(dict, persistent_node_retain(version->root), key);
+
+		persistent_publish(dict, root, version->size - 1);
+	}
+
+	pthread_mutex_unlock(&dict->writer);
+}
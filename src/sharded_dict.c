@@ -0,0 +1,287 @@
+#include "include/sharded_dict.h"
+
+/**
+ * @brief Function to create a dictionary split in shards by key ranges.
+ * The threads that change keys of different shards do not wait for
+ * each other.
+ * 
+ * @param create_key Function to create a key object
+ * @param destroy_key Function to destroy a key object
+ * @param create_value Function to create a value object
+ * @param destroy_value Function to destroy a value object
+ * @param cmp Function two compare two keys
+ * @param split_keys sorted array with the first key of every shard but the first
+ * @param split_len number of split keys, the dictionary has one more shard
+ * @return sharded_dict_t* pointer to an allocated sharded dictionary object or NULL
+ */
+sharded_dict_t* create_sharded_dict(create_func create_key, destroy_func destroy_key, create_func create_value, destroy_func destroy_value, compare_func cmp, const void **split_keys, size_t split_len) {
+	/* Check if input data is valid */
+	if ((split_len != 0) && (split_keys == NULL)) {
+		return NULL;
+	}
+
+	for (size_t iter = 1; iter < split_len; ++iter) {
+		if (cmp(split_keys[iter - 1], split_keys[iter]) >= 0) {
+			return NULL;
+		}
+	}
+
+	sharded_dict_t *new_sdict = malloc(sizeof(*new_sdict));
+
+	if (new_sdict == NULL) {
+		return NULL;
+	}
+
+	new_sdict->shards_len = split_len + 1;
+	new_sdict->shards = calloc(new_sdict->shards_len, sizeof(*new_sdict->shards));
+	new_sdict->split_keys = calloc(split_len + 1, sizeof(*new_sdict->split_keys));
+	new_sdict->destroy_key = destroy_key;
+	new_sdict->cmp = cmp;
+
+	if ((new_sdict->shards == NULL) || (new_sdict->split_keys == NULL)) {
+		free(new_sdict->shards);
+		free(new_sdict->split_keys);
+		free(new_sdict);
+		return NULL;
+	}
+
+	for (size_t iter = 0; iter < split_len; ++iter) {
+		new_sdict->split_keys[iter] = create_key(split_keys[iter]);
+	}
+
+	for (size_t iter = 0; iter < new_sdict->shards_len; ++iter) {
+		new_sdict->shards[iter] = create_concurrent_dict(create_key, destroy_key, create_value, destroy_value, cmp);
+
+		if (new_sdict->shards[iter] == NULL) {
+			destroy_sharded_dict(new_sdict);
+			return NULL;
+		}
+	}
+
+	return new_sdict;
+}
+
+/**
+ * @brief Function to free all memory loaded for the sharded dictionary object
+ * 
+ * @param sdict pointer to an allocated sharded dictionary object
+ */
+void destroy_sharded_dict(sharded_dict_t *sdict) {
+	/* Check if input data is valid */
+	if (sdict == NULL) {
+		return;
+	}
+
+	for (size_t iter = 0; iter < sdict->shards_len; ++iter) {
+		destroy_concurrent_dict(sdict->shards[iter]);
+	}
+
+	for (size_t iter = 0; iter + 1 < sdict->shards_len; ++iter) {
+		sdict->destroy_key(sdict->split_keys[iter]);
+	}
+
+	free(sdict->shards);
+	free(sdict->split_keys);
+	free(sdict);
+}
+
+/**
+ * @brief Function to find the shard of a key with a binary search
+ * over the split keys
+ * 
+ * @param sdict pointer to an allocated sharded dictionary object
+ * @param key pointer to a key location
+ * @return size_t index of the shard
+ */
+size_t sharded_dict_shard(sharded_dict_t *sdict, const void *key) {
+	/* Check if input data is valid */
+	if ((sdict == NULL) || (key == NULL)) {
+		return 0;
+	}
+
+	size_t low = 0, high = sdict->shards_len - 1;
+
+	/* Count the split keys smaller or equal than the key */
+	while (low < high) {
+		size_t mid = low + (high - low) / 2;
+
+		if (sdict->cmp(sdict->split_keys[mid], key) <= 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/**
+ * @brief Function to search a key in its shard, the node is given
+ * to "visit" while the shard is still locked
+ * 
+ * @param sdict pointer to an allocated sharded dictionary object
+ * @param key pointer to a key location
+ * @param visit Function to call for the key head, can be NULL
+ * @param data pointer passed to the "visit" call
+ * @return uint8_t 1 if the key was found, 0 otherwise
+ */
+uint8_t sharded_dict_search(sharded_dict_t *sdict, const void *key, visit_func visit, void *data) {
+	/* Check if input data is valid */
+	if ((sdict == NULL) || (key == NULL)) {
+		return 0;
+	}
+
+	return concurrent_dict_search(sdict->shards[sharded_dict_shard(sdict, key)], key, visit, data);
+}
+
+/**
+ * @brief Subroutine function of the minimum and maximum queries
+ * 
+ * @param sdict pointer to an allocated sharded dictionary object
+ * @param is_max 1 to find the maximum, 0 to find the minimum
+ * @param visit Function to call for the key head, can be NULL
+ * @param data pointer passed to the "visit" call
+ * @return uint8_t 1 if the dictionary has a key, 0 otherwise
+ */
+static uint8_t sharded_dict_extreme(sharded_dict_t *sdict, uint8_t is_max, visit_func visit, void *data) {
+	/* The first shard with keys, from the needed end */
+	for (size_t iter = 0; iter < sdict->shards_len; ++iter) {
+		concurrent_dict_t *shard = sdict->shards[is_max ? sdict->shards_len - 1 - iter : iter];
+		dict_t *dict = concurrent_dict_read_begin(shard);
+
+		if (dict->root != NULL) {
+			dict_node_t *node = is_max ? dict_maximum(dict->root) : dict_minimum(dict->root);
+
+			if (visit != NULL) {
+				visit(node, data);
+			}
+
+			concurrent_dict_read_end(shard);
+
+			return 1;
+		}
+
+		concurrent_dict_read_end(shard);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Function to find the smallest key of all the shards
+ * 
+ * @param sdict pointer to an allocated sharded dictionary object
+ * @param visit Function to call for the key head, can be NULL
+ * @param data pointer passed to the "visit" call
+ * @return uint8_t 1 if the dictionary has a key, 0 otherwise
+ */
+uint8_t sharded_dict_minimum(sharded_dict_t *sdict, visit_func visit, void *data) {
+	/* Check if input data is valid */
+	if (sdict == NULL) {
+		return 0;
+	}
+
+	return sharded_dict_extreme(sdict, 0, visit, data);
+}
+
+/**
+ * @brief Function to find the largest key of all the shards
+ * 
+ * @param sdict pointer to an allocated sharded dictionary object
+ * @param visit Function to call for the key head, can be NULL
+ * @param data pointer passed to the "visit" call
+ * @return uint8_t 1 if the dictionary has a key, 0 otherwise
+ */
+uint8_t sharded_dict_maximum(sharded_dict_t *sdict, visit_func visit, void *data) {
+	/* Check if input data is valid */
+	if (sdict == NULL) {
+		return 0;
+	}
+
+	return sharded_dict_extreme(sdict, 1, visit, data);
+}
+
+/**
+ * @brief Function to visit in order the keys between "left" and "right",
+ * both ends included, across the shard boundaries. Every shard is locked
+ * just while its own keys are visited.
+ * 
+ * @param sdict pointer to an allocated sharded dictionary object
+ * @param left pointer to the lower key of the range, NULL for no lower key
+ * @param right pointer to the upper key of the range, NULL for no upper key
+ * @param visit Function to call for every key head
+ * @param data pointer passed to every "visit" call
+ * @return size_t number of visited keys
+ */
+size_t sharded_dict_range(sharded_dict_t *sdict, const void *left, const void *right, visit_func visit, void *data) {
+	/* Check if input data is valid */
+	if ((sdict == NULL) || (visit == NULL)) {
+		return 0;
+	}
+
+	if ((left != NULL) && (right != NULL) && (sdict->cmp(left, right) > 0)) {
+		return 0;
+	}
+
+	size_t first = (left != NULL) ? sharded_dict_shard(sdict, left) : 0;
+	size_t last = (right != NULL) ? sharded_dict_shard(sdict, right) : sdict->shards_len - 1;
+	size_t count = 0;
+
+	for (size_t iter = first; iter <= last; ++iter) {
+		count += concurrent_dict_range(sdict->shards[iter], left, right, visit, data);
+	}
+
+	return count;
+}
+
+/**
+ * @brief Function to find the number of entries of all the shards
+ * 
+ * @param sdict pointer to an allocated sharded dictionary object
+ * @return size_t the number of entries
+ */
+size_t sharded_dict_size(sharded_dict_t *sdict) {
+	/* Check if input data is valid */
+	if (sdict == NULL) {
+		return 0;
+	}
+
+	size_t size = 0;
+
+	for (size_t iter = 0; iter < sdict->shards_len; ++iter) {
+		size += concurrent_dict_size(sdict->shards[iter]);
+	}
+
+	return size;
+}
+
+/**
+ * @brief Function to insert a new entry in the shard of its key
+ * 
+ * @param sdict pointer to an allocated sharded dictionary object
+ * @param key pointer to a key location
+ * @param value pointer to a value location
+ */
+void sharded_dict_insert(sharded_dict_t *sdict, const void *key, const void *value) {
+	/* Check if input data is valid */
+	if ((sdict == NULL) || (key == NULL) || (value == NULL)) {
+		return;
+	}
+
+	concurrent_dict_insert(sdict->shards[sharded_dict_shard(sdict, key)], key, value);
+}
+
+/**
+ * @brief Function to delete the last entry of a key from its shard
+ * 
+ * @param sdict pointer to an allocated sharded dictionary object
+ * @param key pointer to a key location
+ */
+void sharded_dict_delete(sharded_dict_t *sdict, const void *key) {
+	/* Check if input data is valid */
+	if ((sdict == NULL) || (key == NULL)) {
+		return;
+	}
+
+	concurrent_dict_delete(sdict->shards[sharded_dict_shard(sdict, key)], key);
+}
@@ -0,0 +1,307 @@
+#include "include/word_scanner.h"
+
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WORD_SCAN_X86 1
+#endif
+
+#define WORD_SCAN_BLOCK 64
+
+/**
+ * @brief Lookup table of the WORD_SEPARATOR characters and of the string terminator
+ * 
+ */
+const uint8_t word_separator_table[256] = {
+	['\0'] = 1, [','] = 1, ['.'] = 1, ['?'] = 1, [' '] = 1, ['\n'] = 1, ['\r'] = 1
+};
+
+/**
+ * @brief Definition of a function that classifies one block of
+ * WORD_SCAN_BLOCK characters, bit i is set if character i is a separator
+ * 
+ */
+typedef uint64_t (*word_mask_func)(const char *block);
+
+/**
+ * @brief Function to classify a block one character at a time
+ * 
+ * @param block pointer to the block
+ * @param len number of characters to classify, at most WORD_SCAN_BLOCK
+ * @return uint64_t the separator mask of the block
+ */
+static uint64_t word_mask_scalar_len(const char *block, size_t len) {
+	uint64_t separators = 0;
+
+	for (size_t iter = 0; iter < len; ++iter) {
+		separators |= (uint64_t)word_is_separator(block[iter]) << iter;
+	}
+
+	return separators;
+}
+
+/**
+ * @brief Function to classify a full block without vector instructions
+ * 
+ * @param block pointer to the block
+ * @return uint64_t the separator mask of the block
+ */
+static uint64_t word_mask_scalar(const char *block) {
+	return word_mask_scalar_len(block, WORD_SCAN_BLOCK);
+}
+
+#ifdef WORD_SCAN_X86
+
+/**
+ * @brief Function to classify 16 characters with SSE2
+ * 
+ * @param chunk the characters
+ * @return uint64_t the separator mask of the characters
+ */
+__attribute__((target("sse2")))
+static inline uint64_t word_mask_sse2_chunk(__m128i chunk) {
+	__m128i separators = _mm_cmpeq_epi8(chunk, _mm_setzero_si128());
+
+	separators = _mm_or_si128(separators, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(',')));
+	separators = _mm_or_si128(separators, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('.')));
+	separators = _mm_or_si128(separators, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('?')));
+	separators = _mm_or_si128(separators, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')));
+	separators = _mm_or_si128(separators, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+	separators = _mm_or_si128(separators, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')));
+
+	return (uint64_t)(uint16_t)_mm_movemask_epi8(separators);
+}
+
+/**
+ * @brief Function to classify a full block with SSE2, 16 characters at once
+ * 
+ * @param block pointer to the block
+ * @return uint64_t the separator mask of the block
+ */
+__attribute__((target("sse2")))
+static uint64_t word_mask_sse2(const char *block) {
+	uint64_t separators = 0;
+
+	for (size_t iter = 0; iter < WORD_SCAN_BLOCK; iter += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i *)(block + iter));
+
+		separators |= word_mask_sse2_chunk(chunk) << iter;
+	}
+
+	return separators;
+}
+
+/**
+ * @brief Function to classify 32 characters with AVX2
+ * 
+ * @param chunk the characters
+ * @return uint64_t the separator mask of the characters
+ */
+__attribute__((target("avx2")))
+static inline uint64_t word_mask_avx2_chunk(__m256i chunk) {
+	__m256i separators = _mm256_cmpeq_epi8(chunk, _mm256_setzero_si256());
+
+	separators = _mm256_or_si256(separators, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(',')));
+	separators = _mm256_or_si256(separators, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('.')));
+	separators = _mm256_or_si256(separators, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('?')));
+	separators = _mm256_or_si256(separators, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')));
+	separators = _mm256_or_si256(separators, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')));
+	separators = _mm256_or_si256(separators, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')));
+
+	return (uint64_t)(uint32_t)_mm256_movemask_epi8(separators);
+}
+
+/**
+ * @brief Function to classify a full block with AVX2, 32 characters at once
+ * 
+ * @param block pointer to the block
+ * @return uint64_t the separator mask of the block
+ */
+__attribute__((target("avx2")))
+static uint64_t word_mask_avx2(const char *block) {
+	__m256i low = _mm256_loadu_si256((const __m256i *)block);
+	__m256i high = _mm256_loadu_si256((const __m256i *)(block + 32));
+
+	return word_mask_avx2_chunk(low) | (word_mask_avx2_chunk(high) << 32);
+}
+
+#endif /* WORD_SCAN_X86 */
+
+static word_mask_func word_mask = word_mask_scalar;
+static uint8_t word_mask_level = WORD_SCAN_SCALAR;
+static pthread_once_t word_mask_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Function to check if the processor can run a scanner level
+ * 
+ * @param level WORD_SCAN_SCALAR, WORD_SCAN_SSE2 or WORD_SCAN_AVX2
+ * @return uint8_t 1 if the level can run, 0 otherwise
+ */
+static uint8_t word_scan_supported(uint8_t level) {
+	if (level == WORD_SCAN_SCALAR) {
+		return 1;
+	}
+
+#ifdef WORD_SCAN_X86
+	__builtin_cpu_init();
+
+	if (level == WORD_SCAN_SSE2) {
+		return (__builtin_cpu_supports("sse2") != 0);
+	}
+
+	if (level == WORD_SCAN_AVX2) {
+		return (__builtin_cpu_supports("avx2") != 0);
+	}
+#endif
+
+	return 0;
+}
+
+/**
+ * @brief Function to switch the scanner to a level
+ * 
+ * @param level WORD_SCAN_SCALAR, WORD_SCAN_SSE2 or WORD_SCAN_AVX2
+ * @return uint8_t 1 if the level is used from now on, 0 if the processor can not run it
+ */
+static uint8_t word_scan_use(uint8_t level) {
+	if (word_scan_supported(level) == 0) {
+		return 0;
+	}
+
+	switch (level) {
+#ifdef WORD_SCAN_X86
+		case WORD_SCAN_SSE2:
+			word_mask = word_mask_sse2;
+			break;
+		case WORD_SCAN_AVX2:
+			word_mask = word_mask_avx2;
+			break;
+#endif
+		default:
+			word_mask = word_mask_scalar;
+			break;
+	}
+
+	word_mask_level = level;
+
+	return 1;
+}
+
+/**
+ * @brief Function to pick the widest level the processor can run,
+ * it runs once before the first scan
+ * 
+ */
+static void word_scan_init(void) {
+	for (uint8_t level = WORD_SCAN_AVX2; level > WORD_SCAN_SCALAR; --level) {
+		if (word_scan_use(level) != 0) {
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Function to give the scanner level in use
+ * 
+ * @return uint8_t WORD_SCAN_SCALAR, WORD_SCAN_SSE2 or WORD_SCAN_AVX2
+ */
+uint8_t word_scan_level(void) {
+	pthread_once(&word_mask_once, word_scan_init);
+
+	return word_mask_level;
+}
+
+/**
+ * @brief Function to force a scanner level, the scans running at the
+ * same time have to be done first. Every level finds the same words.
+ * 
+ * @param level WORD_SCAN_SCALAR, WORD_SCAN_SSE2 or WORD_SCAN_AVX2
+ * @return uint8_t 1 if the level is used from now on, 0 if the processor can not run it
+ */
+uint8_t word_scan_set_level(uint8_t level) {
+	/* Keep the automatic choice from overwriting this one */
+	pthread_once(&word_mask_once, word_scan_init);
+
+	return word_scan_use(level);
+}
+
+/**
+ * @brief Function to find the next words of a text. The scan starts at
+ * "pos" and stops after "slices_len" words or at the end of the text,
+ * "pos" is moved after the last word found. A word that reaches the
+ * end of the text is given as well, it may go on in the next text.
+ * Every block of WORD_SCAN_BLOCK characters is classified at once and
+ * the words are read from the bits where the class changes.
+ * 
+ * @param text pointer to the text
+ * @param len number of characters in the text
+ * @param pos where to start the scan, it is updated
+ * @param slices array to write the words in
+ * @param slices_len number of words the array can hold
+ * @return size_t number of words found
+ */
+size_t word_scan(const char *text, size_t len, size_t *pos, word_slice_t *slices, size_t slices_len) {
+	/* Check if input data is valid */
+	if ((text == NULL) || (pos == NULL) || (slices == NULL) || (slices_len == 0)) {
+		return 0;
+	}
+
+	pthread_once(&word_mask_once, word_scan_init);
+
+	word_mask_func mask = word_mask;
+	size_t slices_found = 0;
+	size_t word_start = 0;
+	uint64_t in_word = 0;
+
+	for (size_t base = *pos; base < len; base += WORD_SCAN_BLOCK) {
+		size_t left = len - base;
+		uint64_t separators = 0;
+
+		if (left >= WORD_SCAN_BLOCK) {
+			separators = mask(text + base);
+		} else {
+			/* The characters after the text end the last word */
+			separators = word_mask_scalar_len(text + base, left) | (UINT64_MAX << left);
+		}
+
+		uint64_t letters = ~separators;
+		uint64_t after_letter = (letters << 1) | in_word;
+		uint64_t starts = letters & ~after_letter;
+		uint64_t ends = separators & after_letter;
+		uint64_t changes = starts | ends;
+
+		/* The starts and the ends take turns */
+		while (changes != 0) {
+			size_t bit = (size_t)__builtin_ctzll(changes);
+
+			changes &= changes - 1;
+
+			if (((starts >> bit) & 1) != 0) {
+				word_start = base + bit;
+				continue;
+			}
+
+			slices[slices_found].start = word_start;
+			slices[slices_found].len = base + bit - word_start;
+
+			if (++slices_found == slices_len) {
+				*pos = (base + bit < len) ? base + bit : len;
+				return slices_found;
+			}
+		}
+
+		in_word = letters >> (WORD_SCAN_BLOCK - 1);
+	}
+
+	/* The last word reaches the end of a text of full blocks */
+	if (in_word != 0) {
+		slices[slices_found].start = word_start;
+		slices[slices_found].len = len - word_start;
+		++slices_found;
+	}
+
+	*pos = len;
+
+	return slices_found;
+}